@@ -14,60 +14,38 @@ AsciiBarEqualizer::~AsciiBarEqualizer()
 {
 }
 
-void AsciiBarEqualizer::renderFrame(const std::vector<float> &audioData,
-                                    double *fftInputBuffer,
-                                    fftw_complex *fftOutputBuffer,
-                                    fftw_plan &fftPlan,
+void AsciiBarEqualizer::renderFrame(const AnalysisFrame &analysis,
                                     float timeSeconds)
 {
+    // Mark unused parameters to silence compiler warnings
+    (void)timeSeconds;
+
     // Set color for visualization
-    glColor3f(0.0f, 1.0f, 0.0f); // Green visualization
+    batch.color(0.0f, 1.0f, 0.0f); // Green visualization
 
-    // Calculate the sample index for the current time
-    size_t sampleIndex = static_cast<size_t>(timeSeconds * 44100); // Assuming 44.1kHz
-    if (sampleIndex >= audioData.size())
+    // Nothing to draw once the audio has ended
+    if (!analysis.primary().active)
         return;
 
-    // Fill the FFT input buffer with samples at this time
-    for (int i = 0; i < N; i++)
-    {
-        if (sampleIndex + i < audioData.size())
-        {
-            fftInputBuffer[i] = audioData[sampleIndex + i];
-        }
-        else
-        {
-            fftInputBuffer[i] = 0.0;
-        }
-    }
-
-    // Execute FFT
-    fftw_execute(fftPlan);
-
-    // Render bars based on FFT output
-    renderBars(fftOutputBuffer);
+    // Render bars based on the shared spectrum
+    renderBars(analysis);
 }
 
-void AsciiBarEqualizer::renderLiveFrame(const std::vector<float> &audioData,
-                                        double *fftInputBuffer,
-                                        fftw_complex *fftOutputBuffer,
-                                        fftw_plan &fftPlan,
+void AsciiBarEqualizer::renderLiveFrame(const AnalysisFrame &analysis,
                                         size_t currentPosition)
 {
     // Mark unused parameters to silence compiler warnings
-    (void)audioData;
-    (void)fftInputBuffer;
     (void)currentPosition;
 
-    // Execute FFT
-    fftw_execute(fftPlan);
-
-    // Render bars based on FFT output
-    renderBars(fftOutputBuffer);
+    // Render bars based on the shared spectrum
+    renderBars(analysis);
 }
 
-void AsciiBarEqualizer::renderBars(fftw_complex *fftOutputBuffer)
+void AsciiBarEqualizer::renderBars(const AnalysisFrame &analysis)
 {
+    const std::vector<float> &magnitudes = analysis.primary().magnitudes;
+    const int N = analysis.fftSize;
+
     // Calculate frequency bands for bars using logarithmic scale
     float barWidth = 2.0f / numBars; // normalized width in [-1, 1] space
 
@@ -95,8 +73,7 @@ void AsciiBarEqualizer::renderBars(fftw_complex *fftOutputBuffer)
         float sum = 0.0f;
         for (int j = startIdx; j <= endIdx; j++)
         {
-            float magnitude = std::sqrt(fftOutputBuffer[j][0] * fftOutputBuffer[j][0] +
-                                        fftOutputBuffer[j][1] * fftOutputBuffer[j][1]);
+            float magnitude = magnitudes[j] * WINDOW_GAIN;
 
             // Apply frequency-dependent scaling
             float freqScaling = std::pow(static_cast<float>(j) / startIdx, 0.5f); // Square root scaling
@@ -120,6 +97,24 @@ void AsciiBarEqualizer::renderBars(fftw_complex *fftOutputBuffer)
         // Render ASCII bar
         renderAsciiBar(xLeft, xRight, height * 2.0f); // Scale height to fill range
     }
+
+    // Draw the queued "0" characters as ellipse outlines
+    const int SEGMENTS = 8;
+    batch.begin(GL_LINES);
+    for (const ZeroGlyph &zero : zeros)
+    {
+        for (int i = 0; i < SEGMENTS; i++)
+        {
+            float angle1 = 2.0f * M_PI * i / SEGMENTS;
+            float angle2 = 2.0f * M_PI * (i + 1) / SEGMENTS;
+            batch.vertex(zero.centerX + cos(angle1) * zero.radiusX, zero.centerY + sin(angle1) * zero.radiusY);
+            batch.vertex(zero.centerX + cos(angle2) * zero.radiusX, zero.centerY + sin(angle2) * zero.radiusY);
+        }
+    }
+    batch.end();
+    zeros.clear();
+
+    batch.flush();
 }
 
 void AsciiBarEqualizer::renderAsciiBar(float xLeft, float xRight, float height)
@@ -145,35 +140,17 @@ void AsciiBarEqualizer::renderAsciiBar(float xLeft, float xRight, float height)
             float charY = -1.0f + y * charHeight;
 
             // Draw the character
-            glBegin(GL_QUADS);
             if (isOne)
             {
                 // Draw "1"
-                glVertex2f(charX + charWidth * 0.4f, charY);
-                glVertex2f(charX + charWidth * 0.6f, charY);
-                glVertex2f(charX + charWidth * 0.6f, charY + charHeight);
-                glVertex2f(charX + charWidth * 0.4f, charY + charHeight);
+                batch.rect(charX + charWidth * 0.4f, charY, charX + charWidth * 0.6f, charY + charHeight);
             }
             else
             {
                 // Draw "0"
-                const int SEGMENTS = 8;
-                float centerX = charX + charWidth * 0.5f;
-                float centerY = charY + charHeight * 0.5f;
-                float radiusX = charWidth * 0.3f;
-                float radiusY = charHeight * 0.4f;
-
-                glBegin(GL_LINE_LOOP);
-                for (int i = 0; i < SEGMENTS; i++)
-                {
-                    float angle = 2.0f * M_PI * i / SEGMENTS;
-                    float x = centerX + cos(angle) * radiusX;
-                    float y = centerY + sin(angle) * radiusY;
-                    glVertex2f(x, y);
-                }
-                glEnd();
+                zeros.push_back({charX + charWidth * 0.5f, charY + charHeight * 0.5f,
+                                 charWidth * 0.3f, charHeight * 0.4f});
             }
-            glEnd();
         }
     }
 }
\ No newline at end of file
@@ -3,6 +3,7 @@
 
 #include "visualizer_base.h"
 #include <random>
+#include <vector>
 
 class AsciiBarEqualizer : public Visualizer
 {
@@ -10,27 +11,30 @@ public:
     AsciiBarEqualizer(int numBars = 16);
     ~AsciiBarEqualizer() override;
 
-    void renderFrame(const std::vector<float> &audioData,
-                     double *fftInputBuffer,
-                     fftw_complex *fftOutputBuffer,
-                     fftw_plan &fftPlan,
+    void renderFrame(const AnalysisFrame &analysis,
                      float timeSeconds) override;
 
-    void renderLiveFrame(const std::vector<float> &audioData,
-                         double *fftInputBuffer,
-                         fftw_complex *fftOutputBuffer,
-                         fftw_plan &fftPlan,
+    void renderLiveFrame(const AnalysisFrame &analysis,
                          size_t currentPosition) override;
 
 private:
     // Helper method for actual rendering
-    void renderBars(fftw_complex *fftOutputBuffer);
+    void renderBars(const AnalysisFrame &analysis);
 
     // Helper to render a single ASCII bar
     void renderAsciiBar(float xLeft, float xRight, float height);
 
+    // "0" outlines are queued and drawn after all bars, so the "1" quads and
+    // the outlines each form a single batch
+    struct ZeroGlyph
+    {
+        float centerX, centerY;
+        float radiusX, radiusY;
+    };
+    std::vector<ZeroGlyph> zeros;
+
     int numBars;
-    const int N = 1024; // FFT size
+    static constexpr float WINDOW_GAIN = 2.0f; // Compensates the Hann window's coherent gain of 0.5
 
     // Random number generation for ASCII characters
     std::mt19937 rng;
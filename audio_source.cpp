@@ -0,0 +1,39 @@
+#include "audio_source.h"
+#include "mapped_wav_source.h"
+#include "streaming_wav_source.h"
+#include <algorithm>
+
+bool AudioSource::view(size_t position, size_t count, AudioView &result)
+{
+    // Mark unused parameters to silence compiler warnings
+    (void)position;
+    (void)count;
+    (void)result;
+    return false;
+}
+
+AudioView AudioSource::fetch(size_t position, size_t count, std::vector<float> &storage)
+{
+    AudioView result;
+    if (view(position, count, result))
+        return result;
+
+    storage.resize(count);
+    read(position, storage.data(), count);
+    size_t available = position < length() ? std::min(count, length() - position) : 0;
+    return AudioView(storage.data(), available, count);
+}
+
+std::shared_ptr<AudioSource> openAudioSource(const std::string &filename)
+{
+    // 16-bit PCM and 32-bit float WAVs are mapped directly; anything else
+    // is decoded by libsndfile
+    auto mapped = std::make_shared<MappedWavSource>();
+    if (mapped->open(filename))
+        return mapped;
+
+    auto source = std::make_shared<StreamingWavSource>();
+    if (!source->open(filename))
+        return nullptr;
+    return source;
+}
@@ -0,0 +1,178 @@
+#ifndef AUDIO_SOURCE_H
+#define AUDIO_SOURCE_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Sample encodings an AudioView can decode on the fly
+enum class SampleFormat
+{
+    Float32,
+    Int16
+};
+
+// Read-only window onto interleaved samples, downmixed to mono and
+// converted to float on access. Indexing past the available samples
+// returns silence, so a view may extend beyond the end of its source.
+// A view may hold a reference to the storage it points into, which keeps
+// that storage alive for as long as the view exists.
+class AudioView
+{
+public:
+    AudioView() = default;
+
+    // Mono float samples, e.g. a scratch buffer
+    AudioView(const float *samples, size_t available, size_t size,
+              std::shared_ptr<const void> owner = nullptr)
+        : bytes(reinterpret_cast<const unsigned char *>(samples)), availableCount(available), count(size),
+          owner(std::move(owner))
+    {
+    }
+
+    // Interleaved frames in any supported format
+    AudioView(const void *frames, SampleFormat format, int channels, size_t available, size_t size,
+              std::shared_ptr<const void> owner = nullptr)
+        : bytes(static_cast<const unsigned char *>(frames)), format(format), channels(channels),
+          availableCount(available), count(size), owner(std::move(owner))
+    {
+    }
+
+    size_t size() const { return count; }
+    size_t available() const { return availableCount; }
+
+    float operator[](size_t i) const
+    {
+        return i < availableCount ? decode(i) : 0.0f;
+    }
+
+    // Contiguous samples when the view is already aligned mono float, else nullptr
+    const float *floatData() const
+    {
+        bool aligned = reinterpret_cast<uintptr_t>(bytes) % alignof(float) == 0;
+        return isMonoFloat() && aligned ? reinterpret_cast<const float *>(bytes) : nullptr;
+    }
+
+    // Decode the whole view into dest, which must hold size() samples
+    void copyTo(float *dest) const
+    {
+        if (isMonoFloat())
+        {
+            if (availableCount > 0)
+                std::memcpy(dest, bytes, availableCount * sizeof(float));
+        }
+        else
+        {
+            for (size_t i = 0; i < availableCount; i++)
+            {
+                dest[i] = decode(i);
+            }
+        }
+        std::fill(dest + availableCount, dest + count, 0.0f);
+    }
+
+private:
+    const unsigned char *bytes = nullptr;
+    SampleFormat format = SampleFormat::Float32;
+    int channels = 1;
+    size_t availableCount = 0; // Samples backed by data; the rest read as silence
+    size_t count = 0;
+    std::shared_ptr<const void> owner;
+
+    bool isMonoFloat() const { return format == SampleFormat::Float32 && channels == 1; }
+
+    // Sample i, which must be below availableCount
+    float decode(size_t i) const
+    {
+        // memcpy keeps loads well-defined for data chunks at odd offsets
+        float sum = 0.0f;
+        if (format == SampleFormat::Float32)
+        {
+            const unsigned char *frame = bytes + i * channels * sizeof(float);
+            for (int ch = 0; ch < channels; ch++)
+            {
+                float sample;
+                std::memcpy(&sample, frame + ch * sizeof(float), sizeof(sample));
+                sum += sample;
+            }
+        }
+        else
+        {
+            const unsigned char *frame = bytes + i * channels * sizeof(int16_t);
+            for (int ch = 0; ch < channels; ch++)
+            {
+                int16_t sample;
+                std::memcpy(&sample, frame + ch * sizeof(int16_t), sizeof(sample));
+                sum += sample * (1.0f / 32768.0f);
+            }
+        }
+        return channels == 1 ? sum : sum / channels;
+    }
+};
+
+// Refcounted, immutable block of mono samples. Copies share the same
+// storage, so passing a buffer or a view of it around never copies samples.
+class AudioBuffer
+{
+public:
+    AudioBuffer() = default;
+    explicit AudioBuffer(std::vector<float> samples)
+        : storage(std::make_shared<const std::vector<float>>(std::move(samples)))
+    {
+    }
+
+    const float *data() const { return storage ? storage->data() : nullptr; }
+    size_t size() const { return storage ? storage->size() : 0; }
+
+    // View of count samples starting at offset; samples past the end of the
+    // buffer read as silence
+    AudioView view(size_t offset, size_t count) const
+    {
+        size_t available = offset < size() ? std::min(count, size() - offset) : 0;
+        return AudioView(available > 0 ? data() + offset : nullptr, available, count, storage);
+    }
+
+private:
+    std::shared_ptr<const std::vector<float>> storage;
+};
+
+// A mono audio input addressed by sample position. Multi-channel files are
+// downmixed by the backend, and reads past the end return silence, so
+// sources of different lengths never need to be padded.
+class AudioSource
+{
+public:
+    virtual ~AudioSource() = default;
+
+    // Number of mono samples in the source
+    virtual size_t length() const = 0;
+
+    // Channel count and sample rate of the underlying file
+    virtual int channels() const = 0;
+    virtual int sampleRate() const = 0;
+
+    // Copy count samples starting at position into dest. Samples past the
+    // end of the source are written as zeros. Safe to call from any thread.
+    virtual void read(size_t position, float *dest, size_t count) = 0;
+
+    // Point result at count samples starting at position without copying.
+    // The view shares ownership of the samples, so it stays valid even if
+    // the source drops them. Backends that cannot hand out a view for this
+    // range return false.
+    virtual bool view(size_t position, size_t count, AudioView &result);
+
+    // Zero-copy view when the backend supports it; otherwise the samples
+    // are read into storage and the view points there
+    AudioView fetch(size_t position, size_t count, std::vector<float> &storage);
+};
+
+using AudioSourceList = std::vector<std::shared_ptr<AudioSource>>;
+
+// Open a WAV file with the most suitable backend, or return nullptr
+std::shared_ptr<AudioSource> openAudioSource(const std::string &filename);
+
+#endif // AUDIO_SOURCE_H
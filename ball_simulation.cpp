@@ -0,0 +1,314 @@
+#include "ball_simulation.h"
+#include <algorithm>
+#include <cmath>
+
+// Balls [begin, end) of slice out of slices
+static void sliceRange(size_t count, size_t slice, size_t slices, size_t &begin, size_t &end)
+{
+    begin = count * slice / slices;
+    end = count * (slice + 1) / slices;
+}
+
+BallSimulation::~BallSimulation()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (std::thread &worker : workers)
+    {
+        worker.join();
+    }
+}
+
+void BallSimulation::resize(size_t count)
+{
+    for (std::vector<float> *field : {&x, &y, &vx, &vy, &radius, &energy})
+    {
+        field->resize(count, 0.0f);
+    }
+    band.resize(count, 0);
+}
+
+void BallSimulation::step(float deltaTime, float halfWidth, const std::vector<float> &bandEnergies)
+{
+    if (x.empty())
+        return;
+
+    stepDelta = deltaTime;
+    stepHalfWidth = halfWidth;
+    stepBands = &bandEnergies;
+
+    runParallel(&BallSimulation::integrate);
+
+    buildGrid();
+    nextX.resize(size());
+    nextY.resize(size());
+    nextVx.resize(size());
+    nextVy.resize(size());
+    runParallel(&BallSimulation::collide);
+
+    x.swap(nextX);
+    y.swap(nextY);
+    vx.swap(nextVx);
+    vy.swap(nextVy);
+}
+
+void BallSimulation::integrate(size_t begin, size_t end)
+{
+    const float deltaTime = stepDelta;
+    const float halfWidth = stepHalfWidth;
+    const std::vector<float> &bandEnergies = *stepBands;
+
+    for (size_t i = begin; i < end; i++)
+    {
+        // Apply gravity
+        vy[i] -= GRAVITY * deltaTime;
+
+        // Get audio energy for this ball's frequency band
+        float audioEnergy = 0.0f;
+        if (band[i] >= 0 && band[i] < static_cast<int>(bandEnergies.size()))
+        {
+            audioEnergy = bandEnergies[band[i]];
+        }
+
+        // Update energy with decay
+        energy[i] = energy[i] * ENERGY_DECAY + audioEnergy * (1.0f - ENERGY_DECAY);
+        float bounceIntensity = BASE_BOUNCE_FORCE + energy[i] * (MAX_BOUNCE_FORCE - BASE_BOUNCE_FORCE);
+
+        // Update position
+        x[i] += vx[i] * deltaTime;
+        y[i] += vy[i] * deltaTime;
+
+        // Apply damping
+        vx[i] *= DAMPING;
+        vy[i] *= DAMPING;
+
+        // Bounce off walls (accounting for aspect ratio)
+        float maxX = halfWidth - radius[i];
+        float minX = -halfWidth + radius[i];
+
+        if (x[i] > maxX)
+        {
+            x[i] = maxX;
+            vx[i] = -std::abs(vx[i]) * BOUNCE_DAMPING;
+            // Audio-reactive bounce
+            vy[i] += bounceIntensity * audioEnergy;
+        }
+        else if (x[i] < minX)
+        {
+            x[i] = minX;
+            vx[i] = std::abs(vx[i]) * BOUNCE_DAMPING;
+            // Audio-reactive bounce
+            vy[i] += bounceIntensity * audioEnergy;
+        }
+
+        // Bounce off floor and ceiling
+        if (y[i] > (1.0f - radius[i]))
+        {
+            y[i] = 1.0f - radius[i];
+            vy[i] = -std::abs(vy[i]) * BOUNCE_DAMPING;
+            // Audio-reactive bounce
+            vy[i] -= bounceIntensity * audioEnergy;
+        }
+        else if (y[i] < (-1.0f + radius[i]))
+        {
+            y[i] = -1.0f + radius[i];
+            vy[i] = std::abs(vy[i]) * BOUNCE_DAMPING;
+            // Strong audio-reactive bounce from floor
+            vy[i] += bounceIntensity * audioEnergy * 1.5f;
+        }
+
+        // Clamp velocities to prevent extreme speeds
+        vx[i] = std::max(-MAX_VELOCITY, std::min(MAX_VELOCITY, vx[i]));
+        vy[i] = std::max(-MAX_VELOCITY, std::min(MAX_VELOCITY, vy[i]));
+
+        // Stop very slow movement
+        if (std::abs(vx[i]) < MIN_VELOCITY)
+            vx[i] = 0.0f;
+        if (std::abs(vy[i]) < MIN_VELOCITY)
+            vy[i] = 0.0f;
+    }
+}
+
+void BallSimulation::buildGrid()
+{
+    const size_t count = size();
+
+    // Any two touching balls are then in the same or neighbouring cells
+    float maxRadius = *std::max_element(radius.begin(), radius.end());
+    cellSize = std::max(2.0f * maxRadius, 1e-4f);
+    for (;;)
+    {
+        gridColumns = std::max(1, static_cast<int>(std::ceil(2.0f * stepHalfWidth / cellSize)));
+        gridRows = std::max(1, static_cast<int>(std::ceil(2.0f / cellSize)));
+        if (static_cast<size_t>(gridColumns) * gridRows <= MAX_GRID_CELLS)
+            break;
+        cellSize *= 2.0f;
+    }
+    const size_t cells = static_cast<size_t>(gridColumns) * gridRows;
+
+    // Counting sort by cell; filling in ball order keeps every cell's list,
+    // and so every collision sum, in the same order from run to run
+    ballCell.resize(count);
+    cellStart.assign(cells + 1, 0);
+    for (size_t i = 0; i < count; i++)
+    {
+        int column = std::min(gridColumns - 1, std::max(0, static_cast<int>((x[i] + stepHalfWidth) / cellSize)));
+        int row = std::min(gridRows - 1, std::max(0, static_cast<int>((y[i] + 1.0f) / cellSize)));
+        ballCell[i] = static_cast<uint32_t>(row * gridColumns + column);
+        cellStart[ballCell[i] + 1]++;
+    }
+    for (size_t c = 0; c < cells; c++)
+    {
+        cellStart[c + 1] += cellStart[c];
+    }
+
+    cellFill.assign(cellStart.begin(), cellStart.end() - 1);
+    cellBalls.resize(count);
+    for (size_t i = 0; i < count; i++)
+    {
+        cellBalls[cellFill[ballCell[i]]++] = static_cast<uint32_t>(i);
+    }
+}
+
+void BallSimulation::collide(size_t begin, size_t end)
+{
+    const float halfWidth = stepHalfWidth;
+
+    for (size_t i = begin; i < end; i++)
+    {
+        float px = x[i];
+        float py = y[i];
+        float pvx = vx[i];
+        float pvy = vy[i];
+        const float ri = radius[i];
+        const float massI = ri * ri;
+
+        // Impulses from all contacts are averaged; summing them would
+        // overshoot in a crowd, where every neighbour reports the same
+        // approach, and keep the pile bouncing forever
+        float impulseX = 0.0f;
+        float impulseY = 0.0f;
+        int contacts = 0;
+
+        int column = static_cast<int>(ballCell[i] % gridColumns);
+        int row = static_cast<int>(ballCell[i] / gridColumns);
+        for (int r = std::max(0, row - 1); r <= std::min(gridRows - 1, row + 1); r++)
+        {
+            for (int c = std::max(0, column - 1); c <= std::min(gridColumns - 1, column + 1); c++)
+            {
+                size_t cell = static_cast<size_t>(r) * gridColumns + c;
+                for (uint32_t k = cellStart[cell]; k < cellStart[cell + 1]; k++)
+                {
+                    uint32_t j = cellBalls[k];
+                    if (j == i)
+                        continue;
+
+                    float dx = x[i] - x[j];
+                    float dy = y[i] - y[j];
+                    float reach = ri + radius[j];
+                    float distanceSquared = dx * dx + dy * dy;
+                    if (distanceSquared >= reach * reach || distanceSquared < 1e-12f)
+                        continue;
+
+                    // Each side takes its mass-weighted share of the push
+                    // apart and of the impulse, so the pair stays symmetric
+                    float distance = std::sqrt(distanceSquared);
+                    float nx = dx / distance;
+                    float ny = dy / distance;
+                    float massJ = radius[j] * radius[j];
+                    float share = massJ / (massI + massJ);
+
+                    px += nx * (reach - distance) * share;
+                    py += ny * (reach - distance) * share;
+
+                    float approach = (vx[i] - vx[j]) * nx + (vy[i] - vy[j]) * ny;
+                    if (approach < 0.0f)
+                    {
+                        float impulse = (1.0f + RESTITUTION) * share * approach;
+                        impulseX -= impulse * nx;
+                        impulseY -= impulse * ny;
+                        contacts++;
+                    }
+                }
+            }
+        }
+
+        if (contacts > 0)
+        {
+            pvx += impulseX / contacts;
+            pvy += impulseY / contacts;
+        }
+
+        // Pushes must not move a ball through a wall
+        nextX[i] = std::max(-halfWidth + ri, std::min(halfWidth - ri, px));
+        nextY[i] = std::max(-1.0f + ri, std::min(1.0f - ri, py));
+        nextVx[i] = std::max(-MAX_VELOCITY, std::min(MAX_VELOCITY, pvx));
+        nextVy[i] = std::max(-MAX_VELOCITY, std::min(MAX_VELOCITY, pvy));
+    }
+}
+
+void BallSimulation::runParallel(Pass pass)
+{
+    const size_t count = size();
+    if (count < PARALLEL_THRESHOLD)
+    {
+        (this->*pass)(0, count);
+        return;
+    }
+
+    if (workers.empty())
+    {
+        size_t threads = std::max(1u, std::thread::hardware_concurrency());
+        for (size_t slice = 1; slice < threads; slice++)
+        {
+            workers.emplace_back(&BallSimulation::workerLoop, this, slice);
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        pendingPass = pass;
+        running = workers.size();
+        generation++;
+    }
+    wake.notify_all();
+
+    size_t begin, end;
+    sliceRange(count, 0, workers.size() + 1, begin, end);
+    (this->*pass)(begin, end);
+
+    std::unique_lock<std::mutex> lock(mutex);
+    finished.wait(lock, [this]
+                  { return running == 0; });
+}
+
+void BallSimulation::workerLoop(size_t slice)
+{
+    uint64_t seen = 0;
+    for (;;)
+    {
+        Pass pass;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [&]
+                      { return stopping || generation != seen; });
+            if (stopping)
+                return;
+            seen = generation;
+            pass = pendingPass;
+        }
+
+        size_t begin, end;
+        sliceRange(size(), slice, workers.size() + 1, begin, end);
+        (this->*pass)(begin, end);
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (--running == 0)
+                finished.notify_one();
+        }
+    }
+}
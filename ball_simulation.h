@@ -0,0 +1,98 @@
+#ifndef BALL_SIMULATION_H
+#define BALL_SIMULATION_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Audio-driven bouncing balls, stored as one array per field so every pass
+// streams through only what it reads. Ball-ball collisions are found
+// through a uniform grid rebuilt each step.
+//
+// Every pass reads the state from before it and writes only its own balls,
+// so the balls can be split across threads and the result is the same for
+// any thread count. Large scenes use a pool of worker threads, started the
+// first time a step has enough balls to share out.
+class BallSimulation
+{
+public:
+    BallSimulation() = default;
+    ~BallSimulation();
+
+    BallSimulation(const BallSimulation &) = delete;
+    BallSimulation &operator=(const BallSimulation &) = delete;
+
+    // Per-ball state; radius and band are set by the owner and not changed
+    std::vector<float> x, y;
+    std::vector<float> vx, vy;
+    std::vector<float> radius;
+    std::vector<float> energy;
+    std::vector<int> band; // Index into the band energies passed to step()
+
+    // Resize every array, zeroing new balls
+    void resize(size_t count);
+    size_t size() const { return x.size(); }
+
+    // Advance by deltaTime inside [-halfWidth, halfWidth] x [-1, 1]; each
+    // ball is driven by bandEnergies[band[i]], from 0 to 1
+    void step(float deltaTime, float halfWidth, const std::vector<float> &bandEnergies);
+
+private:
+    typedef void (BallSimulation::*Pass)(size_t begin, size_t end);
+
+    void integrate(size_t begin, size_t end);
+    void collide(size_t begin, size_t end);
+    void buildGrid();
+    void runParallel(Pass pass);
+    void workerLoop(size_t slice);
+
+    // Physics parameters
+    static constexpr float GRAVITY = 0.5f;
+    static constexpr float DAMPING = 0.98f;
+    static constexpr float BOUNCE_DAMPING = 0.85f;
+    static constexpr float RESTITUTION = 0.9f;
+    static constexpr float MIN_VELOCITY = 0.01f;
+    static constexpr float MAX_VELOCITY = 3.0f;
+
+    // Audio reactivity parameters
+    static constexpr float BASE_BOUNCE_FORCE = 0.3f;
+    static constexpr float MAX_BOUNCE_FORCE = 2.5f;
+    static constexpr float ENERGY_DECAY = 0.95f;
+
+    // Below this many balls a step runs on the calling thread alone
+    static constexpr size_t PARALLEL_THRESHOLD = 2048;
+    static constexpr size_t MAX_GRID_CELLS = 1 << 20;
+
+    // Inputs of the step in progress, for the passes
+    float stepDelta = 0.0f;
+    float stepHalfWidth = 1.0f;
+    const std::vector<float> *stepBands = nullptr;
+
+    // Collision output, swapped with the live arrays after each step
+    std::vector<float> nextX, nextY, nextVx, nextVy;
+
+    // Uniform grid with cells at least one ball diameter across; the balls
+    // of cell c are cellBalls[cellStart[c]] up to cellBalls[cellStart[c + 1]]
+    float cellSize = 1.0f;
+    int gridColumns = 0;
+    int gridRows = 0;
+    std::vector<uint32_t> cellStart;
+    std::vector<uint32_t> cellFill;
+    std::vector<uint32_t> cellBalls;
+    std::vector<uint32_t> ballCell;
+
+    // Worker pool: slice 0 runs on the caller, slice i + 1 on workers[i]
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable finished;
+    Pass pendingPass = nullptr;
+    uint64_t generation = 0;
+    size_t running = 0;
+    bool stopping = false;
+};
+
+#endif // BALL_SIMULATION_H
@@ -1,14 +1,69 @@
 #include "balls_visualizer.h"
 #include <GL/glew.h>
 #include <cmath>
+#include <cstddef>
 #include <algorithm>
 
-BallsVisualizer::BallsVisualizer() : aspectRatio(1.0f), lastTime(0.0f)
+// Places the unit circle for each ball. The fill is tinted by the ball's
+// energy; the outline pass only shows on energetic balls and collapses
+// the rest outside the clip volume.
+static const char *BALL_VERTEX_SHADER = R"(#version 120
+CAMERA_UNIFORMS
+uniform float outline;
+attribute vec2 unitVertex;
+attribute vec4 placement; // x, y, radius, energy
+attribute vec3 ballColor;
+varying vec4 color;
+
+void main()
+{
+    float energy = placement.w;
+    if (outline > 0.5)
+    {
+        if (energy <= 0.3)
+        {
+            gl_Position = vec4(0.0, 0.0, 2.0, 1.0);
+            color = vec4(0.0);
+            return;
+        }
+        color = vec4(ballColor, energy * 0.7);
+    }
+    else
+    {
+        color = vec4(ballColor * (0.6 + energy * 0.4), 0.9);
+    }
+    gl_Position = viewProjection * vec4(placement.xy + unitVertex * placement.z, 0.0, 1.0);
+}
+)";
+
+static const char *BALL_FRAGMENT_SHADER = R"(#version 120
+varying vec4 color;
+
+void main()
+{
+    gl_FragColor = color;
+}
+)";
+
+BallsVisualizer::BallsVisualizer(int ballCount, float minRadius, float maxRadius)
+    : ballCount(ballCount), minRadius(minRadius), maxRadius(maxRadius), aspectRatio(1.0f), lastTime(0.0f)
 {
     std::random_device rd;
     rng.seed(rd());
 }
 
+BallsVisualizer::~BallsVisualizer()
+{
+    if (meshVbo)
+    {
+        glDeleteBuffers(1, &meshVbo);
+    }
+    if (instanceVbo)
+    {
+        glDeleteBuffers(1, &instanceVbo);
+    }
+}
+
 void BallsVisualizer::initialize(int width, int height)
 {
     Visualizer::initialize(width, height);
@@ -26,32 +81,31 @@ void BallsVisualizer::initialize(int width, int height)
 
 void BallsVisualizer::initializeBalls()
 {
-    balls.clear();
-    balls.reserve(NUM_BALLS);
+    simulation.resize(0);
+    simulation.resize(ballCount);
+    colors.assign(ballCount * 3, 0.0f);
 
     std::uniform_real_distribution<float> xDist(-0.8f, 0.8f);
     std::uniform_real_distribution<float> yDist(-0.5f, 0.8f);
     std::uniform_real_distribution<float> vxDist(-1.0f, 1.0f);
     std::uniform_real_distribution<float> vyDist(-0.5f, 1.5f);
-    std::uniform_real_distribution<float> radiusDist(MIN_RADIUS, MAX_RADIUS);
+    std::uniform_real_distribution<float> radiusDist(minRadius, maxRadius);
     std::uniform_real_distribution<float> colorDist(0.3f, 1.0f);
     std::uniform_int_distribution<int> bandDist(0, NUM_FREQUENCY_BANDS - 1);
 
     // Generate colorful balls with varied properties
-    for (int i = 0; i < NUM_BALLS; i++)
+    for (int i = 0; i < ballCount; i++)
     {
-        Ball ball;
-        ball.x = xDist(rng);
-        ball.y = yDist(rng);
-        ball.vx = vxDist(rng);
-        ball.vy = vyDist(rng);
-        ball.radius = radiusDist(rng);
-        ball.energy = 0.0f;
-        ball.frequencyBand = bandDist(rng);
-        ball.bounceIntensity = 0.0f;
+        simulation.x[i] = xDist(rng);
+        simulation.y[i] = yDist(rng);
+        simulation.vx[i] = vxDist(rng);
+        simulation.vy[i] = vyDist(rng);
+        simulation.radius[i] = radiusDist(rng);
+        simulation.band[i] = bandDist(rng);
+        float *color = &colors[i * 3];
 
         // Create rainbow-like colors based on ball index
-        float hue = static_cast<float>(i) / NUM_BALLS * 360.0f;
+        float hue = static_cast<float>(i) / ballCount * 360.0f;
         float saturation = 0.8f + colorDist(rng) * 0.2f;
         float value = 0.7f + colorDist(rng) * 0.3f;
 
@@ -62,97 +116,64 @@ void BallsVisualizer::initializeBalls()
 
         if (hue < 60)
         {
-            ball.color[0] = c + m;
-            ball.color[1] = x + m;
-            ball.color[2] = m;
+            color[0] = c + m;
+            color[1] = x + m;
+            color[2] = m;
         }
         else if (hue < 120)
         {
-            ball.color[0] = x + m;
-            ball.color[1] = c + m;
-            ball.color[2] = m;
+            color[0] = x + m;
+            color[1] = c + m;
+            color[2] = m;
         }
         else if (hue < 180)
         {
-            ball.color[0] = m;
-            ball.color[1] = c + m;
-            ball.color[2] = x + m;
+            color[0] = m;
+            color[1] = c + m;
+            color[2] = x + m;
         }
         else if (hue < 240)
         {
-            ball.color[0] = m;
-            ball.color[1] = x + m;
-            ball.color[2] = c + m;
+            color[0] = m;
+            color[1] = x + m;
+            color[2] = c + m;
         }
         else if (hue < 300)
         {
-            ball.color[0] = x + m;
-            ball.color[1] = m;
-            ball.color[2] = c + m;
+            color[0] = x + m;
+            color[1] = m;
+            color[2] = c + m;
         }
         else
         {
-            ball.color[0] = c + m;
-            ball.color[1] = m;
-            ball.color[2] = x + m;
+            color[0] = c + m;
+            color[1] = m;
+            color[2] = x + m;
         }
-
-        balls.push_back(ball);
     }
 }
 
-void BallsVisualizer::renderFrame(const std::vector<float> &audioData,
-                                  double *in,
-                                  fftw_complex *out,
-                                  fftw_plan &plan,
+void BallsVisualizer::renderFrame(const AnalysisFrame &analysis,
                                   float timeSeconds)
 {
-    // Process audio data for FFT
-    size_t numSamples = std::min(static_cast<size_t>(N), audioData.size());
-    for (size_t i = 0; i < numSamples; i++)
-    {
-        // Apply Hanning window
-        double multiplier = 0.5 * (1 - cos(2 * M_PI * i / (N - 1)));
-        in[i] = audioData[i] * multiplier;
-    }
-
-    // Execute FFT
-    fftw_execute(plan);
-
-    std::vector<float> magnitudes = calculateMagnitudes(out);
+    std::vector<float> magnitudes = calculateMagnitudes(analysis.primary());
     render(timeSeconds, magnitudes);
 }
 
-void BallsVisualizer::renderLiveFrame(const std::vector<float> &audioData,
-                                      double *in,
-                                      fftw_complex *out,
-                                      fftw_plan &plan,
+void BallsVisualizer::renderLiveFrame(const AnalysisFrame &analysis,
                                       size_t currentPosition)
 {
-    // Process audio data for FFT
-    size_t numSamples = std::min(static_cast<size_t>(N), audioData.size());
-    for (size_t i = 0; i < numSamples; i++)
-    {
-        size_t index = (currentPosition + i) % audioData.size();
-        // Apply Hanning window
-        double multiplier = 0.5 * (1 - cos(2 * M_PI * i / (N - 1)));
-        in[i] = audioData[index] * multiplier;
-    }
-
-    // Execute FFT
-    fftw_execute(plan);
-
-    float timeSeconds = static_cast<float>(currentPosition) / 44100.0f;
-    std::vector<float> magnitudes = calculateMagnitudes(out);
+    float timeSeconds = static_cast<float>(currentPosition) / analysis.sampleRate;
+    std::vector<float> magnitudes = calculateMagnitudes(analysis.primary());
     render(timeSeconds, magnitudes);
 }
 
-std::vector<float> BallsVisualizer::calculateMagnitudes(fftw_complex *out)
+std::vector<float> BallsVisualizer::calculateMagnitudes(const SourceSpectrum &spectrum)
 {
-    std::vector<float> magnitudes(N / 2);
-    for (size_t i = 0; i < N / 2; i++)
+    std::vector<float> magnitudes(spectrum.magnitudes.size() - 1);
+    for (size_t i = 0; i < magnitudes.size(); i++)
     {
-        magnitudes[i] = sqrt(out[i][0] * out[i][0] + out[i][1] * out[i][1]) / N;
+        magnitudes[i] = spectrum.magnitudes[i] / N;
     }
     return magnitudes;
 }
@@ -167,19 +188,11 @@ void BallsVisualizer::render(float time, const std::vector<float> &magnitudes)
     lastTime = time;
 
     // Set up 2D rendering
-    glMatrixMode(GL_PROJECTION);
-    glLoadIdentity();
-    glOrtho(-1.0f * aspectRatio, 1.0f * aspectRatio, -1.0f, 1.0f, -1.0f, 1.0f);
-    glMatrixMode(GL_MODELVIEW);
-    glLoadIdentity();
+    camera.set(orthoMatrix(-aspectRatio, aspectRatio, -1.0f, 1.0f, -1.0f, 1.0f));
 
     // Update and render balls
     updateBalls(deltaTime, magnitudes);
-
-    for (const auto &ball : balls)
-    {
-        drawBall(ball);
-    }
+    drawBalls();
 }
 
 void BallsVisualizer::updateBalls(float deltaTime, const std::vector<float> &magnitudes)
@@ -203,123 +216,100 @@ void BallsVisualizer::updateBalls(float deltaTime, const std::vector<float> &mag
         bandEnergies[i] = std::min(1.0f, bandEnergies[i] * AUDIO_SENSITIVITY);
     }
 
-    // Update each ball
-    for (auto &ball : balls)
-    {
-        // Apply gravity
-        ball.vy -= GRAVITY * deltaTime;
-
-        // Get audio energy for this ball's frequency band
-        float audioEnergy = 0.0f;
-        if (ball.frequencyBand < static_cast<int>(bandEnergies.size()))
-        {
-            audioEnergy = bandEnergies[ball.frequencyBand];
-        }
-
-        // Update energy with decay
-        ball.energy = ball.energy * ENERGY_DECAY + audioEnergy * (1.0f - ENERGY_DECAY);
-
-        // Calculate bounce intensity
-        ball.bounceIntensity = BASE_BOUNCE_FORCE + ball.energy * (MAX_BOUNCE_FORCE - BASE_BOUNCE_FORCE);
-
-        // Update position
-        ball.x += ball.vx * deltaTime;
-        ball.y += ball.vy * deltaTime;
-
-        // Apply damping
-        ball.vx *= DAMPING;
-        ball.vy *= DAMPING;
-
-        // Bounce off walls (accounting for aspect ratio)
-        float maxX = aspectRatio - ball.radius;
-        float minX = -aspectRatio + ball.radius;
-
-        if (ball.x > maxX)
-        {
-            ball.x = maxX;
-            ball.vx = -std::abs(ball.vx) * BOUNCE_DAMPING;
-            // Audio-reactive bounce
-            ball.vy += ball.bounceIntensity * audioEnergy;
-        }
-        else if (ball.x < minX)
-        {
-            ball.x = minX;
-            ball.vx = std::abs(ball.vx) * BOUNCE_DAMPING;
-            // Audio-reactive bounce
-            ball.vy += ball.bounceIntensity * audioEnergy;
-        }
+    simulation.step(deltaTime, aspectRatio, bandEnergies);
+}
 
-        // Bounce off floor and ceiling
-        if (ball.y > (1.0f - ball.radius))
-        {
-            ball.y = 1.0f - ball.radius;
-            ball.vy = -std::abs(ball.vy) * BOUNCE_DAMPING;
-            // Audio-reactive bounce
-            ball.vy -= ball.bounceIntensity * audioEnergy;
-        }
-        else if (ball.y < (-1.0f + ball.radius))
-        {
-            ball.y = -1.0f + ball.radius;
-            ball.vy = std::abs(ball.vy) * BOUNCE_DAMPING;
-            // Strong audio-reactive bounce from floor
-            ball.vy += ball.bounceIntensity * audioEnergy * 1.5f;
-        }
+void BallsVisualizer::createMesh()
+{
+    // Centre first, then the rim closed back on itself: the fill is a fan
+    // over all of it and the outline a loop over the rim alone
+    std::vector<float> mesh = {0.0f, 0.0f};
+    for (int i = 0; i <= BALL_SEGMENTS; i++)
+    {
+        float angle = static_cast<float>(i) * 2.0f * M_PI / BALL_SEGMENTS;
+        mesh.push_back(std::cos(angle));
+        mesh.push_back(std::sin(angle));
+    }
 
-        // Clamp velocities to prevent extreme speeds
-        ball.vx = std::max(-MAX_VELOCITY, std::min(MAX_VELOCITY, ball.vx));
-        ball.vy = std::max(-MAX_VELOCITY, std::min(MAX_VELOCITY, ball.vy));
+    glGenBuffers(1, &meshVbo);
+    glBindBuffer(GL_ARRAY_BUFFER, meshVbo);
+    glBufferData(GL_ARRAY_BUFFER, mesh.size() * sizeof(float), mesh.data(), GL_STATIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glGenBuffers(1, &instanceVbo);
 
-        // Stop very slow movement
-        if (std::abs(ball.vx) < MIN_VELOCITY)
-            ball.vx = 0.0f;
-        if (std::abs(ball.vy) < MIN_VELOCITY)
-            ball.vy = 0.0f;
+    balls.attribute(0, meshVbo, 2);
+    if (VertexArray::instancing())
+    {
+        balls.attribute(1, instanceVbo, 4, sizeof(BallInstance), offsetof(BallInstance, x), 1);
+        balls.attribute(2, instanceVbo, 3, sizeof(BallInstance), offsetof(BallInstance, color), 1);
     }
 }
 
-void BallsVisualizer::drawBall(const Ball &ball)
+void BallsVisualizer::drawBalls()
 {
-    glPushMatrix();
-    glTranslatef(ball.x, ball.y, 0.0f);
-
-    // Make balls glow based on their energy level
-    float intensity = 0.6f + ball.energy * 0.4f;
-    glColor4f(ball.color[0] * intensity,
-              ball.color[1] * intensity,
-              ball.color[2] * intensity,
-              0.9f);
+    if (simulation.size() == 0 || !shader.build(BALL_VERTEX_SHADER, BALL_FRAGMENT_SHADER, {"unitVertex", "placement", "ballColor"}))
+        return;
 
-    // Draw filled circle
-    glBegin(GL_TRIANGLE_FAN);
-    glVertex2f(0.0f, 0.0f); // Center
-
-    for (int i = 0; i <= BALL_SEGMENTS; i++)
+    if (!meshVbo)
     {
-        float angle = static_cast<float>(i) * 2.0f * M_PI / BALL_SEGMENTS;
-        float x = ball.radius * cos(angle);
-        float y = ball.radius * sin(angle);
-        glVertex2f(x, y);
+        createMesh();
     }
-    glEnd();
 
-    // Draw bright outline for extra glow effect
-    if (ball.energy > 0.3f)
+    instances.resize(simulation.size());
+    for (size_t i = 0; i < instances.size(); i++)
     {
-        glColor4f(ball.color[0], ball.color[1], ball.color[2], ball.energy * 0.7f);
-        glLineWidth(2.0f);
+        const float *color = &colors[i * 3];
+        instances[i] = {simulation.x[i], simulation.y[i], simulation.radius[i], simulation.energy[i], {color[0], color[1], color[2]}};
+    }
+    const GLsizei count = static_cast<GLsizei>(instances.size());
 
-        glBegin(GL_LINE_LOOP);
-        for (int i = 0; i < BALL_SEGMENTS; i++)
+    shader.use();
+    camera.apply(shader);
+    GLint outline = shader.uniform("outline");
+    balls.bind();
+
+    if (VertexArray::instancing())
+    {
+        // Orphan last frame's instances rather than waiting on their draw
+        size_t bytes = instances.size() * sizeof(BallInstance);
+        glBindBuffer(GL_ARRAY_BUFFER, instanceVbo);
+        if (bytes > instanceCapacity)
         {
-            float angle = static_cast<float>(i) * 2.0f * M_PI / BALL_SEGMENTS;
-            float x = ball.radius * cos(angle);
-            float y = ball.radius * sin(angle);
-            glVertex2f(x, y);
+            instanceCapacity = std::max(bytes, instanceCapacity * 2);
+        }
+        glBufferData(GL_ARRAY_BUFFER, instanceCapacity, nullptr, GL_STREAM_DRAW);
+        glBufferSubData(GL_ARRAY_BUFFER, 0, bytes, instances.data());
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+        // Every fill in one call, then every outline in another
+        ShaderProgram::set(outline, 0.0f);
+        VertexArray::drawArraysInstanced(GL_TRIANGLE_FAN, 0, BALL_SEGMENTS + 2, count);
+        GLProfile::lineWidth(2.0f);
+        ShaderProgram::set(outline, 1.0f);
+        VertexArray::drawArraysInstanced(GL_LINE_LOOP, 1, BALL_SEGMENTS, count);
+        GLProfile::lineWidth(1.0f);
+    }
+    else
+    {
+        // Without instancing the per-ball values become constant attributes
+        // and each ball is its own draw of the shared mesh
+        for (int pass = 0; pass < 2; pass++)
+        {
+            ShaderProgram::set(outline, static_cast<float>(pass));
+            glLineWidth(pass ? 2.0f : 1.0f);
+            for (const BallInstance &instance : instances)
+            {
+                glVertexAttrib4f(1, instance.x, instance.y, instance.radius, instance.energy);
+                glVertexAttrib3fv(2, instance.color);
+                if (pass)
+                    glDrawArrays(GL_LINE_LOOP, 1, BALL_SEGMENTS);
+                else
+                    glDrawArrays(GL_TRIANGLE_FAN, 0, BALL_SEGMENTS + 2);
+            }
         }
-        glEnd();
-
         glLineWidth(1.0f);
     }
 
-    glPopMatrix();
-}
\ No newline at end of file
+    balls.unbind();
+    ShaderProgram::release();
+}
@@ -1,64 +1,70 @@
 #pragma once
 
 #include "visualizer_base.h"
+#include "shader_program.h"
+#include "uniform_buffer.h"
+#include "vertex_array.h"
+#include "ball_simulation.h"
 #include <vector>
 #include <array>
 #include <random>
 
-struct Ball
-{
-    float x, y;            // Position
-    float vx, vy;          // Velocity
-    float radius;          // Size
-    float color[3];        // RGB color
-    float energy;          // Energy level for audio reactivity
-    int frequencyBand;     // Which frequency band this ball responds to
-    float bounceIntensity; // How much it bounces based on audio
-};
-
 class BallsVisualizer : public Visualizer
 {
 public:
-    BallsVisualizer();
-    ~BallsVisualizer() override = default;
+    // Ball count and radius range; the swarm variant uses thousands of
+    // small balls
+    explicit BallsVisualizer(int ballCount = NUM_BALLS, float minRadius = MIN_RADIUS, float maxRadius = MAX_RADIUS);
+    ~BallsVisualizer() override;
+
+    static constexpr int SWARM_BALLS = 10000;
+    static constexpr float SWARM_MIN_RADIUS = 0.004f;
+    static constexpr float SWARM_MAX_RADIUS = 0.01f;
 
     void initialize(int width, int height) override;
 
-    void renderFrame(const std::vector<float> &audioData,
-                     double *in,
-                     fftw_complex *out,
-                     fftw_plan &plan,
+    bool supportsCoreProfile() const override { return true; }
+
+    void renderFrame(const AnalysisFrame &analysis,
                      float timeSeconds) override;
 
-    void renderLiveFrame(const std::vector<float> &audioData,
-                         double *in,
-                         fftw_complex *out,
-                         fftw_plan &plan,
+    void renderLiveFrame(const AnalysisFrame &analysis,
                          size_t currentPosition) override;
 
 private:
     void render(float time, const std::vector<float> &magnitudes);
     void updateBalls(float deltaTime, const std::vector<float> &magnitudes);
-    void drawBall(const Ball &ball);
-    std::vector<float> calculateMagnitudes(fftw_complex *out);
+    void drawBalls();
+    void createMesh();
+    std::vector<float> calculateMagnitudes(const SourceSpectrum &spectrum);
     void initializeBalls();
 
-    std::vector<Ball> balls;
+    BallSimulation simulation;
+    std::vector<float> colors; // RGB per ball
+    int ballCount;
+    float minRadius;
+    float maxRadius;
     std::mt19937 rng;
+
+    // Every ball is one instance of a unit circle mesh uploaded once; the
+    // per-ball values stream in one buffer each frame
+    struct BallInstance
+    {
+        float x, y, radius, energy;
+        float color[3];
+    };
+
+    ShaderProgram shader;
+    CameraUniforms camera;
+    GLuint meshVbo = 0;
+    GLuint instanceVbo = 0;
+    VertexArray balls;
+    size_t instanceCapacity = 0; // Bytes
+    std::vector<BallInstance> instances;
     float aspectRatio;
     float lastTime;
 
-    // Physics parameters
-    static constexpr float GRAVITY = 0.5f;
-    static constexpr float DAMPING = 0.98f;
-    static constexpr float BOUNCE_DAMPING = 0.85f;
-    static constexpr float MIN_VELOCITY = 0.01f;
-    static constexpr float MAX_VELOCITY = 3.0f;
-
     // Audio reactivity parameters
-    static constexpr float BASE_BOUNCE_FORCE = 0.3f;
-    static constexpr float MAX_BOUNCE_FORCE = 2.5f;
-    static constexpr float ENERGY_DECAY = 0.95f;
     static constexpr float AUDIO_SENSITIVITY = 8.0f;
 
     // Visual parameters
@@ -5,37 +5,66 @@ set -e
 
 # Compiler and flags
 CXX="clang++"
-CXXFLAGS="-std=c++17 -Wall -Wextra"
+CXXFLAGS="-std=c++17 -O2 -Wall -Wextra"
 
 # Include and library paths for macOS (using Homebrew paths for ARM64)
 INCLUDES="-I/opt/homebrew/include"
 LDFLAGS="-L/opt/homebrew/lib"
-LIBS="-lglfw -lGLEW -framework OpenGL -lfftw3 -lsndfile -lportaudio"
-FFMPEG_LIBS="-lavcodec -lavformat -lavutil -lswscale"
+LIBS="-lglfw -lGLEW -framework OpenGL -lfftw3f -lsndfile -lportaudio"
+FFMPEG_LIBS="-lavcodec -lavformat -lavutil"
+
+# ./build.sh test builds and runs the spectrum kernel accuracy checks
+if [ "$1" = "test" ]; then
+    echo "Compiling spectrum_kernels_test..."
+    $CXX $CXXFLAGS $INCLUDES spectrum_kernels.cpp spectrum_kernels_test.cpp -o spectrum_kernels_test
+    ./spectrum_kernels_test
+    exit 0
+fi
 
 # Source files (alphabetized)
 SOURCES=(
     "ascii_bar_equalizer.cpp"
+    "audio_source.cpp"
+    "ball_simulation.cpp"
     "balls_visualizer.cpp"
     "bar_equalizer.cpp"
     "mini_bar_equalizer.cpp"
+    "crt_effect.cpp"
     "cube_visualizer.cpp"
+    "fft_planner.cpp"
+    "frame_readback.cpp"
+    "gl_profile.cpp"
     "mini_circle_visualizer.cpp"
     "mini_cube_visualizer.cpp"
     "grid_visualizer.cpp"
     "hacker_terminal.cpp"
+    "live_playback.cpp"
+    "mapped_wav_source.cpp"
     "maze_visualizer.cpp"
     "mini_racer_visualizer.cpp"
     "mini_spectrogram.cpp"
+    "mix_engine.cpp"
     "multi_band_circle_waveform.cpp"
     "multi_band_waveform.cpp"
     "racer_visualizer.cpp"
+    "render_batch.cpp"
+    "render_target.cpp"
     "scroller_text.cpp"
+    "shader_program.cpp"
     "spectrogram.cpp"
+    "spectrum_analyzer.cpp"
+    "spectrum_kernels.cpp"
+    "streaming_wav_source.cpp"
+    "stroke_font.cpp"
     "terrain_visualizer_3d.cpp"
+    "text_renderer.cpp"
+    "uniform_buffer.cpp"
+    "vertex_array.cpp"
+    "video_recorder.cpp"
     "visualizer.cpp"
     "visualizer_factory.cpp"
     "waveform.cpp"
+    "yuv_convert.cpp"
 )
 
 # Compile each source file
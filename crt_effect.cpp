@@ -0,0 +1,272 @@
+#include "crt_effect.h"
+#include <cmath>
+#include <iostream>
+
+// Both passes draw one quad over the whole target, so the vertex shader
+// ignores the matrices and only derives texture coordinates
+static const char *FULL_SCREEN_VERTEX_SHADER = R"(#version 120
+attribute vec2 position;
+varying vec2 uv;
+
+void main()
+{
+    uv = position * 0.5 + 0.5;
+    gl_Position = vec4(position, 0.0, 1.0);
+}
+)";
+
+static const char *PERSISTENCE_FRAGMENT_SHADER = R"(#version 120
+uniform sampler2D scene;
+uniform sampler2D previous;
+uniform float persistence;
+varying vec2 uv;
+
+void main()
+{
+    vec3 fading = texture2D(previous, uv).rgb * persistence;
+    gl_FragColor = vec4(max(texture2D(scene, uv).rgb, fading), 1.0);
+}
+)";
+
+static const char *CRT_FRAGMENT_SHADER = R"(#version 120
+uniform sampler2D scene;
+uniform vec2 texelSize;
+uniform float scanlines;
+uniform float noise;
+uniform float bloom;
+uniform float time;
+varying vec2 uv;
+
+void main()
+{
+    vec3 color = texture2D(scene, uv).rgb;
+
+    // Glow from whatever is bright on two rings of eight taps; the linear
+    // filter blurs each tap a little more
+    if (bloom > 0.0)
+    {
+        vec3 glow = vec3(0.0);
+        for (int i = 0; i < 8; i++)
+        {
+            float angle = float(i) * 0.785398;
+            vec2 direction = vec2(cos(angle), sin(angle)) * texelSize;
+            glow += max(texture2D(scene, uv + direction * 2.0).rgb - 0.3, 0.0);
+            glow += max(texture2D(scene, uv + direction * 5.0).rgb - 0.3, 0.0) * 0.5;
+        }
+        color += glow * (bloom / 8.0);
+    }
+
+    // Darken every other row of pixels
+    color *= 1.0 - scanlines * mod(floor(gl_FragCoord.y), 2.0);
+
+    // Per-pixel flicker that changes every frame
+    float random = fract(sin(dot(gl_FragCoord.xy + time * 61.0, vec2(12.9898, 78.233))) * 43758.5453);
+    color += (random - 0.5) * noise;
+
+    gl_FragColor = vec4(color, 1.0);
+}
+)";
+
+CRTEffect::~CRTEffect()
+{
+    destroyTargets();
+    if (quadVbo)
+    {
+        glDeleteBuffers(1, &quadVbo);
+    }
+}
+
+bool CRTEffect::begin()
+{
+    if (unsupported)
+        return false;
+
+    if (!GLEW_ARB_framebuffer_object)
+    {
+        std::cerr << "Framebuffer objects are not supported; CRT effect disabled" << std::endl;
+        unsupported = true;
+        return false;
+    }
+
+    if (!crtShader.build(FULL_SCREEN_VERTEX_SHADER, CRT_FRAGMENT_SHADER, {"position"}) ||
+        !persistenceShader.build(FULL_SCREEN_VERTEX_SHADER, PERSISTENCE_FRAGMENT_SHADER, {"position"}))
+    {
+        unsupported = true;
+        return false;
+    }
+
+    // end() draws the frame wherever the drawing would have gone: the
+    // window, or the recording's offscreen target. Read before creating
+    // targets, which changes the binding.
+    GLint bound = 0;
+    glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &bound);
+    output = static_cast<GLuint>(bound);
+
+    // Follow the viewport, which is the window or the recording size
+    GLint viewport[4];
+    glGetIntegerv(GL_VIEWPORT, viewport);
+    if ((viewport[2] != width || viewport[3] != height) && !createTargets(viewport[2], viewport[3]))
+    {
+        destroyTargets();
+        glBindFramebuffer(GL_FRAMEBUFFER, output);
+        unsupported = true;
+        return false;
+    }
+
+    glBindFramebuffer(GL_FRAMEBUFFER, scene.framebuffer);
+    return true;
+}
+
+void CRTEffect::end(const CRTSettings &settings, float timeSeconds)
+{
+    glBindFramebuffer(GL_FRAMEBUFFER, output);
+
+    // Visualizers leave blending and depth testing in any state; they are
+    // put back afterwards
+    GLboolean blend = glIsEnabled(GL_BLEND);
+    GLboolean depthTest = glIsEnabled(GL_DEPTH_TEST);
+    glDisable(GL_BLEND);
+    glDisable(GL_DEPTH_TEST);
+
+    GLuint source = scene.texture;
+    if (settings.persistence > 0.0f)
+    {
+        int previous = current;
+        current = 1 - current;
+
+        glBindFramebuffer(GL_FRAMEBUFFER, phosphor[current].framebuffer);
+        persistenceShader.use();
+        ShaderProgram::set(persistenceShader.uniform("scene"), 0);
+        ShaderProgram::set(persistenceShader.uniform("previous"), 1);
+        ShaderProgram::set(persistenceShader.uniform("persistence"), settings.persistence);
+
+        glActiveTexture(GL_TEXTURE1);
+        glBindTexture(GL_TEXTURE_2D, phosphor[previous].texture);
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, scene.texture);
+        drawFullScreenQuad();
+
+        glActiveTexture(GL_TEXTURE1);
+        glBindTexture(GL_TEXTURE_2D, 0);
+        glActiveTexture(GL_TEXTURE0);
+        glBindFramebuffer(GL_FRAMEBUFFER, output);
+        source = phosphor[current].texture;
+    }
+
+    crtShader.use();
+    ShaderProgram::set(crtShader.uniform("scene"), 0);
+    ShaderProgram::set(crtShader.uniform("texelSize"), 1.0f / width, 1.0f / height);
+    ShaderProgram::set(crtShader.uniform("scanlines"), settings.scanlines);
+    ShaderProgram::set(crtShader.uniform("noise"), settings.noise);
+    ShaderProgram::set(crtShader.uniform("bloom"), settings.bloom);
+    // Wrapped so the noise keeps its precision in long recordings
+    ShaderProgram::set(crtShader.uniform("time"), std::fmod(timeSeconds, 100.0f));
+
+    glBindTexture(GL_TEXTURE_2D, source);
+    drawFullScreenQuad();
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    ShaderProgram::release();
+    if (blend)
+    {
+        glEnable(GL_BLEND);
+    }
+    if (depthTest)
+    {
+        glEnable(GL_DEPTH_TEST);
+    }
+}
+
+bool CRTEffect::createTargets(int newWidth, int newHeight)
+{
+    destroyTargets();
+    width = newWidth;
+    height = newHeight;
+
+    // Only the scene needs depth, for the 3D visualizers
+    glGenRenderbuffers(1, &depthBuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, depthBuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, width, height);
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+    bool complete = createTarget(scene, depthBuffer) &&
+                    createTarget(phosphor[0], 0) &&
+                    createTarget(phosphor[1], 0);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    return complete;
+}
+
+bool CRTEffect::createTarget(Target &target, GLuint depth)
+{
+    glGenTextures(1, &target.texture);
+    glBindTexture(GL_TEXTURE_2D, target.texture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    glGenFramebuffers(1, &target.framebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, target.framebuffer);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, target.texture, 0);
+    if (depth)
+    {
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, depth);
+    }
+
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+    {
+        std::cerr << "CRT effect framebuffer is incomplete; effect disabled" << std::endl;
+        return false;
+    }
+
+    // Start from black so persistence has nothing stale to fade, keeping
+    // the clear color the visualizer chose
+    GLfloat clearColor[4];
+    glGetFloatv(GL_COLOR_CLEAR_VALUE, clearColor);
+    glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+    glClear(GL_COLOR_BUFFER_BIT);
+    glClearColor(clearColor[0], clearColor[1], clearColor[2], clearColor[3]);
+    return true;
+}
+
+void CRTEffect::destroyTargets()
+{
+    for (Target *target : {&scene, &phosphor[0], &phosphor[1]})
+    {
+        if (target->framebuffer)
+        {
+            glDeleteFramebuffers(1, &target->framebuffer);
+        }
+        if (target->texture)
+        {
+            glDeleteTextures(1, &target->texture);
+        }
+        *target = Target();
+    }
+    if (depthBuffer)
+    {
+        glDeleteRenderbuffers(1, &depthBuffer);
+        depthBuffer = 0;
+    }
+    width = 0;
+    height = 0;
+}
+
+void CRTEffect::drawFullScreenQuad()
+{
+    if (!quadVbo)
+    {
+        static const float QUAD[8] = {-1.0f, -1.0f, 1.0f, -1.0f, 1.0f, 1.0f, -1.0f, 1.0f};
+        glGenBuffers(1, &quadVbo);
+        glBindBuffer(GL_ARRAY_BUFFER, quadVbo);
+        glBufferData(GL_ARRAY_BUFFER, sizeof(QUAD), QUAD, GL_STATIC_DRAW);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        quad.attribute(0, quadVbo, 2);
+    }
+
+    quad.bind();
+    glDrawArrays(GL_TRIANGLE_FAN, 0, 4);
+    quad.unbind();
+}
@@ -0,0 +1,70 @@
+#ifndef CRT_EFFECT_H
+#define CRT_EFFECT_H
+
+#include "shader_program.h"
+#include "vertex_array.h"
+#include <GL/glew.h>
+
+// How strongly a visualizer wants each part of the CRT look; all zero, the
+// default, leaves its frames untouched
+struct CRTSettings
+{
+    float scanlines = 0.0f;   // Darkening of every other pixel row, 0 to 1
+    float noise = 0.0f;       // Amplitude of the per-pixel flicker
+    float bloom = 0.0f;       // Strength of the glow around bright pixels
+    float persistence = 0.0f; // Share of the previous frame that lingers, 0 to 1
+
+    bool enabled() const { return scanlines > 0.0f || noise > 0.0f || bloom > 0.0f || persistence > 0.0f; }
+};
+
+// Post-process stage for the retro visualizers. The frame is rendered into
+// an offscreen target, and end() draws it to the output through one
+// full-screen shader that adds scanlines, noise and bloom. With persistence
+// a second small pass first blends in the fading previous frame, like a
+// slow phosphor.
+class CRTEffect
+{
+public:
+    CRTEffect() = default;
+    ~CRTEffect();
+
+    CRTEffect(const CRTEffect &) = delete;
+    CRTEffect &operator=(const CRTEffect &) = delete;
+
+    // Send the following drawing to the offscreen target, sized to the
+    // current viewport. Returns false, leaving drawing where it was, when
+    // framebuffer objects or the shaders are unavailable.
+    bool begin();
+
+    // Draw the frame with the effect applied to the framebuffer that was
+    // bound at begin()
+    void end(const CRTSettings &settings, float timeSeconds);
+
+private:
+    struct Target
+    {
+        GLuint framebuffer = 0;
+        GLuint texture = 0;
+    };
+
+    bool createTargets(int width, int height);
+    bool createTarget(Target &target, GLuint depthBuffer);
+    void destroyTargets();
+    void drawFullScreenQuad();
+
+    Target scene;
+    Target phosphor[2]; // Previous and current frame, swapped every frame
+    GLuint depthBuffer = 0;
+    int current = 0;
+    GLuint output = 0; // Bound when begin() was called
+    int width = 0;
+    int height = 0;
+    bool unsupported = false;
+
+    ShaderProgram crtShader;
+    ShaderProgram persistenceShader;
+    GLuint quadVbo = 0;
+    VertexArray quad;
+};
+
+#endif // CRT_EFFECT_H
@@ -1,10 +1,38 @@
 #include "cube_visualizer.h"
+#include "gl_math.h"
 #include <GL/glew.h>
 #include <cmath>
 
+// Cube edges placed by the model matrix, all in white
+static const char *CUBE_VERTEX_SHADER = R"(#version 120
+CAMERA_UNIFORMS
+uniform mat4 model;
+attribute vec3 position;
+
+void main()
+{
+    gl_Position = viewProjection * model * vec4(position, 1.0);
+}
+)";
+
+static const char *CUBE_FRAGMENT_SHADER = R"(#version 120
+void main()
+{
+    gl_FragColor = vec4(1.0);
+}
+)";
+
 CubeVisualizer::CubeVisualizer() : aspectRatio(1.0f) {
 }
 
+CubeVisualizer::~CubeVisualizer() {
+    for (GLuint buffer : {vertexVbo, edgeBuffer}) {
+        if (buffer) {
+            glDeleteBuffers(1, &buffer);
+        }
+    }
+}
+
 void CubeVisualizer::initialize(int width, int height) {
     Visualizer::initialize(width, height);
     aspectRatio = static_cast<float>(width) / height;
@@ -14,52 +42,23 @@ void CubeVisualizer::initialize(int width, int height) {
     glDepthFunc(GL_LESS);
 }
 
-void CubeVisualizer::renderFrame(const std::vector<float>& audioData,
-                               double* in,
-                               fftw_complex* out,
-                               fftw_plan& plan,
+void CubeVisualizer::renderFrame(const AnalysisFrame& analysis,
                                float timeSeconds) {
-    // Process audio data for FFT
-    size_t numSamples = std::min(static_cast<size_t>(N), audioData.size());
-    for (size_t i = 0; i < numSamples; i++) {
-        // Apply Hanning window
-        double multiplier = 0.5 * (1 - cos(2 * M_PI * i / (N - 1)));
-        in[i] = audioData[i] * multiplier;
-    }
-    
-    // Execute FFT
-    fftw_execute(plan);
-    
-    std::vector<float> magnitudes = calculateMagnitudes(out);
+    std::vector<float> magnitudes = calculateMagnitudes(analysis.primary());
     render(timeSeconds, magnitudes);
 }
 
-void CubeVisualizer::renderLiveFrame(const std::vector<float>& audioData,
-                                   double* in,
-                                   fftw_complex* out,
-                                   fftw_plan& plan,
+void CubeVisualizer::renderLiveFrame(const AnalysisFrame& analysis,
                                    size_t currentPosition) {
-    // Process audio data for FFT
-    size_t numSamples = std::min(static_cast<size_t>(N), audioData.size());
-    for (size_t i = 0; i < numSamples; i++) {
-        size_t index = (currentPosition + i) % audioData.size();
-        // Apply Hanning window
-        double multiplier = 0.5 * (1 - cos(2 * M_PI * i / (N - 1)));
-        in[i] = audioData[index] * multiplier;
-    }
-    
-    // Execute FFT
-    fftw_execute(plan);
-    
-    float timeSeconds = static_cast<float>(currentPosition) / 44100.0f;
-    std::vector<float> magnitudes = calculateMagnitudes(out);
+    float timeSeconds = static_cast<float>(currentPosition) / analysis.sampleRate;
+    std::vector<float> magnitudes = calculateMagnitudes(analysis.primary());
     render(timeSeconds, magnitudes);
 }
 
-std::vector<float> CubeVisualizer::calculateMagnitudes(fftw_complex* out) {
-    std::vector<float> magnitudes(N/2);
-    for (size_t i = 0; i < N/2; i++) {
-        magnitudes[i] = sqrt(out[i][0] * out[i][0] + out[i][1] * out[i][1]) / N;
+std::vector<float> CubeVisualizer::calculateMagnitudes(const SourceSpectrum& spectrum) {
+    std::vector<float> magnitudes(spectrum.magnitudes.size() - 1);
+    for (size_t i = 0; i < magnitudes.size(); i++) {
+        magnitudes[i] = spectrum.magnitudes[i] / N;
     }
     return magnitudes;
 }
@@ -103,72 +102,60 @@ void CubeVisualizer::render(float time, const std::vector<float>& magnitudes) {
     
     float scale = BASE_SCALE + smoothedAmplitude * BOUNCE_FACTOR;
     
-    // Set up perspective projection
-    glMatrixMode(GL_PROJECTION);
-    glLoadIdentity();
-    
-    // Modern perspective projection
-    float fovy = 45.0f * M_PI / 180.0f; // Convert to radians
-    float f = 1.0f / tan(fovy / 2.0f);
-    float zNear = 0.1f;
-    float zFar = 100.0f;
-    
-    float projMatrix[16] = {
-        f/aspectRatio, 0.0f, 0.0f, 0.0f,
-        0.0f, f, 0.0f, 0.0f,
-        0.0f, 0.0f, (zFar+zNear)/(zNear-zFar), -1.0f,
-        0.0f, 0.0f, (2.0f*zFar*zNear)/(zNear-zFar), 0.0f
-    };
+    // Set up perspective projection, then move the cube down and away
+    // with a slight tilt for better perspective
+    Mat4 projection = perspectiveMatrix(45.0f, aspectRatio, 0.1f, 100.0f);
+    Mat4 view = translationMatrix(0.0f, -0.40f, -4.0f) * rotationMatrix(20.0f, 1.0f, 0.0f, 0.0f);
+    camera.set(projection * view);
     
-    glLoadMatrixf(projMatrix);
+    // Draw the cube
+    drawCube(time * rotationSpeed, scale);
+}
+
+void CubeVisualizer::createBuffers() {
+    std::vector<GLuint> indices(edges.begin(), edges.end());
     
-    // Set up modelview matrix
-    glMatrixMode(GL_MODELVIEW);
-    glLoadIdentity();
-    glTranslatef(0.0f, -0.40f, -4.0f);  // Move to the left (changed from 0.25f to -0.25f)
+    glGenBuffers(1, &vertexVbo);
+    glBindBuffer(GL_ARRAY_BUFFER, vertexVbo);
+    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), vertices.data(), GL_STATIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
     
-    // Add a slight tilt for better perspective
-    glRotatef(20.0f, 1.0f, 0.0f, 0.0f);
+    glGenBuffers(1, &edgeBuffer);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, edgeBuffer);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(GLuint), indices.data(), GL_STATIC_DRAW);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
     
-    // Draw the cube
-    drawCube(time * rotationSpeed, scale);
+    cube.attribute(0, vertexVbo, 3);
+    cube.elements(edgeBuffer);
 }
 
 void CubeVisualizer::drawCube(float rotationAngle, float scale) {
-    glLineWidth(LINE_WIDTH);
-    
-    // Set up the cube's position and rotation
-    glPushMatrix();
-    
-    // Center the cube in world space
-    glTranslatef(0.0f, 0.5f, 0.0f);  // Move up slightly to center vertically
-    
-    // Base rotation around Y axis
-    glRotatef(rotationAngle * 2.0f, 0.0f, 1.0f, 0.0f);  // Doubled Y-axis rotation speed
-    
-    // Additional rotations for more dynamic motion
-    glRotatef(rotationAngle * 0.7f + 30.0f, 1.0f, 0.0f, 0.0f);  // X-axis rotation with offset
-    glRotatef(rotationAngle * 0.5f, 0.0f, 0.0f, 1.0f);  // Z-axis rotation
-    
-    // Scale uniformly
-    glScalef(scale, scale, scale);
-    
-    // Draw the cube edges in pure white
-    glBegin(GL_LINES);
-    for (size_t i = 0; i < edges.size(); i += 2) {
-        // Set color to pure white
-        glColor3f(1.0f, 1.0f, 1.0f);
-        
-        // Get vertex indices for this edge
-        int v1 = edges[i];
-        int v2 = edges[i + 1];
-        
-        // Draw the edge
-        glVertex3f(vertices[v1 * 3], vertices[v1 * 3 + 1], vertices[v1 * 3 + 2]);
-        glVertex3f(vertices[v2 * 3], vertices[v2 * 3 + 1], vertices[v2 * 3 + 2]);
+    if (!shader.build(CUBE_VERTEX_SHADER, CUBE_FRAGMENT_SHADER, {"position"})) {
+        return;
     }
-    glEnd();
     
-    glPopMatrix();
-    glLineWidth(1.0f);  // Reset line width
-} 
\ No newline at end of file
+    if (!vertexVbo) {
+        createBuffers();
+    }
+    
+    // Center the cube in world space, moved up slightly to center it
+    // vertically; doubled rotation around Y, plus X and Z rotations for
+    // more dynamic motion, then a uniform scale
+    Mat4 model = translationMatrix(0.0f, 0.5f, 0.0f) *
+                 rotationMatrix(rotationAngle * 2.0f, 0.0f, 1.0f, 0.0f) *
+                 rotationMatrix(rotationAngle * 0.7f + 30.0f, 1.0f, 0.0f, 0.0f) *
+                 rotationMatrix(rotationAngle * 0.5f, 0.0f, 0.0f, 1.0f) *
+                 scaleMatrix(scale, scale, scale);
+    
+    shader.use();
+    camera.apply(shader);
+    ShaderProgram::set(shader.uniform("model"), model);
+    
+    GLProfile::lineWidth(LINE_WIDTH);
+    cube.bind();
+    glDrawElements(GL_LINES, static_cast<GLsizei>(edges.size()), GL_UNSIGNED_INT, nullptr);
+    cube.unbind();
+    GLProfile::lineWidth(1.0f);  // Reset line width
+    
+    ShaderProgram::release();
+}
@@ -1,32 +1,32 @@
 #pragma once
 
 #include "visualizer_base.h"
+#include "shader_program.h"
+#include "uniform_buffer.h"
+#include "vertex_array.h"
 #include <vector>
 #include <array>
 
 class CubeVisualizer : public Visualizer {
 public:
     CubeVisualizer();
-    ~CubeVisualizer() override = default;
+    ~CubeVisualizer() override;
 
     void initialize(int width, int height) override;
+
+    bool supportsCoreProfile() const override { return true; }
     
-    void renderFrame(const std::vector<float>& audioData,
-                    double* in,
-                    fftw_complex* out,
-                    fftw_plan& plan,
+    void renderFrame(const AnalysisFrame& analysis,
                     float timeSeconds) override;
                     
-    void renderLiveFrame(const std::vector<float>& audioData,
-                        double* in,
-                        fftw_complex* out,
-                        fftw_plan& plan,
+    void renderLiveFrame(const AnalysisFrame& analysis,
                         size_t currentPosition) override;
 
 private:
     void render(float time, const std::vector<float>& magnitudes);
     void drawCube(float rotationAngle, float scale);
-    std::vector<float> calculateMagnitudes(fftw_complex* out);
+    void createBuffers();
+    std::vector<float> calculateMagnitudes(const SourceSpectrum& spectrum);
     
     // Cube vertices (8 corners)
     static constexpr std::array<float, 24> vertices = {
@@ -64,4 +64,11 @@ private:
     
     float aspectRatio;
     float lastAmplitude = 0.0f;  // Store last amplitude for smoothing
+    
+    // The corners and edges above, uploaded once and drawn by index
+    ShaderProgram shader;
+    CameraUniforms camera;
+    GLuint vertexVbo = 0;
+    GLuint edgeBuffer = 0;
+    VertexArray cube;
 }; 
\ No newline at end of file
@@ -0,0 +1,121 @@
+#include "fft_planner.h"
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <utility>
+
+// The FFTW planner is not thread-safe; executing finished plans is
+static std::mutex plannerMutex;
+static unsigned int plannerFlags = FFTW_MEASURE;
+
+// Every plan handed out so far; never erased, so references stay valid
+static std::map<std::pair<int, FFTKind>, std::unique_ptr<FFTPlan>> plans;
+
+FFTBuffers::FFTBuffers(int size) : n(size)
+{
+    realData = fftwf_alloc_real(size);
+    complexData = fftwf_alloc_complex(size / 2 + 1);
+}
+
+FFTBuffers::~FFTBuffers()
+{
+    fftwf_free(realData);
+    fftwf_free(complexData);
+}
+
+FFTBuffers::FFTBuffers(FFTBuffers &&other) noexcept
+    : n(other.n), realData(other.realData), complexData(other.complexData)
+{
+    other.n = 0;
+    other.realData = nullptr;
+    other.complexData = nullptr;
+}
+
+FFTBuffers &FFTBuffers::operator=(FFTBuffers &&other) noexcept
+{
+    std::swap(n, other.n);
+    std::swap(realData, other.realData);
+    std::swap(complexData, other.complexData);
+    return *this;
+}
+
+void FFTPlan::execute(const FFTBuffers &buffers) const
+{
+    // The new-array execute functions only need matching size and alignment,
+    // which fftwf_malloc guarantees
+    if (transformKind == FFTKind::RealToComplex)
+        fftwf_execute_dft_r2c(plan, buffers.real(), buffers.complex());
+    else
+        fftwf_execute_dft_c2r(plan, buffers.complex(), buffers.real());
+}
+
+void FFTPlanner::loadWisdom()
+{
+    std::lock_guard<std::mutex> lock(plannerMutex);
+    std::string path = wisdomPath();
+    if (!path.empty() && fftwf_import_wisdom_from_filename(path.c_str()))
+    {
+        std::cout << "Loaded FFT wisdom from " << path << std::endl;
+    }
+}
+
+void FFTPlanner::setPatient(bool patient)
+{
+    std::lock_guard<std::mutex> lock(plannerMutex);
+    plannerFlags = patient ? FFTW_PATIENT : FFTW_MEASURE;
+}
+
+const FFTPlan &FFTPlanner::plan(int size, FFTKind kind)
+{
+    std::lock_guard<std::mutex> lock(plannerMutex);
+    auto found = plans.find(std::make_pair(size, kind));
+    if (found != plans.end())
+        return *found->second;
+
+    // Measuring overwrites the arrays, so plan on scratch buffers; callers
+    // execute on their own
+    FFTBuffers scratch(size);
+    auto create = [&](unsigned int flags)
+    {
+        if (kind == FFTKind::RealToComplex)
+            return fftwf_plan_dft_r2c_1d(size, scratch.real(), scratch.complex(), flags);
+        return fftwf_plan_dft_c2r_1d(size, scratch.complex(), scratch.real(), flags);
+    };
+
+    fftwf_plan created = create(plannerFlags);
+    if (!created)
+    {
+        // Should not happen for 1D real transforms, but never hand out null
+        std::cerr << "Measured FFT planning failed for size " << size << ", falling back to an estimate" << std::endl;
+        created = create(FFTW_ESTIMATE);
+    }
+    else
+    {
+        // Sizes that were already known add nothing, so rewriting is cheap
+        saveWisdom();
+    }
+
+    std::unique_ptr<FFTPlan> &entry = plans[std::make_pair(size, kind)];
+    entry.reset(new FFTPlan(size, kind, created));
+    return *entry;
+}
+
+std::string FFTPlanner::wisdomPath()
+{
+    if (const char *path = std::getenv("VISUALIZER_FFT_WISDOM"))
+        return path;
+    if (const char *home = std::getenv("HOME"))
+        return std::string(home) + "/.visualizer_fftwf_wisdom";
+    return "";
+}
+
+void FFTPlanner::saveWisdom()
+{
+    std::string path = wisdomPath();
+    if (!path.empty() && !fftwf_export_wisdom_to_filename(path.c_str()))
+    {
+        std::cerr << "Warning: could not save FFT wisdom to " << path << std::endl;
+    }
+}
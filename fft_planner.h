@@ -0,0 +1,81 @@
+#ifndef FFT_PLANNER_H
+#define FFT_PLANNER_H
+
+#include <fftw3.h>
+#include <string>
+
+// Transforms the planner can create
+enum class FFTKind
+{
+    RealToComplex, // size real samples -> size/2+1 complex bins
+    ComplexToReal  // size/2+1 complex bins -> size real samples, unnormalized; overwrites the bins
+};
+
+// Aligned input and output arrays for one transform size. Each thread that
+// runs transforms owns its own buffers.
+class FFTBuffers
+{
+public:
+    explicit FFTBuffers(int size);
+    ~FFTBuffers();
+
+    FFTBuffers(FFTBuffers &&other) noexcept;
+    FFTBuffers &operator=(FFTBuffers &&other) noexcept;
+    FFTBuffers(const FFTBuffers &) = delete;
+    FFTBuffers &operator=(const FFTBuffers &) = delete;
+
+    int size() const { return n; }
+    float *real() const { return realData; }              // size samples
+    fftwf_complex *complex() const { return complexData; } // size/2+1 bins
+
+private:
+    int n = 0;
+    float *realData = nullptr;
+    fftwf_complex *complexData = nullptr;
+};
+
+// A cached plan for one size and kind. Plans live for the whole run and can
+// be executed from any number of threads at once, each on its own buffers.
+class FFTPlan
+{
+public:
+    FFTPlan(int size, FFTKind kind, fftwf_plan plan) : n(size), transformKind(kind), plan(plan) {}
+
+    int size() const { return n; }
+    FFTKind kind() const { return transformKind; }
+
+    // Run the transform between the buffers' real and complex arrays, in the
+    // direction given by kind(). Buffers must have the same size.
+    void execute(const FFTBuffers &buffers) const;
+
+private:
+    int n;
+    FFTKind transformKind;
+    fftwf_plan plan;
+};
+
+// Thread-safe registry of single-precision FFTW plans for any size. Plans
+// are measured on first request and then shared; the resulting wisdom is
+// kept in a cache file, so tuning only costs time on the first run for
+// each size.
+class FFTPlanner
+{
+public:
+    // Load wisdom from the cache file; call once before the first plan
+    static void loadWisdom();
+
+    // Spend longer searching for the fastest plan (FFTW_PATIENT instead of
+    // FFTW_MEASURE); only affects sizes not already in the wisdom cache
+    static void setPatient(bool patient);
+
+    // The shared plan for this size and kind, created on first use
+    static const FFTPlan &plan(int size, FFTKind kind);
+
+    // Where wisdom is stored: $VISUALIZER_FFT_WISDOM, else ~/.visualizer_fftwf_wisdom
+    static std::string wisdomPath();
+
+private:
+    static void saveWisdom();
+};
+
+#endif // FFT_PLANNER_H
@@ -0,0 +1,73 @@
+#include "frame_readback.h"
+#include <iostream>
+
+FrameReadback::~FrameReadback()
+{
+    for (Slot &slot : slots)
+    {
+        if (slot.buffer)
+        {
+            glDeleteBuffers(1, &slot.buffer);
+        }
+    }
+}
+
+void FrameReadback::read(int width, int height, int frameIndex)
+{
+    if (count == RING_SIZE)
+    {
+        std::cerr << "Frame readback ring is full; frame " << frameIndex << " dropped" << std::endl;
+        return;
+    }
+
+    Slot &slot = slots[(oldest + count) % RING_SIZE];
+    size_t bytes = static_cast<size_t>(width) * height * 4;
+    if (!slot.buffer)
+    {
+        glGenBuffers(1, &slot.buffer);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+    if (bytes != slot.capacity)
+    {
+        glBufferData(GL_PIXEL_PACK_BUFFER, bytes, nullptr, GL_STREAM_READ);
+        slot.capacity = bytes;
+    }
+
+    // With a pack buffer bound the pointer is an offset into it, and the
+    // call returns without waiting for the frame to finish. RGBA matches
+    // the framebuffer, so the driver copies rows without repacking them.
+    glPixelStorei(GL_PACK_ALIGNMENT, 4);
+    glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    slot.frameIndex = frameIndex;
+    count++;
+}
+
+const uint8_t *FrameReadback::acquire(bool flush, int &frameIndex)
+{
+    if (count == 0 || (count < RING_SIZE && !flush))
+        return nullptr;
+
+    Slot &slot = slots[oldest];
+    frameIndex = slot.frameIndex;
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+    const void *pixels = glMapBuffer(GL_PIXEL_PACK_BUFFER, GL_READ_ONLY);
+    if (!pixels)
+    {
+        std::cerr << "Could not map readback buffer; frame " << frameIndex << " dropped" << std::endl;
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        oldest = (oldest + 1) % RING_SIZE;
+        count--;
+        return nullptr;
+    }
+    return static_cast<const uint8_t *>(pixels);
+}
+
+void FrameReadback::release()
+{
+    glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    oldest = (oldest + 1) % RING_SIZE;
+    count--;
+}
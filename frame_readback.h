@@ -0,0 +1,49 @@
+#ifndef FRAME_READBACK_H
+#define FRAME_READBACK_H
+
+#include <GL/glew.h>
+#include <cstddef>
+#include <cstdint>
+
+// Reads rendered frames back through a ring of pixel-pack buffers. read()
+// only queues the copy of the frame just drawn; that frame is mapped once
+// the ring is full, RING_SIZE - 1 frames later, so the transfer overlaps
+// the rendering in between instead of stalling on it.
+class FrameReadback
+{
+public:
+    static constexpr int RING_SIZE = 3;
+
+    FrameReadback() = default;
+    ~FrameReadback();
+
+    FrameReadback(const FrameReadback &) = delete;
+    FrameReadback &operator=(const FrameReadback &) = delete;
+
+    // Queue a copy of the read framebuffer as tightly packed RGBA rows,
+    // bottom row first. The ring must not be full.
+    void read(int width, int height, int frameIndex);
+
+    // Map the oldest queued frame: once the ring is full, or whenever a
+    // frame is queued if flush is set. Returns nullptr when there is
+    // nothing to map or mapping failed; otherwise release() must follow
+    // before the next read().
+    const uint8_t *acquire(bool flush, int &frameIndex);
+    void release();
+
+    int pending() const { return count; }
+
+private:
+    struct Slot
+    {
+        GLuint buffer = 0;
+        size_t capacity = 0;
+        int frameIndex = 0;
+    };
+
+    Slot slots[RING_SIZE];
+    int oldest = 0;
+    int count = 0;
+};
+
+#endif // FRAME_READBACK_H
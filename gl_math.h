@@ -0,0 +1,164 @@
+#ifndef GL_MATH_H
+#define GL_MATH_H
+
+#include <cmath>
+
+// Minimal column-major 4x4 matrices in the layout OpenGL expects, so they
+// can go straight to glLoadMatrixf or a mat4 uniform. Replaces GLU and the
+// fixed-function matrix builders.
+struct Vec3
+{
+    float x, y, z;
+};
+
+struct Mat4
+{
+    float m[16]; // Column-major: m[column * 4 + row]
+
+    constexpr float operator()(int row, int column) const { return m[column * 4 + row]; }
+    float &operator()(int row, int column) { return m[column * 4 + row]; }
+    const float *data() const { return m; }
+};
+
+constexpr Mat4 identityMatrix()
+{
+    return Mat4{{1.0f, 0.0f, 0.0f, 0.0f,
+                 0.0f, 1.0f, 0.0f, 0.0f,
+                 0.0f, 0.0f, 1.0f, 0.0f,
+                 0.0f, 0.0f, 0.0f, 1.0f}};
+}
+
+constexpr Mat4 operator*(const Mat4 &a, const Mat4 &b)
+{
+    // Loop order lets the compiler vectorize the columns
+    Mat4 result{};
+    for (int column = 0; column < 4; column++)
+    {
+        for (int k = 0; k < 4; k++)
+        {
+            for (int row = 0; row < 4; row++)
+            {
+                result.m[column * 4 + row] += a.m[k * 4 + row] * b.m[column * 4 + k];
+            }
+        }
+    }
+    return result;
+}
+
+// Same as glOrtho
+constexpr Mat4 orthoMatrix(float left, float right, float bottom, float top, float nearZ, float farZ)
+{
+    return Mat4{{2.0f / (right - left), 0.0f, 0.0f, 0.0f,
+                 0.0f, 2.0f / (top - bottom), 0.0f, 0.0f,
+                 0.0f, 0.0f, -2.0f / (farZ - nearZ), 0.0f,
+                 -(right + left) / (right - left), -(top + bottom) / (top - bottom), -(farZ + nearZ) / (farZ - nearZ), 1.0f}};
+}
+
+constexpr Mat4 translationMatrix(float x, float y, float z)
+{
+    return Mat4{{1.0f, 0.0f, 0.0f, 0.0f,
+                 0.0f, 1.0f, 0.0f, 0.0f,
+                 0.0f, 0.0f, 1.0f, 0.0f,
+                 x, y, z, 1.0f}};
+}
+
+constexpr Mat4 scaleMatrix(float x, float y, float z)
+{
+    return Mat4{{x, 0.0f, 0.0f, 0.0f,
+                 0.0f, y, 0.0f, 0.0f,
+                 0.0f, 0.0f, z, 0.0f,
+                 0.0f, 0.0f, 0.0f, 1.0f}};
+}
+
+// Same as gluPerspective; fovY in degrees
+inline Mat4 perspectiveMatrix(float fovY, float aspect, float nearZ, float farZ)
+{
+    float f = 1.0f / std::tan(fovY * static_cast<float>(M_PI) / 360.0f);
+    return Mat4{{f / aspect, 0.0f, 0.0f, 0.0f,
+                 0.0f, f, 0.0f, 0.0f,
+                 0.0f, 0.0f, (farZ + nearZ) / (nearZ - farZ), -1.0f,
+                 0.0f, 0.0f, 2.0f * farZ * nearZ / (nearZ - farZ), 0.0f}};
+}
+
+// Same as gluLookAt
+inline Mat4 lookAtMatrix(Vec3 eye, Vec3 center, Vec3 up)
+{
+    Vec3 f = {center.x - eye.x, center.y - eye.y, center.z - eye.z};
+    float length = std::sqrt(f.x * f.x + f.y * f.y + f.z * f.z);
+    f = {f.x / length, f.y / length, f.z / length};
+
+    // s = f x up, normalized; u = s x f
+    Vec3 s = {f.y * up.z - f.z * up.y, f.z * up.x - f.x * up.z, f.x * up.y - f.y * up.x};
+    length = std::sqrt(s.x * s.x + s.y * s.y + s.z * s.z);
+    s = {s.x / length, s.y / length, s.z / length};
+    Vec3 u = {s.y * f.z - s.z * f.y, s.z * f.x - s.x * f.z, s.x * f.y - s.y * f.x};
+
+    Mat4 rotation = {{s.x, u.x, -f.x, 0.0f,
+                      s.y, u.y, -f.y, 0.0f,
+                      s.z, u.z, -f.z, 0.0f,
+                      0.0f, 0.0f, 0.0f, 1.0f}};
+    return rotation * translationMatrix(-eye.x, -eye.y, -eye.z);
+}
+
+// Same as glRotatef; angle in degrees around the given axis
+inline Mat4 rotationMatrix(float angle, float x, float y, float z)
+{
+    float length = std::sqrt(x * x + y * y + z * z);
+    x /= length;
+    y /= length;
+    z /= length;
+
+    float radians = angle * static_cast<float>(M_PI) / 180.0f;
+    float c = std::cos(radians);
+    float s = std::sin(radians);
+    float t = 1.0f - c;
+    return Mat4{{t * x * x + c, t * x * y + s * z, t * x * z - s * y, 0.0f,
+                 t * x * y - s * z, t * y * y + c, t * y * z + s * x, 0.0f,
+                 t * x * z + s * y, t * y * z - s * x, t * z * z + c, 0.0f,
+                 0.0f, 0.0f, 0.0f, 1.0f}};
+}
+
+// The six planes bounding what a projection * view matrix shows, each as
+// (a, b, c, d) with a * x + b * y + c * z + d >= 0 on the visible side
+struct Frustum
+{
+    float planes[6][4];
+};
+
+inline Frustum frustumFromMatrix(const Mat4 &clip)
+{
+    // Each plane is the last row plus or minus one of the others
+    Frustum frustum{};
+    for (int axis = 0; axis < 3; axis++)
+    {
+        for (int side = 0; side < 2; side++)
+        {
+            float sign = side ? -1.0f : 1.0f;
+            float *plane = frustum.planes[axis * 2 + side];
+            for (int column = 0; column < 4; column++)
+            {
+                plane[column] = clip(3, column) + sign * clip(axis, column);
+            }
+        }
+    }
+    return frustum;
+}
+
+// Whether an axis-aligned box may be visible. A box entirely behind any one
+// plane is rejected; a box near a corner of the frustum can pass without
+// being on screen, which only costs drawing it.
+inline bool boxInFrustum(const Frustum &frustum, Vec3 min, Vec3 max)
+{
+    for (const float *plane : frustum.planes)
+    {
+        // The corner furthest along the plane normal
+        float x = plane[0] >= 0.0f ? max.x : min.x;
+        float y = plane[1] >= 0.0f ? max.y : min.y;
+        float z = plane[2] >= 0.0f ? max.z : min.z;
+        if (plane[0] * x + plane[1] * y + plane[2] * z + plane[3] < 0.0f)
+            return false;
+    }
+    return true;
+}
+
+#endif // GL_MATH_H
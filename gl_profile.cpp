@@ -0,0 +1,41 @@
+#include "gl_profile.h"
+#include <algorithm>
+
+static bool coreProfile = false;
+
+// Whether wide lines may be requested; looked up on the first line width
+// once the context exists
+enum class WideLines
+{
+    Unknown,
+    Supported,
+    Unsupported
+};
+static WideLines wideLines = WideLines::Unknown;
+
+void GLProfile::setCore(bool core)
+{
+    coreProfile = core;
+    wideLines = WideLines::Unknown;
+}
+
+bool GLProfile::core()
+{
+    return coreProfile;
+}
+
+void GLProfile::lineWidth(float width)
+{
+    if (wideLines == WideLines::Unknown)
+    {
+        // Context flags only exist from OpenGL 3.0
+        GLint flags = 0;
+        if (coreProfile)
+        {
+            glGetIntegerv(GL_CONTEXT_FLAGS, &flags);
+        }
+        wideLines = (flags & GL_CONTEXT_FLAG_FORWARD_COMPATIBLE_BIT) ? WideLines::Unsupported : WideLines::Supported;
+    }
+
+    glLineWidth(wideLines == WideLines::Supported ? width : std::min(width, 1.0f));
+}
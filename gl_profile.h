@@ -0,0 +1,22 @@
+#ifndef GL_PROFILE_H
+#define GL_PROFILE_H
+
+#include <GL/glew.h>
+
+// Which OpenGL profile the context was created with. The default 2.1
+// compatibility profile runs every visualizer; with --core-profile the
+// context is 3.3 core, which only the visualizers drawn entirely through
+// shaders, vertex arrays and uniform buffers support.
+class GLProfile
+{
+public:
+    // Set before the context is created
+    static void setCore(bool core);
+    static bool core();
+
+    // glLineWidth, except that forward-compatible core contexts, the only
+    // kind macOS creates, reject widths above 1
+    static void lineWidth(float width);
+};
+
+#endif // GL_PROFILE_H
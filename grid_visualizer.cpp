@@ -5,15 +5,47 @@
 #include <iostream>
 #include <GLFW/glfw3.h>
 
+static const char *CELL_VERTEX_SHADER = R"(#version 120
+CAMERA_UNIFORMS
+uniform vec2 origin;
+uniform vec2 cellSize;
+attribute vec2 corner; // In cells
+attribute float value;
+varying float brightness;
+
+void main()
+{
+    // Increase brightness by 1.25x while ensuring we don't exceed 1.0
+    brightness = min(1.0, value * 1.25);
+    gl_Position = viewProjection * vec4(origin + corner * cellSize, 0.0, 1.0);
+}
+)";
+
+static const char *CELL_FRAGMENT_SHADER = R"(#version 120
+varying float brightness;
+
+void main()
+{
+    gl_FragColor = vec4(vec3(brightness), 1.0);
+}
+)";
+
+// Value of the grid lines, dark gray after the shader's brightening
+static const float GRID_LINE_VALUE = 0.3f / 1.25f;
+
+GridVisualizer::~GridVisualizer() {
+    for (GLuint buffer : {cornerVbo, valueVbo, indexBuffer, lineVbo}) {
+        if (buffer) {
+            glDeleteBuffers(1, &buffer);
+        }
+    }
+}
+
 void GridVisualizer::initialize(int width, int height) {
     screenWidth = width;
     screenHeight = height;
 }
 
-void GridVisualizer::setAudioSources(const std::vector<std::vector<float>>& sources) {
-    audioSources = sources;
-}
-
 void GridVisualizer::calculateGridDimensions(int numSources, int& rows, int& cols) {
     if (numSources <= 1) {
         rows = 1;
@@ -37,19 +69,7 @@ void GridVisualizer::calculateGridDimensions(int numSources, int& rows, int& col
     }
 }
 
-void GridVisualizer::processAudioForFFT(const std::vector<float>& audioData, size_t position, double* fftInputBuffer) {
-    // Apply Hanning window and copy data
-    for (int i = 0; i < N; i++) {
-        size_t index = (position + i) % audioData.size();
-        double multiplier = 0.5 * (1 - cos(2 * M_PI * i / (N - 1)));
-        fftInputBuffer[i] = audioData[index] * multiplier;
-    }
-}
-
-void GridVisualizer::renderFrequencyGrid(const std::vector<float>& magnitudes, float x1, float y1, float x2, float y2) {
-    float cellWidth = (x2 - x1) / GRID_SIZE;
-    float cellHeight = (y2 - y1) / GRID_SIZE;
-    
+void GridVisualizer::renderFrequencyGrid(const std::vector<float>& magnitudes, int fftSize, float x1, float y1, float x2, float y2) {
     // Calculate frequency bands
     std::vector<float> gridValues(GRID_SIZE * GRID_SIZE, 0.0f);
     float logMinFreq = log10(MIN_FREQ);
@@ -57,8 +77,8 @@ void GridVisualizer::renderFrequencyGrid(const std::vector<float>& magnitudes, f
     float logRange = logMaxFreq - logMinFreq;
     
     // Map FFT bins to grid cells with increased responsiveness
-    for (int i = 1; i < N/2; i++) {
-        float freq = i * SAMPLE_RATE / (float)N;
+    for (int i = 1; i < fftSize/2; i++) {
+        float freq = i * SAMPLE_RATE / (float)fftSize;
         if (freq < MIN_FREQ || freq > MAX_FREQ) continue;
         
         float logFreq = log10(freq);
@@ -99,105 +119,125 @@ void GridVisualizer::renderFrequencyGrid(const std::vector<float>& magnitudes, f
         }
     }
     
-    // Render grid cells with increased brightness
-    glBegin(GL_QUADS);
+    drawCells(smoothedValues, x1, y1, x2, y2);
+}
+
+void GridVisualizer::createBuffers() {
+    // The same quads serve every source; only their values change
+    std::vector<float> corners;
+    std::vector<GLushort> indices;
+    corners.reserve(GRID_SIZE * GRID_SIZE * 8);
+    indices.reserve(GRID_SIZE * GRID_SIZE * 6);
     for (int y = 0; y < GRID_SIZE; y++) {
         for (int x = 0; x < GRID_SIZE; x++) {
-            float value = smoothedValues[y * GRID_SIZE + x];
-            
-            // Increase brightness by 1.25x while ensuring we don't exceed 1.0
-            float brightness = std::min(1.0f, value * 1.25f);
-            glColor3f(brightness, brightness, brightness);
-            
-            float cellX = x1 + x * cellWidth;
-            float cellY = y1 + y * cellHeight;
-            
-            glVertex2f(cellX, cellY);
-            glVertex2f(cellX + cellWidth, cellY);
-            glVertex2f(cellX + cellWidth, cellY + cellHeight);
-            glVertex2f(cellX, cellY + cellHeight);
+            const GLushort first = static_cast<GLushort>(corners.size() / 2);
+            const float quad[8] = {
+                (float)x, (float)y,
+                (float)x + 1, (float)y,
+                (float)x + 1, (float)y + 1,
+                (float)x, (float)y + 1};
+            corners.insert(corners.end(), quad, quad + 8);
+            indices.insert(indices.end(), {first, (GLushort)(first + 1), (GLushort)(first + 2),
+                                           first, (GLushort)(first + 2), (GLushort)(first + 3)});
         }
     }
-    glEnd();
     
-    // Draw grid lines
-    glColor3f(0.3f, 0.3f, 0.3f);  // Dark gray grid lines
-    glBegin(GL_LINES);
+    // Vertical then horizontal line across the grid at each cell boundary
+    std::vector<float> lineEnds;
     for (int i = 0; i <= GRID_SIZE; i++) {
-        float x = x1 + i * cellWidth;
-        float y = y1 + i * cellHeight;
-        
-        // Vertical lines
-        glVertex2f(x, y1);
-        glVertex2f(x, y2);
-        
-        // Horizontal lines
-        glVertex2f(x1, y);
-        glVertex2f(x2, y);
+        lineEnds.insert(lineEnds.end(), {(float)i, 0.0f, (float)i, (float)GRID_SIZE,
+                                         0.0f, (float)i, (float)GRID_SIZE, (float)i});
     }
-    glEnd();
+    
+    glGenBuffers(1, &cornerVbo);
+    glBindBuffer(GL_ARRAY_BUFFER, cornerVbo);
+    glBufferData(GL_ARRAY_BUFFER, corners.size() * sizeof(float), corners.data(), GL_STATIC_DRAW);
+    glGenBuffers(1, &lineVbo);
+    glBindBuffer(GL_ARRAY_BUFFER, lineVbo);
+    glBufferData(GL_ARRAY_BUFFER, lineEnds.size() * sizeof(float), lineEnds.data(), GL_STATIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glGenBuffers(1, &valueVbo);
+    glGenBuffers(1, &indexBuffer);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(GLushort), indices.data(), GL_STATIC_DRAW);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    
+    cells.attribute(0, cornerVbo, 2);
+    cells.attribute(1, valueVbo, 1);
+    cells.elements(indexBuffer);
+    lines.attribute(0, lineVbo, 2);
 }
 
-// Multi-source methods
-void GridVisualizer::renderFrame(const std::vector<std::vector<float>>& audioSources,
-                               double* in,
-                               fftw_complex* out,
-                               fftw_plan& plan,
-                               float timeSeconds) {
-    int rows, cols;
-    calculateGridDimensions(audioSources.size(), rows, cols);
+void GridVisualizer::drawCells(const std::vector<float>& values, float x1, float y1, float x2, float y2) {
+    if (!cellShader.build(CELL_VERTEX_SHADER, CELL_FRAGMENT_SHADER, {"corner", "value"})) {
+        return;
+    }
     
-    // Ensure we're using the full window space
-    float gridWidth = 2.0f / cols;
-    float gridHeight = 2.0f / rows;
-    float padding = 0.01f;  // Smaller padding for better space utilization
+    if (!cornerVbo) {
+        createBuffers();
+    }
     
-    for (size_t i = 0; i < audioSources.size(); i++) {
-        // Calculate row and column indices
-        int row = i / cols;
-        int col = i % cols;
-        
-        // Calculate grid position in OpenGL coordinates
-        float x1 = -1.0f + col * gridWidth;
-        float y1 = 1.0f - (row + 1) * gridHeight;
-        float x2 = x1 + gridWidth;
-        float y2 = y1 + gridHeight;
-        
-        // Add padding
-        x1 += padding;
-        y1 += padding;
-        x2 -= padding;
-        y2 -= padding;
-        
-        // Process and render the grid
-        size_t position = static_cast<size_t>(timeSeconds * SAMPLE_RATE) % audioSources[i].size();
-        processAudioForFFT(audioSources[i], position, in);
-        
-        fftw_execute(plan);
-        
-        std::vector<float> magnitudes(N/2);
-        for (int j = 0; j < N/2; j++) {
-            magnitudes[j] = sqrt(out[j][0] * out[j][0] + out[j][1] * out[j][1]) / N;
-        }
-        
-        renderFrequencyGrid(magnitudes, x1, y1, x2, y2);
+    const int cornerCount = GRID_SIZE * GRID_SIZE * 4;
+    cornerValues.resize(cornerCount);
+    for (int cell = 0; cell < GRID_SIZE * GRID_SIZE; cell++) {
+        std::fill_n(cornerValues.begin() + cell * 4, 4, values[cell]);
     }
+    
+    // Orphaned per source so the previous source's draw never stalls this one
+    glBindBuffer(GL_ARRAY_BUFFER, valueVbo);
+    glBufferData(GL_ARRAY_BUFFER, cornerValues.size() * sizeof(float), nullptr, GL_STREAM_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, cornerValues.size() * sizeof(float), cornerValues.data());
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    
+    cellShader.use();
+    camera.apply(cellShader);
+    ShaderProgram::set(cellShader.uniform("origin"), x1, y1);
+    ShaderProgram::set(cellShader.uniform("cellSize"), (x2 - x1) / GRID_SIZE, (y2 - y1) / GRID_SIZE);
+    
+    cells.bind();
+    glDrawElements(GL_TRIANGLES, GRID_SIZE * GRID_SIZE * 6, GL_UNSIGNED_SHORT, nullptr);
+    cells.unbind();
+    
+    // Grid lines over the cells, with the value as a constant attribute
+    glVertexAttrib1f(1, GRID_LINE_VALUE);
+    lines.bind();
+    glDrawArrays(GL_LINES, 0, (GRID_SIZE + 1) * 4);
+    lines.unbind();
+    
+    ShaderProgram::release();
 }
 
-void GridVisualizer::renderLiveFrame(const std::vector<std::vector<float>>& audioSources,
-                                   double* in,
-                                   fftw_complex* out,
-                                   fftw_plan& plan,
+// Multi-source methods
+void GridVisualizer::renderFrame(const AnalysisFrame& analysis,
+                               float timeSeconds) {
+    // Mark unused parameters to silence compiler warnings
+    (void)timeSeconds;
+
+    renderSources(analysis);
+}
+
+void GridVisualizer::renderLiveFrame(const AnalysisFrame& analysis,
                                    size_t currentPosition) {
+    // Mark unused parameters to silence compiler warnings
+    (void)currentPosition;
+
+    renderSources(analysis);
+}
+
+void GridVisualizer::renderSources(const AnalysisFrame& analysis) {
     int rows, cols;
-    calculateGridDimensions(audioSources.size(), rows, cols);
+    calculateGridDimensions(analysis.sources.size(), rows, cols);
     
     // Ensure we're using the full window space
     float gridWidth = 2.0f / cols;
     float gridHeight = 2.0f / rows;
     float padding = 0.01f;  // Smaller padding for better space utilization
     
-    for (size_t i = 0; i < audioSources.size(); i++) {
+    const int fftSize = analysis.fftSize;
+    std::vector<float> magnitudes(fftSize/2);
+    camera.set(orthoMatrix(-1.0f, 1.0f, -1.0f, 1.0f, -1.0f, 1.0f));
+    
+    for (size_t i = 0; i < analysis.sources.size(); i++) {
         // Calculate row and column indices
         int row = i / cols;
         int col = i % cols;
@@ -214,35 +254,12 @@ void GridVisualizer::renderLiveFrame(const std::vector<std::vector<float>>& audi
         x2 -= padding;
         y2 -= padding;
         
-        // Process and render the grid
-        processAudioForFFT(audioSources[i], currentPosition, in);
-        
-        fftw_execute(plan);
-        
-        std::vector<float> magnitudes(N/2);
-        for (int j = 0; j < N/2; j++) {
-            magnitudes[j] = sqrt(out[j][0] * out[j][0] + out[j][1] * out[j][1]) / N;
+        // Normalize the shared spectrum by the FFT size and render the grid
+        const SourceSpectrum& spectrum = analysis.sources[i];
+        for (int j = 0; j < fftSize/2; j++) {
+            magnitudes[j] = spectrum.magnitudes[j] / fftSize;
         }
         
-        renderFrequencyGrid(magnitudes, x1, y1, x2, y2);
+        renderFrequencyGrid(magnitudes, fftSize, x1, y1, x2, y2);
     }
-}
-
-// Legacy single-source methods
-void GridVisualizer::renderFrame(const std::vector<float>& audioData,
-                               double* in,
-                               fftw_complex* out,
-                               fftw_plan& plan,
-                               float timeSeconds) {
-    std::vector<std::vector<float>> sources = {audioData};
-    renderFrame(sources, in, out, plan, timeSeconds);
-}
-
-void GridVisualizer::renderLiveFrame(const std::vector<float>& audioData,
-                                   double* in,
-                                   fftw_complex* out,
-                                   fftw_plan& plan,
-                                   size_t currentPosition) {
-    std::vector<std::vector<float>> sources = {audioData};
-    renderLiveFrame(sources, in, out, plan, currentPosition);
-} 
\ No newline at end of file
+}
\ No newline at end of file
@@ -1,6 +1,9 @@
 #pragma once
 
 #include "visualizer_base.h"
+#include "shader_program.h"
+#include "uniform_buffer.h"
+#include "vertex_array.h"
 #include <vector>
 #include <fftw3.h>
 
@@ -8,46 +11,40 @@ class GridVisualizer : public Visualizer
 {
 public:
     GridVisualizer() = default;
-    virtual ~GridVisualizer() = default;
+    virtual ~GridVisualizer();
 
     void initialize(int width, int height) override;
+
+    bool supportsCoreProfile() const override { return true; }
     
     // Multi-source methods
-    void renderFrame(const std::vector<std::vector<float>>& audioSources,
-                    double* in,
-                    fftw_complex* out,
-                    fftw_plan& plan,
+    void renderFrame(const AnalysisFrame& analysis,
                     float timeSeconds) override;
                     
-    void renderLiveFrame(const std::vector<std::vector<float>>& audioSources,
-                        double* in,
-                        fftw_complex* out,
-                        fftw_plan& plan,
+    void renderLiveFrame(const AnalysisFrame& analysis,
                         size_t currentPosition) override;
-    
-    // Legacy single-source methods
-    void renderFrame(const std::vector<float>& audioData,
-                    double* in,
-                    fftw_complex* out,
-                    fftw_plan& plan,
-                    float timeSeconds) override;
-                    
-    void renderLiveFrame(const std::vector<float>& audioData,
-                        double* in,
-                        fftw_complex* out,
-                        fftw_plan& plan,
-                        size_t currentPosition) override;
-    
-    void setAudioSources(const std::vector<std::vector<float>>& sources);
 
 private:
     void calculateGridDimensions(int numSources, int& rows, int& cols);
-    void processAudioForFFT(const std::vector<float>& audioData, size_t position, double* fftInputBuffer);
-    void renderFrequencyGrid(const std::vector<float>& magnitudes, float x1, float y1, float x2, float y2);
-    std::vector<std::vector<float>> audioSources;
+    void renderSources(const AnalysisFrame& analysis);
+    void renderFrequencyGrid(const std::vector<float>& magnitudes, int fftSize, float x1, float y1, float x2, float y2);
+    void createBuffers();
+    void drawCells(const std::vector<float>& values, float x1, float y1, float x2, float y2);
     static const int GRID_SIZE = 32;
-    static const int N = 2048;
     static constexpr float MIN_FREQ = 20.0f;
     static constexpr float MAX_FREQ = 20000.0f;
     static constexpr int SAMPLE_RATE = 44100;
+
+    // Cells are drawn by a shader that places them from their grid corners
+    // and turns each cell's value into its brightness; the grid lines go
+    // through the same shader at one constant value
+    ShaderProgram cellShader;
+    CameraUniforms camera;
+    GLuint cornerVbo = 0;  // Grid-unit corners of every cell, built once
+    GLuint valueVbo = 0;   // Each cell's value repeated on its four corners
+    GLuint indexBuffer = 0; // Two triangles per cell
+    GLuint lineVbo = 0;    // Grid-unit ends of the grid lines
+    VertexArray cells;
+    VertexArray lines;
+    std::vector<float> cornerValues;
 }; 
\ No newline at end of file
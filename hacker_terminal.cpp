@@ -209,7 +209,7 @@ void HackerTerminal::generateCodeLine()
 void HackerTerminal::generateSystemMessage()
 {
     std::uniform_int_distribution<> dis(0, systemMessages.size() - 1);
-    std::string message = "[" + getCurrentTime() + "] " + systemMessages[dis(rng)];
+    std::string message = "[" + frameTime + "] " + systemMessages[dis(rng)];
 
     TerminalLine termLine;
     termLine.text = message;
@@ -274,7 +274,16 @@ void HackerTerminal::renderTerminalContent()
 {
     float lineHeight = 0.04f;
     float startY = 0.8f;
-    float charWidth = 0.012f;
+    float charWidth = 0.014f;
+    float charHeight = 0.026f;
+
+    // Noise pixels go on top of the characters once all lines are queued
+    struct NoisePixel
+    {
+        float x, y;
+        const float *color;
+    };
+    std::vector<NoisePixel> noise;
 
     int lineIndex = 0;
     for (const auto &line : terminalLines)
@@ -284,7 +293,6 @@ void HackerTerminal::renderTerminalContent()
         if (y < -1.0f || y > 1.0f)
             continue;
 
-        // Render each character as a small rectangle to simulate text
         float x = -0.95f;
         for (size_t i = 0; i < line.text.length() && x < 0.95f; i++)
         {
@@ -304,26 +312,15 @@ void HackerTerminal::renderTerminalContent()
             if (c == '{' || c == '}' || c == '(' || c == ')')
                 intensity *= 1.1f; // Brackets brighter
 
-            glColor3f(line.color[0] * intensity,
-                      line.color[1] * intensity,
-                      line.color[2] * intensity);
-
-            // Draw character as small filled rectangle
-            float charHeight = lineHeight * 0.6f;
-            glBegin(GL_QUADS);
-            glVertex2f(x, y - charHeight * 0.5f);
-            glVertex2f(x + charWidth * 0.8f, y - charHeight * 0.5f);
-            glVertex2f(x + charWidth * 0.8f, y + charHeight * 0.5f);
-            glVertex2f(x, y + charHeight * 0.5f);
-            glEnd();
+            text.color(line.color[0] * intensity,
+                       line.color[1] * intensity,
+                       line.color[2] * intensity);
+            text.glyph(c, x, y, charWidth, charHeight);
 
             // Add some random "pixel noise" for authentic terminal look
             if (audioAmplitude > 0.5f && (i + lineIndex) % 7 == 0)
             {
-                glColor3f(line.color[0] * 0.3f, line.color[1] * 0.3f, line.color[2] * 0.3f);
-                glBegin(GL_POINTS);
-                glVertex2f(x + charWidth * 0.4f, y + charHeight * 0.2f);
-                glEnd();
+                noise.push_back({x + charWidth * 0.4f, y + charHeight * 0.2f, line.color});
             }
 
             x += charWidth;
@@ -331,164 +328,81 @@ void HackerTerminal::renderTerminalContent()
 
         lineIndex++;
     }
+
+    batch.begin(GL_POINTS);
+    for (const NoisePixel &pixel : noise)
+    {
+        batch.color(pixel.color[0] * 0.3f, pixel.color[1] * 0.3f, pixel.color[2] * 0.3f);
+        batch.vertex(pixel.x, pixel.y);
+    }
+    batch.end();
+
+    text.flush();
+    batch.flush();
 }
 
 void HackerTerminal::renderHeader()
 {
     // Top status bar with cyberpunk styling
-    glColor3f(HEADER_COLOR[0], HEADER_COLOR[1], HEADER_COLOR[2]);
-
-    // Header background
-    glBegin(GL_QUADS);
-    glVertex2f(-1.0f, 0.92f);
-    glVertex2f(1.0f, 0.92f);
-    glVertex2f(1.0f, 1.0f);
-    glVertex2f(-1.0f, 1.0f);
-    glEnd();
+    batch.color(HEADER_COLOR[0], HEADER_COLOR[1], HEADER_COLOR[2]);
+    batch.rect(-1.0f, 0.92f, 1.0f, 1.0f);
 
-    // Header text simulation (CODER: SURVIVOR-03, timestamp, STATUS: SECURING)
+    // Header text in black on the bar (CODER: SURVIVOR-03, timestamp, STATUS: SECURING)
     float headerY = 0.96f;
     float charWidth = 0.015f;
+    float charHeight = 0.03f;
 
-    // Left side: "CODER: SURVIVOR-03"
-    std::string leftText = "CODER: SURVIVOR-03";
-    float x = -0.95f;
-    for (char c : leftText)
-    {
-        if (c != ' ')
-        {
-            glBegin(GL_QUADS);
-            glVertex2f(x, headerY - 0.015f);
-            glVertex2f(x + charWidth * 0.7f, headerY - 0.015f);
-            glVertex2f(x + charWidth * 0.7f, headerY + 0.015f);
-            glVertex2f(x, headerY + 0.015f);
-            glEnd();
-        }
-        x += charWidth;
-    }
-
-    // Center: timestamp
-    std::string timeText = getCurrentTime() + " | 28-05-2025";
-    x = -0.15f;
-    for (char c : timeText)
-    {
-        if (c != ' ')
-        {
-            glBegin(GL_QUADS);
-            glVertex2f(x, headerY - 0.015f);
-            glVertex2f(x + charWidth * 0.7f, headerY - 0.015f);
-            glVertex2f(x + charWidth * 0.7f, headerY + 0.015f);
-            glVertex2f(x, headerY + 0.015f);
-            glEnd();
-        }
-        x += charWidth;
-    }
+    text.color(0.0f, 0.0f, 0.0f);
+    text.text("CODER: SURVIVOR-03", -0.95f, headerY, charWidth, charHeight);
+    text.text(frameTime + " | 28-05-2025", -0.15f, headerY, charWidth, charHeight);
 
     // Right side: "STATUS: SECURING"
-    glColor3f(SUCCESS_COLOR[0], SUCCESS_COLOR[1], SUCCESS_COLOR[2]);
-    std::string rightText = "STATUS: SECURING";
-    x = 0.5f;
-    for (char c : rightText)
-    {
-        if (c != ' ')
-        {
-            glBegin(GL_QUADS);
-            glVertex2f(x, headerY - 0.015f);
-            glVertex2f(x + charWidth * 0.7f, headerY - 0.015f);
-            glVertex2f(x + charWidth * 0.7f, headerY + 0.015f);
-            glVertex2f(x, headerY + 0.015f);
-            glEnd();
-        }
-        x += charWidth;
-    }
+    text.color(0.0f, 0.35f, 0.15f);
+    text.text("STATUS: SECURING", 0.5f, headerY, charWidth, charHeight);
 
     // Tab indicators
-    glColor3f(HEADER_COLOR[0] * 0.8f, HEADER_COLOR[1] * 0.8f, HEADER_COLOR[2] * 0.8f);
-    std::vector<std::string> tabs = {"countermeasure.js", "survival_protocol.ts", "neural_defense.py"};
+    static const char *const tabs[] = {"countermeasure.js", "survival_protocol.ts", "neural_defense.py"};
     float tabY = 0.87f;
-    x = -0.95f;
+    float tabCharWidth = 0.011f;
+    float x = -0.95f;
 
-    for (const auto &tab : tabs)
+    for (const char *tab : tabs)
     {
+        float tabWidth = std::string(tab).length() * tabCharWidth + 0.02f;
+
         // Tab background
-        glBegin(GL_QUADS);
-        glVertex2f(x, tabY - 0.02f);
-        glVertex2f(x + tab.length() * 0.012f, tabY - 0.02f);
-        glVertex2f(x + tab.length() * 0.012f, tabY + 0.02f);
-        glVertex2f(x, tabY + 0.02f);
-        glEnd();
+        batch.color(HEADER_COLOR[0] * 0.8f, HEADER_COLOR[1] * 0.8f, HEADER_COLOR[2] * 0.8f);
+        batch.rect(x, tabY - 0.02f, x + tabWidth, tabY + 0.02f);
 
         // Tab text
-        float tabX = x + 0.01f;
-        for (char c : tab)
-        {
-            if (c != ' ')
-            {
-                glBegin(GL_QUADS);
-                glVertex2f(tabX, tabY - 0.01f);
-                glVertex2f(tabX + 0.008f, tabY - 0.01f);
-                glVertex2f(tabX + 0.008f, tabY + 0.01f);
-                glVertex2f(tabX, tabY + 0.01f);
-                glEnd();
-            }
-            tabX += 0.01f;
-        }
+        text.text(tab, x + 0.01f, tabY, tabCharWidth, 0.024f);
 
-        x += tab.length() * 0.012f + 0.05f;
+        x += tabWidth + 0.05f;
     }
+
+    batch.flush();
+    text.flush();
 }
 
 void HackerTerminal::renderAlerts()
 {
     // Command console area (right side)
-    glColor3f(0.0f, 0.2f, 0.0f);
-    glBegin(GL_QUADS);
-    glVertex2f(0.25f, 0.85f);
-    glVertex2f(0.98f, 0.85f);
-    glVertex2f(0.98f, -0.4f);
-    glVertex2f(0.25f, -0.4f);
-    glEnd();
+    batch.color(0.0f, 0.2f, 0.0f);
+    batch.rect(0.25f, -0.4f, 0.98f, 0.85f);
 
     // Console header
-    glColor3f(HEADER_COLOR[0], HEADER_COLOR[1], HEADER_COLOR[2]);
-    std::string consoleHeader = "COMMAND CONSOLE";
-    float x = 0.3f;
     float y = 0.8f;
-    for (char c : consoleHeader)
-    {
-        if (c != ' ')
-        {
-            glBegin(GL_QUADS);
-            glVertex2f(x, y - 0.01f);
-            glVertex2f(x + 0.01f, y - 0.01f);
-            glVertex2f(x + 0.01f, y + 0.01f);
-            glVertex2f(x, y + 0.01f);
-            glEnd();
-        }
-        x += 0.012f;
-    }
+    text.color(HEADER_COLOR);
+    text.text("COMMAND CONSOLE", 0.3f, y, 0.012f, 0.024f);
 
     // Threat level indicator
-    glColor3f(ALERT_COLOR[0], ALERT_COLOR[1], ALERT_COLOR[2]);
-    std::string threatText = "THREAT LEVEL: ELEVATED";
-    x = 0.7f;
-    for (char c : threatText)
-    {
-        if (c != ' ')
-        {
-            glBegin(GL_QUADS);
-            glVertex2f(x, y - 0.01f);
-            glVertex2f(x + 0.008f, y - 0.01f);
-            glVertex2f(x + 0.008f, y + 0.01f);
-            glVertex2f(x, y + 0.01f);
-            glEnd();
-        }
-        x += 0.01f;
-    }
+    text.color(ALERT_COLOR);
+    text.text("THREAT LEVEL: ELEVATED", 0.7f, y, 0.0115f, 0.022f, 0.98f);
 
-    // Alert messages
+    // Alert messages, all stamped with this frame's time
     float alertY = 0.7f;
     int alertIndex = 0;
+    std::string timestamp = "[" + frameTime + "]";
 
     for (const auto &alert : alerts)
     {
@@ -496,98 +410,36 @@ void HackerTerminal::renderAlerts()
         if (y < -0.3f)
             break;
 
-        // Timestamp
-        std::string timestamp = "[" + getCurrentTime() + "]";
-        float x = 0.3f;
-
-        glColor3f(DIM_TEXT_COLOR[0], DIM_TEXT_COLOR[1], DIM_TEXT_COLOR[2]);
-        for (char c : timestamp)
-        {
-            if (c != ' ')
-            {
-                glBegin(GL_QUADS);
-                glVertex2f(x, y - 0.008f);
-                glVertex2f(x + 0.008f, y - 0.008f);
-                glVertex2f(x + 0.008f, y + 0.008f);
-                glVertex2f(x, y + 0.008f);
-                glEnd();
-            }
-            x += 0.009f;
-        }
+        text.color(DIM_TEXT_COLOR);
+        float x = text.text(timestamp, 0.3f, y, 0.011f, 0.022f);
 
         // Alert message
         x += 0.02f;
         float intensity = alert.isUrgent ? (0.5f + 0.5f * std::sin(alertTimer * 8.0f)) : 1.0f;
-        glColor3f(alert.color[0] * intensity, alert.color[1] * intensity, alert.color[2] * intensity);
-
-        for (size_t i = 0; i < alert.message.length() && x < 0.95f; i++)
-        {
-            char c = alert.message[i];
-            if (c != ' ')
-            {
-                glBegin(GL_QUADS);
-                glVertex2f(x, y - 0.008f);
-                glVertex2f(x + 0.008f, y - 0.008f);
-                glVertex2f(x + 0.008f, y + 0.008f);
-                glVertex2f(x, y + 0.008f);
-                glEnd();
-            }
-            x += 0.009f;
-        }
+        text.color(alert.color[0] * intensity, alert.color[1] * intensity, alert.color[2] * intensity);
+        text.text(alert.message, x, y, 0.011f, 0.022f, 0.95f);
 
         alertIndex++;
     }
+
+    batch.flush();
+    text.flush();
 }
 
 void HackerTerminal::renderStatusBars()
 {
     // System monitor area (bottom right)
-    glColor3f(0.0f, 0.15f, 0.0f);
-    glBegin(GL_QUADS);
-    glVertex2f(0.25f, -0.45f);
-    glVertex2f(0.98f, -0.45f);
-    glVertex2f(0.98f, -0.98f);
-    glVertex2f(0.25f, -0.98f);
-    glEnd();
-
-    // System monitor header
-    glColor3f(HEADER_COLOR[0], HEADER_COLOR[1], HEADER_COLOR[2]);
-    std::string sysHeader = "SYSTEM MONITOR";
-    float x = 0.3f;
-    float y = -0.5f;
-    for (char c : sysHeader)
-    {
-        if (c != ' ')
-        {
-            glBegin(GL_QUADS);
-            glVertex2f(x, y - 0.01f);
-            glVertex2f(x + 0.01f, y - 0.01f);
-            glVertex2f(x + 0.01f, y + 0.01f);
-            glVertex2f(x, y + 0.01f);
-            glEnd();
-        }
-        x += 0.012f;
-    }
+    batch.color(0.0f, 0.15f, 0.0f);
+    batch.rect(0.25f, -0.98f, 0.98f, -0.45f);
 
-    // CPU percentage
-    std::string cpuText = "CPU: 70%";
-    x = 0.85f;
-    for (char c : cpuText)
-    {
-        if (c != ' ')
-        {
-            glBegin(GL_QUADS);
-            glVertex2f(x, y - 0.01f);
-            glVertex2f(x + 0.008f, y - 0.01f);
-            glVertex2f(x + 0.008f, y + 0.01f);
-            glVertex2f(x, y + 0.01f);
-            glEnd();
-        }
-        x += 0.01f;
-    }
+    // System monitor header and CPU percentage
+    float y = -0.5f;
+    text.color(HEADER_COLOR);
+    text.text("SYSTEM MONITOR", 0.3f, y, 0.012f, 0.024f);
+    text.text("CPU: 70%", 0.85f, y, 0.011f, 0.022f);
 
     // Status bars with labels
-    std::vector<std::string> labels = {"QUANTUM-ENCRYPTED", "DEFENSE", "CPU", "THREAT"};
+    static const char *const labels[] = {"QUANTUM-ENCRYPTED", "DEFENSE", "CPU", "THREAT"};
     float barY = -0.6f;
 
     for (size_t i = 0; i < statusBars.size(); i++)
@@ -595,122 +447,52 @@ void HackerTerminal::renderStatusBars()
         float y = barY - i * 0.08f;
 
         // Label
-        glColor3f(DIM_TEXT_COLOR[0], DIM_TEXT_COLOR[1], DIM_TEXT_COLOR[2]);
-        x = 0.3f;
-        for (char c : labels[i])
-        {
-            if (c != ' ')
-            {
-                glBegin(GL_QUADS);
-                glVertex2f(x, y - 0.008f);
-                glVertex2f(x + 0.007f, y - 0.008f);
-                glVertex2f(x + 0.007f, y + 0.008f);
-                glVertex2f(x, y + 0.008f);
-                glEnd();
-            }
-            x += 0.008f;
-        }
+        text.color(DIM_TEXT_COLOR);
+        text.text(labels[i], 0.3f, y, 0.011f, 0.022f);
 
         // Progress bar background
         float barX = 0.65f;
         float barWidth = 0.25f;
         float barHeight = 0.02f;
 
-        glColor3f(0.1f, 0.1f, 0.1f);
-        glBegin(GL_QUADS);
-        glVertex2f(barX, y - barHeight);
-        glVertex2f(barX + barWidth, y - barHeight);
-        glVertex2f(barX + barWidth, y + barHeight);
-        glVertex2f(barX, y + barHeight);
-        glEnd();
+        batch.color(0.1f, 0.1f, 0.1f);
+        batch.rect(barX, y - barHeight, barX + barWidth, y + barHeight);
 
-        // Progress bar fill
+        // Progress bar fill, pulsing with the audio
         float fillWidth = barWidth * (statusBars[i].value / statusBars[i].maxValue);
-        glColor3fv(statusBars[i].color);
-
-        // Add pulsing effect based on audio
         float pulse = 1.0f + audioAmplitude * 0.3f * std::sin(alertTimer * 5.0f);
-        glColor3f(statusBars[i].color[0] * pulse,
-                  statusBars[i].color[1] * pulse,
-                  statusBars[i].color[2] * pulse);
-
-        glBegin(GL_QUADS);
-        glVertex2f(barX, y - barHeight);
-        glVertex2f(barX + fillWidth, y - barHeight);
-        glVertex2f(barX + fillWidth, y + barHeight);
-        glVertex2f(barX, y + barHeight);
-        glEnd();
+        batch.color(statusBars[i].color[0] * pulse,
+                    statusBars[i].color[1] * pulse,
+                    statusBars[i].color[2] * pulse);
+        batch.rect(barX, y - barHeight, barX + fillWidth, y + barHeight);
 
         // Percentage text
         std::string percentText = std::to_string(static_cast<int>(statusBars[i].value)) + "%";
-        x = barX + barWidth + 0.02f;
-        glColor3f(statusBars[i].color[0], statusBars[i].color[1], statusBars[i].color[2]);
-        for (char c : percentText)
-        {
-            if (c != ' ')
-            {
-                glBegin(GL_QUADS);
-                glVertex2f(x, y - 0.008f);
-                glVertex2f(x + 0.007f, y - 0.008f);
-                glVertex2f(x + 0.007f, y + 0.008f);
-                glVertex2f(x, y + 0.008f);
-                glEnd();
-            }
-            x += 0.008f;
-        }
+        text.color(statusBars[i].color);
+        text.text(percentText, barX + barWidth + 0.01f, y, 0.011f, 0.022f, 0.98f);
     }
+
+    batch.flush();
+    text.flush();
 }
 
-void HackerTerminal::renderScanlines()
+CRTSettings HackerTerminal::crtSettings() const
 {
-    // Matrix-style digital rain effect
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-
-    // Subtle scanlines
-    glColor4f(0.0f, 1.0f, 0.0f, 0.05f);
-    glBegin(GL_LINES);
-    for (float y = -1.0f; y <= 1.0f; y += 0.004f)
-    {
-        glVertex2f(-1.0f, y);
-        glVertex2f(1.0f, y);
-    }
-    glEnd();
-
-    // Random "digital noise" pixels
-    if (audioAmplitude > 0.3f)
-    {
-        glColor4f(0.0f, 1.0f, 0.0f, 0.3f);
-        glBegin(GL_POINTS);
-        for (int i = 0; i < static_cast<int>(audioAmplitude * 50); i++)
-        {
-            float x = -1.0f + (rand() % 1000) / 500.0f;
-            float y = -1.0f + (rand() % 1000) / 500.0f;
-            glVertex2f(x, y);
-        }
-        glEnd();
-    }
-
-    glDisable(GL_BLEND);
+    // Uses the previous frame's amplitude, as settings are read before the
+    // frame is rendered. The flicker picks up once the audio gets loud.
+    CRTSettings settings;
+    settings.scanlines = 0.35f;
+    settings.bloom = 0.5f;
+    settings.persistence = 0.4f;
+    settings.noise = audioAmplitude > 0.3f ? 0.12f * audioAmplitude : 0.03f;
+    return settings;
 }
 
-float HackerTerminal::calculateAudioAmplitude(const std::vector<float> &audioData, size_t position)
+float HackerTerminal::calculateAudioAmplitude(const SourceSpectrum &spectrum)
 {
-    const size_t windowSize = 1024;
-    size_t end = std::min(position + windowSize, audioData.size());
-
-    float sum = 0.0f;
-    for (size_t i = position; i < end; i++)
-    {
-        sum += std::fabs(audioData[i]);
-    }
-
-    float average = 0.0f;
-    size_t count = end - position;
-    if (count > 0)
-        average = sum / static_cast<float>(count);
-
-    return std::min(1.0f, average * 8.0f); // Amplify for dramatic effect
+    // The analysis level is the mean absolute sample over the block
+    // Amplify for dramatic effect
+    return std::min(1.0f, spectrum.level * 8.0f);
 }
 
 std::string HackerTerminal::generateRandomHex(int length)
@@ -741,14 +523,12 @@ std::string HackerTerminal::generateRandomHash()
            generateRandomHex(4) + "-" + generateRandomHex(12);
 }
 
-void HackerTerminal::renderFrame(const std::vector<float> &audioData,
-                                 double * /* fftInputBuffer */,
-                                 fftw_complex * /* fftOutputBuffer */,
-                                 fftw_plan & /* fftPlan */,
+void HackerTerminal::renderFrame(const AnalysisFrame &analysis,
                                  float timeSeconds)
 {
-    size_t sampleIndex = static_cast<size_t>(timeSeconds * 44100);
-    audioAmplitude = calculateAudioAmplitude(audioData, sampleIndex);
+    (void)timeSeconds; // Animation is frame-driven
+    frameTime = getCurrentTime();
+    audioAmplitude = calculateAudioAmplitude(analysis.primary());
 
     glClear(GL_COLOR_BUFFER_BIT);
 
@@ -765,16 +545,14 @@ void HackerTerminal::renderFrame(const std::vector<float> &audioData,
     renderTerminalContent();
     renderAlerts();
     renderStatusBars();
-    renderScanlines();
 }
 
-void HackerTerminal::renderLiveFrame(const std::vector<float> &audioData,
-                                     double * /* fftInputBuffer */,
-                                     fftw_complex * /* fftOutputBuffer */,
-                                     fftw_plan & /* fftPlan */,
+void HackerTerminal::renderLiveFrame(const AnalysisFrame &analysis,
                                      size_t currentPosition)
 {
-    audioAmplitude = calculateAudioAmplitude(audioData, currentPosition);
+    (void)currentPosition; // Animation is frame-driven
+    frameTime = getCurrentTime();
+    audioAmplitude = calculateAudioAmplitude(analysis.primary());
 
     glClear(GL_COLOR_BUFFER_BIT);
 
@@ -790,5 +568,4 @@ void HackerTerminal::renderLiveFrame(const std::vector<float> &audioData,
     renderTerminalContent();
     renderAlerts();
     renderStatusBars();
-    renderScanlines();
 }
\ No newline at end of file
@@ -1,5 +1,6 @@
 #pragma once
 #include "visualizer_base.h"
+#include "text_renderer.h"
 #include <vector>
 #include <string>
 #include <deque>
@@ -13,18 +14,15 @@ public:
 
     void initialize(int width, int height) override;
 
-    void renderFrame(const std::vector<float> &audioData,
-                     double *fftInputBuffer,
-                     fftw_complex *fftOutputBuffer,
-                     fftw_plan &fftPlan,
+    void renderFrame(const AnalysisFrame &analysis,
                      float timeSeconds) override;
 
-    void renderLiveFrame(const std::vector<float> &audioData,
-                         double *fftInputBuffer,
-                         fftw_complex *fftOutputBuffer,
-                         fftw_plan &fftPlan,
+    void renderLiveFrame(const AnalysisFrame &analysis,
                          size_t currentPosition) override;
 
+    // Scanlines, glow and flicker come from the shared CRT pass
+    CRTSettings crtSettings() const override;
+
 private:
     static constexpr int MAX_LINES = 50;
     static constexpr int MAX_ALERTS = 20;
@@ -74,6 +72,11 @@ private:
     std::vector<StatusBar> statusBars;
     std::mt19937 rng;
 
+    // Glyph atlas text, and the clock formatted once per frame for every
+    // timestamp on screen
+    TextRenderer text;
+    std::string frameTime;
+
     // Code generation
     std::vector<std::string> codeTemplates;
     std::vector<std::string> hackingTerms;
@@ -90,9 +93,8 @@ private:
     void renderHeader();
     void renderAlerts();
     void renderStatusBars();
-    void renderScanlines();
 
-    float calculateAudioAmplitude(const std::vector<float> &audioData, size_t position);
+    float calculateAudioAmplitude(const SourceSpectrum &spectrum);
     std::string getCurrentTime();
     std::string generateRandomHex(int length);
     std::string generateRandomIP();
@@ -0,0 +1,199 @@
+#include "live_playback.h"
+#include <algorithm>
+#include <chrono>
+
+LivePlayback::LivePlayback(MixEngine &mixer, size_t length, int historySize, int outputChannels)
+    : mixer(mixer), sources(mixer.getSources()), length(length), historySize(static_cast<size_t>(historySize)),
+      outputChannels(static_cast<size_t>(outputChannels)),
+      stride(this->outputChannels + sources.size()),
+      playbackRing(PLAYBACK_RING_FRAMES * stride),
+      analysisRing(ANALYSIS_RING_FRAMES * stride)
+{
+    feedFrames.resize(FEED_BLOCK_FRAMES * stride);
+    callbackFrames.resize(MAX_CALLBACK_FRAMES * stride);
+    drainFrames.resize(analysisRing.capacity());
+
+    // One silent history per source, or a single one with no audio loaded
+    history.assign(std::max<size_t>(1, sources.size()), std::vector<float>(this->historySize, 0.0f));
+    playbackDone = length == 0;
+}
+
+LivePlayback::~LivePlayback()
+{
+    stop();
+}
+
+void LivePlayback::start()
+{
+    // Fill the ring before the stream starts so the first callbacks have data
+    while (feedBlock())
+    {
+    }
+    stopping = false;
+    feedThread = std::thread(&LivePlayback::feedLoop, this);
+}
+
+void LivePlayback::stop()
+{
+    stopping = true;
+    if (feedThread.joinable())
+    {
+        feedThread.join();
+    }
+}
+
+bool LivePlayback::feedBlock()
+{
+    if (feedPosition >= length)
+        return false;
+
+    size_t frames = std::min(FEED_BLOCK_FRAMES, length - feedPosition);
+    if (playbackRing.writeAvailable() < frames * stride)
+        return false;
+
+    // Interleave the mix with the raw samples of each source
+    const MixBlock &block = mixer.mix(feedPosition, frames);
+    for (size_t i = 0; i < frames; i++)
+    {
+        float *frame = &feedFrames[i * stride];
+        if (outputChannels == 1)
+        {
+            frame[0] = block.mono[i];
+        }
+        else
+        {
+            frame[0] = block.left[i];
+            frame[1] = block.right[i];
+        }
+        for (size_t s = 0; s < sources.size(); s++)
+        {
+            frame[outputChannels + s] = block.sources[s][i];
+        }
+    }
+
+    playbackRing.write(feedFrames.data(), frames * stride);
+    feedPosition += frames;
+    return true;
+}
+
+void LivePlayback::feedLoop()
+{
+    while (!stopping && feedPosition < length)
+    {
+        // The callback cannot signal without risking a block, so poll well
+        // inside the ring's lead time instead
+        if (!feedBlock())
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+    }
+}
+
+int LivePlayback::paCallback(const void *inputBuffer, void *outputBuffer,
+                             unsigned long framesPerBuffer,
+                             const PaStreamCallbackTimeInfo *timeInfo,
+                             PaStreamCallbackFlags statusFlags,
+                             void *userData)
+{
+    // Mark unused parameters to silence compiler warnings
+    (void)inputBuffer;
+
+    LivePlayback *playback = static_cast<LivePlayback *>(userData);
+    return playback->process(static_cast<float *>(outputBuffer), framesPerBuffer, timeInfo, statusFlags);
+}
+
+int LivePlayback::process(float *out, unsigned long framesPerBuffer,
+                          const PaStreamCallbackTimeInfo *timeInfo, PaStreamCallbackFlags statusFlags)
+{
+    if (statusFlags & (paOutputUnderflow | paOutputOverflow))
+    {
+        xruns.fetch_add(1, std::memory_order_relaxed);
+    }
+    // Some hosts leave the timestamps at zero
+    if (timeInfo && timeInfo->currentTime > 0.0 &&
+        timeInfo->outputBufferDacTime < timeInfo->currentTime)
+    {
+        lateCallbacks.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    size_t played = playedFrames.load(std::memory_order_relaxed);
+    size_t written = 0;
+    while (written < framesPerBuffer)
+    {
+        size_t wanted = std::min<size_t>(framesPerBuffer - written, MAX_CALLBACK_FRAMES);
+        size_t frames = playbackRing.read(callbackFrames.data(), wanted * stride) / stride;
+
+        for (size_t i = 0; i < frames; i++)
+        {
+            for (size_t ch = 0; ch < outputChannels; ch++)
+            {
+                out[(written + i) * outputChannels + ch] = callbackFrames[i * stride + ch];
+            }
+        }
+
+        // Forward what was played; if the render thread is behind, drop the
+        // block rather than wait for it
+        if (analysisRing.writeAvailable() >= frames * stride)
+        {
+            analysisRing.write(callbackFrames.data(), frames * stride);
+        }
+        else
+        {
+            analysisDrops.fetch_add(frames, std::memory_order_relaxed);
+        }
+
+        written += frames;
+        if (frames < wanted)
+            break;
+    }
+
+    // Pad with silence; running dry before the end means the feeder fell behind
+    std::fill(out + written * outputChannels, out + framesPerBuffer * outputChannels, 0.0f);
+    played += written;
+    if (written < framesPerBuffer && played < length)
+    {
+        underruns.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    playedFrames.store(played, std::memory_order_release);
+    bool done = played >= length;
+    playbackDone.store(done, std::memory_order_release);
+    return done ? paComplete : paContinue;
+}
+
+const std::vector<AudioView> &LivePlayback::analysisWindow(size_t windowSize, size_t &windowStart)
+{
+    // Drain everything played since the last frame; partial frames cannot
+    // occur because the callback always writes whole frames
+    size_t frames = analysisRing.read(drainFrames.data(), analysisRing.readAvailable()) / stride;
+    analyzedFrames += frames;
+
+    // Keep only the newest historySize samples of each source
+    size_t kept = std::min(frames, historySize);
+    size_t skipped = frames - kept;
+    for (size_t s = 0; s < sources.size(); s++)
+    {
+        std::vector<float> &samples = history[s];
+        std::move(samples.begin() + kept, samples.end(), samples.begin());
+        for (size_t i = 0; i < kept; i++)
+        {
+            samples[historySize - kept + i] = drainFrames[(skipped + i) * stride + outputChannels + s];
+        }
+    }
+
+    // Frames dropped by the callback still moved the play head
+    windowSize = std::min(windowSize, historySize);
+    size_t end = analyzedFrames + analysisDrops.load(std::memory_order_relaxed);
+    windowStart = end > windowSize ? end - windowSize : 0;
+
+    // Samples past the end of a shorter source stay silent and do not count
+    // towards its level
+    windowViews.clear();
+    for (size_t s = 0; s < history.size(); s++)
+    {
+        size_t sourceLength = s < sources.size() ? sources[s]->length() : 0;
+        size_t available = windowStart < sourceLength ? std::min(windowSize, sourceLength - windowStart) : 0;
+        windowViews.emplace_back(history[s].data() + historySize - windowSize, available, windowSize);
+    }
+    return windowViews;
+}
@@ -0,0 +1,104 @@
+#ifndef LIVE_PLAYBACK_H
+#define LIVE_PLAYBACK_H
+
+#include "audio_source.h"
+#include "mix_engine.h"
+#include "spsc_ring.h"
+#include <atomic>
+#include <cstdint>
+#include <portaudio.h>
+#include <thread>
+#include <vector>
+
+// Live playback path. A feeder thread mixes the sources ahead of time into
+// a lock-free ring; the PortAudio callback only copies the mix out and
+// forwards the frames it played to the analysis side through a second
+// ring, so it never locks, allocates or waits on disk I/O.
+//
+// Both rings carry interleaved frames of the output channels followed by
+// each source, which lets the render thread analyze exactly what was heard
+// per source.
+class LivePlayback
+{
+public:
+    // The mixer is driven from the feeder thread until stop(). historySize is
+    // the largest analysis window that will be asked for.
+    LivePlayback(MixEngine &mixer, size_t length, int historySize, int outputChannels);
+    ~LivePlayback();
+
+    LivePlayback(const LivePlayback &) = delete;
+    LivePlayback &operator=(const LivePlayback &) = delete;
+
+    // Prefill the playback ring and start the feeder thread; call before
+    // starting the stream
+    void start();
+    void stop();
+
+    // PortAudio callback; pass the LivePlayback instance as userData
+    static int paCallback(const void *inputBuffer, void *outputBuffer,
+                          unsigned long framesPerBuffer,
+                          const PaStreamCallbackTimeInfo *timeInfo,
+                          PaStreamCallbackFlags statusFlags,
+                          void *userData);
+
+    // Render thread only: drain the analysis ring and return the most
+    // recently played windowSize samples of each source (at most historySize).
+    // windowStart is set to the sample position of the first sample in the
+    // window.
+    const std::vector<AudioView> &analysisWindow(size_t windowSize, size_t &windowStart);
+
+    // Samples played so far, and whether the end of the longest source was reached
+    size_t position() const { return playedFrames.load(std::memory_order_acquire); }
+    bool finished() const { return playbackDone.load(std::memory_order_acquire); }
+
+    // Glitch counters, safe to read from any thread
+    uint64_t xrunCount() const { return xruns.load(std::memory_order_relaxed); }
+    uint64_t lateCallbackCount() const { return lateCallbacks.load(std::memory_order_relaxed); }
+    uint64_t underrunCount() const { return underruns.load(std::memory_order_relaxed); }
+    uint64_t analysisDropCount() const { return analysisDrops.load(std::memory_order_relaxed); }
+
+private:
+    int process(float *out, unsigned long framesPerBuffer,
+                const PaStreamCallbackTimeInfo *timeInfo, PaStreamCallbackFlags statusFlags);
+    bool feedBlock(); // Mix one block into the playback ring; false when it is full or done
+    void feedLoop();
+
+    static constexpr size_t FEED_BLOCK_FRAMES = 1024;     // Frames mixed per feeder step
+    static constexpr size_t PLAYBACK_RING_FRAMES = 8192;  // About 190ms of lead at 44.1kHz
+    static constexpr size_t ANALYSIS_RING_FRAMES = 32768; // Render thread may stall this long
+    static constexpr size_t MAX_CALLBACK_FRAMES = 4096;   // Callback scratch, larger buffers are split
+
+    MixEngine &mixer;
+    const AudioSourceList sources;
+    const size_t length;
+    const size_t historySize;
+    const size_t outputChannels;
+    const size_t stride; // Floats per frame: output channels, then one per source
+
+    SpscRing<float> playbackRing; // Feeder -> callback
+    SpscRing<float> analysisRing; // Callback -> render thread
+
+    // Feeder state
+    std::thread feedThread;
+    std::atomic<bool> stopping{false};
+    size_t feedPosition = 0;
+    std::vector<float> feedFrames;
+
+    // Callback state, preallocated so the callback never allocates
+    std::vector<float> callbackFrames;
+    std::atomic<size_t> playedFrames{0};
+    std::atomic<bool> playbackDone{false};
+
+    // Render thread state: per-source history, newest historySize samples at the end
+    std::vector<float> drainFrames;
+    std::vector<std::vector<float>> history;
+    std::vector<AudioView> windowViews;
+    size_t analyzedFrames = 0;
+
+    std::atomic<uint64_t> xruns{0};         // Underflow/overflow reported by PortAudio
+    std::atomic<uint64_t> lateCallbacks{0}; // Callback ran after its buffer was due at the DAC
+    std::atomic<uint64_t> underruns{0};     // Feeder fell behind and silence was played
+    std::atomic<uint64_t> analysisDrops{0}; // Played frames the render thread had no room for
+};
+
+#endif // LIVE_PLAYBACK_H
@@ -0,0 +1,143 @@
+#include "mapped_wav_source.h"
+#include <algorithm>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// WAV headers are little-endian
+static uint16_t readLE16(const unsigned char *p)
+{
+    return static_cast<uint16_t>(p[0] | (p[1] << 8));
+}
+
+static uint32_t readLE32(const unsigned char *p)
+{
+    return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) |
+           (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+}
+
+MappedWavSource::MappedWavSource()
+{
+}
+
+MappedWavSource::~MappedWavSource()
+{
+}
+
+bool MappedWavSource::open(const std::string &filename)
+{
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+
+    struct stat fileStat;
+    if (fstat(fd, &fileStat) != 0 || fileStat.st_size < 12)
+    {
+        close(fd);
+        return false;
+    }
+
+    size_t size = static_cast<size_t>(fileStat.st_size);
+    void *address = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd); // The mapping keeps the file alive
+    if (address == MAP_FAILED)
+        return false;
+
+    // Views share the mapping, so it outlives the source if they do
+    mappingSize = size;
+    mapping = std::shared_ptr<const void>(address, [size](const void *p)
+                                          { munmap(const_cast<void *>(p), size); });
+
+    if (!parseHeader(mappingSize))
+    {
+        mapping.reset();
+        return false;
+    }
+
+    // Playback and recording walk the file front to back
+    madvise(address, mappingSize, MADV_SEQUENTIAL);
+    return true;
+}
+
+bool MappedWavSource::parseHeader(size_t fileSize)
+{
+    const unsigned char *base = static_cast<const unsigned char *>(mapping.get());
+    if (std::memcmp(base, "RIFF", 4) != 0 || std::memcmp(base + 8, "WAVE", 4) != 0)
+        return false;
+
+    bool haveFormat = false;
+    size_t offset = 12;
+    while (offset + 8 <= fileSize)
+    {
+        const unsigned char *chunk = base + offset;
+        size_t chunkSize = readLE32(chunk + 4);
+        size_t bodyOffset = offset + 8;
+
+        if (std::memcmp(chunk, "fmt ", 4) == 0)
+        {
+            if (chunkSize < 16 || bodyOffset + chunkSize > fileSize)
+                return false;
+
+            const unsigned char *fmt = base + bodyOffset;
+            uint16_t formatTag = readLE16(fmt);
+            fileChannels = readLE16(fmt + 2);
+            fileSampleRate = static_cast<int>(readLE32(fmt + 4));
+            uint16_t blockAlign = readLE16(fmt + 12);
+            uint16_t bitsPerSample = readLE16(fmt + 14);
+
+            // WAVE_FORMAT_EXTENSIBLE keeps the real format in the sub-format GUID
+            if (formatTag == 0xFFFE && chunkSize >= 40)
+                formatTag = readLE16(fmt + 24);
+
+            if (formatTag == 1 && bitsPerSample == 16)
+                format = SampleFormat::Int16;
+            else if (formatTag == 3 && bitsPerSample == 32)
+                format = SampleFormat::Float32;
+            else
+                return false; // Left to the libsndfile backend
+
+            bytesPerFrame = static_cast<size_t>(fileChannels) * (bitsPerSample / 8);
+            if (fileChannels <= 0 || blockAlign != bytesPerFrame)
+                return false;
+            haveFormat = true;
+        }
+        else if (std::memcmp(chunk, "data", 4) == 0)
+        {
+            if (!haveFormat)
+                return false;
+
+            // Streamed WAVs leave the size unset as 0 or 0xFFFFFFFF, and a
+            // truncated file can claim more than it holds; trust the file
+            // length then. A partial last frame is dropped.
+            size_t remaining = fileSize - bodyOffset;
+            size_t dataSize = (chunkSize == 0 || chunkSize > remaining) ? remaining : chunkSize;
+            dataSize -= dataSize % bytesPerFrame;
+            frames = base + bodyOffset;
+            totalFrames = dataSize / bytesPerFrame;
+            return true;
+        }
+
+        // Chunks are padded to an even size
+        offset = bodyOffset + chunkSize + (chunkSize & 1);
+    }
+
+    return false;
+}
+
+bool MappedWavSource::view(size_t position, size_t count, AudioView &result)
+{
+    // Past the end of the data the view is pure silence
+    size_t available = position < totalFrames ? std::min(count, totalFrames - position) : 0;
+    const unsigned char *start = available > 0 ? frames + position * bytesPerFrame : frames;
+    result = AudioView(start, format, fileChannels, available, count, mapping);
+    return true;
+}
+
+void MappedWavSource::read(size_t position, float *dest, size_t count)
+{
+    AudioView samples;
+    view(position, count, samples);
+    samples.copyTo(dest);
+}
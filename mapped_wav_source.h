@@ -0,0 +1,44 @@
+#ifndef MAPPED_WAV_SOURCE_H
+#define MAPPED_WAV_SOURCE_H
+
+#include "audio_source.h"
+#include <memory>
+#include <string>
+
+// Memory-maps the data chunk of a 16-bit PCM or 32-bit float WAV file and
+// hands out zero-copy views into it. Pages are loaded on demand and can be
+// dropped by the kernel, so neither start-up time nor resident memory grows
+// with the length of the file.
+class MappedWavSource : public AudioSource
+{
+public:
+    MappedWavSource();
+    ~MappedWavSource() override;
+
+    MappedWavSource(const MappedWavSource &) = delete;
+    MappedWavSource &operator=(const MappedWavSource &) = delete;
+
+    // Map the file; returns false for formats this backend does not handle
+    bool open(const std::string &filename);
+
+    size_t length() const override { return totalFrames; }
+    int channels() const override { return fileChannels; }
+    int sampleRate() const override { return fileSampleRate; }
+
+    void read(size_t position, float *dest, size_t count) override;
+    bool view(size_t position, size_t count, AudioView &result) override;
+
+private:
+    bool parseHeader(size_t fileSize);
+
+    std::shared_ptr<const void> mapping; // Unmapped once the source and all views are gone
+    size_t mappingSize = 0;
+    const unsigned char *frames = nullptr; // Start of the data chunk
+    size_t totalFrames = 0;
+    size_t bytesPerFrame = 0;
+    int fileChannels = 1;
+    int fileSampleRate = 0;
+    SampleFormat format = SampleFormat::Float32;
+};
+
+#endif // MAPPED_WAV_SOURCE_H
@@ -1,15 +1,63 @@
 #include "maze_visualizer.h"
+#include "gl_math.h"
 #include <GL/glew.h>
 #include <cmath>
 #include <algorithm>
 #include <random>
 #include <vector>
 
-#ifdef __APPLE__
-#include <OpenGL/glu.h>
-#else
-#include <GL/glu.h>
-#endif
+// Wall edges are static; the audio pulse on their height and the glow on
+// their color are applied here from the per-cell phase
+static const char *WALL_VERTEX_SHADER = R"(#version 120
+CAMERA_UNIFORMS
+uniform float scroll;
+uniform float amplitude;
+uniform float wallHeight;
+uniform float pulseIntensity;
+uniform vec3 wallColor;
+attribute vec4 wallVertex; // x, share of wall height, z, pulse phase
+varying vec3 color;
+
+void main()
+{
+    float pulse = sin(wallVertex.w * 0.5 + scroll * 0.1);
+    float height = wallHeight * (1.0 + amplitude * pulseIntensity * pulse);
+    float glow = amplitude * (0.5 + 0.5 * sin(scroll * 0.2 + wallVertex.w));
+    color = wallColor * (0.5 + glow * 0.5);
+    gl_Position = viewProjection * vec4(wallVertex.x, wallVertex.y * height, wallVertex.z + scroll, 1.0);
+}
+)";
+
+static const char *WALL_FRAGMENT_SHADER = R"(#version 120
+varying vec3 color;
+
+void main()
+{
+    gl_FragColor = vec4(color, 1.0);
+}
+)";
+
+// Floor, ceiling and path lines: flat at one height, one color per draw
+static const char *LINE_VERTEX_SHADER = R"(#version 120
+CAMERA_UNIFORMS
+uniform vec2 scroll; // Added to x and z
+uniform float height;
+attribute vec2 lineVertex; // x, z
+
+void main()
+{
+    gl_Position = viewProjection * vec4(lineVertex.x + scroll.x, height, lineVertex.y + scroll.y, 1.0);
+}
+)";
+
+static const char *LINE_FRAGMENT_SHADER = R"(#version 120
+uniform vec3 color;
+
+void main()
+{
+    gl_FragColor = vec4(color, 1.0);
+}
+)";
 
 MazeVisualizer::MazeVisualizer() : audioAmplitude(0.0f), mazePosition(0.0f), cameraRotation(0.0f)
 {
@@ -25,7 +73,16 @@ MazeVisualizer::MazeVisualizer() : audioAmplitude(0.0f), mazePosition(0.0f), cam
     }
 }
 
-MazeVisualizer::~MazeVisualizer() {}
+MazeVisualizer::~MazeVisualizer()
+{
+    for (GLuint *buffer : {&wallVbo, &lineVbo})
+    {
+        if (*buffer)
+        {
+            glDeleteBuffers(1, buffer);
+        }
+    }
+}
 
 void MazeVisualizer::initialize(int width, int height)
 {
@@ -48,7 +105,7 @@ void MazeVisualizer::generateMaze()
     {
         for (int z = 0; z < MAZE_SIZE; z++)
         {
-            maze[x][z] = {true, WALL_HEIGHT, 0.5f};
+            maze[x][z] = {true};
         }
     }
 
@@ -67,7 +124,7 @@ void MazeVisualizer::generateMaze()
         startZ++;
 
     // Mark starting cell as path
-    maze[startX][startZ] = {false, 0.0f, 0.5f};
+    maze[startX][startZ] = {false};
     visited[startX][startZ] = true;
     stack.push_back({startX, startZ});
 
@@ -108,13 +165,13 @@ void MazeVisualizer::generateMaze()
             int newZ = currentZ + dz[direction];
 
             // Create path to neighbor
-            maze[newX][newZ] = {false, 0.0f, 0.5f};
+            maze[newX][newZ] = {false};
             visited[newX][newZ] = true;
 
             // Remove wall between current and neighbor
             int wallX = currentX + dx[direction] / 2;
             int wallZ = currentZ + dz[direction] / 2;
-            maze[wallX][wallZ] = {false, 0.0f, 0.5f};
+            maze[wallX][wallZ] = {false};
 
             // Add neighbor to stack
             stack.push_back({newX, newZ});
@@ -147,7 +204,7 @@ void MazeVisualizer::generateMaze()
 
                 if (pathNeighbors >= 2)
                 {
-                    maze[x][z] = {false, 0.0f, 0.5f};
+                    maze[x][z] = {false};
                 }
             }
         }
@@ -156,13 +213,139 @@ void MazeVisualizer::generateMaze()
     // Ensure outer walls remain
     for (int i = 0; i < MAZE_SIZE; i++)
     {
-        maze[0][i] = {true, WALL_HEIGHT, 0.5f};
-        maze[MAZE_SIZE - 1][i] = {true, WALL_HEIGHT, 0.5f};
-        maze[i][0] = {true, WALL_HEIGHT, 0.5f};
-        maze[i][MAZE_SIZE - 1] = {true, WALL_HEIGHT, 0.5f};
+        maze[0][i] = {true};
+        maze[MAZE_SIZE - 1][i] = {true};
+        maze[i][0] = {true};
+        maze[i][MAZE_SIZE - 1] = {true};
+    }
+
+    // The camera and the path follow the first open corridor of each row
+    corridorX.assign(MAZE_SIZE, -1);
+    for (int z = 0; z < MAZE_SIZE; z++)
+    {
+        for (int x = 1; x < MAZE_SIZE - 1; x++)
+        {
+            if (!maze[x][z].hasWall)
+            {
+                corridorX[z] = x;
+                break;
+            }
+        }
+    }
+
+    buildWallGeometry();
+    buildLineGeometry();
+}
+
+void MazeVisualizer::buildWallGeometry()
+{
+    wallVertices.clear();
+    wallChunks.clear();
+
+    const float cellHalf = CELL_SIZE * 0.5f;
+    for (int chunkX = 0; chunkX < MAZE_SIZE; chunkX += CHUNK_CELLS)
+    {
+        // Chunks along z sit next to each other in the buffer, so the run
+        // ahead of the camera is mostly one draw
+        for (int chunkZ = 0; chunkZ < MAZE_SIZE; chunkZ += CHUNK_CELLS)
+        {
+            int endX = std::min(chunkX + CHUNK_CELLS, MAZE_SIZE);
+            int endZ = std::min(chunkZ + CHUNK_CELLS, MAZE_SIZE);
+
+            WallChunk chunk;
+            chunk.first = static_cast<GLint>(wallVertices.size() / 4);
+            chunk.minX = (chunkX - MAZE_SIZE / 2) * CELL_SIZE - cellHalf;
+            chunk.maxX = (endX - 1 - MAZE_SIZE / 2) * CELL_SIZE + cellHalf;
+            chunk.minZ = (chunkZ - MAZE_SIZE / 2) * CELL_SIZE - cellHalf;
+            chunk.maxZ = (endZ - 1 - MAZE_SIZE / 2) * CELL_SIZE + cellHalf;
+
+            for (int x = chunkX; x < endX; x++)
+            {
+                for (int z = chunkZ; z < endZ; z++)
+                {
+                    if (!maze[x][z].hasWall)
+                        continue;
+
+                    float worldX = (x - MAZE_SIZE / 2) * CELL_SIZE;
+                    float worldZ = (z - MAZE_SIZE / 2) * CELL_SIZE;
+                    float phase = static_cast<float>(x + z);
+
+                    // Heights are shares of the pulsing wall height
+                    auto edge = [&](float x0, float h0, float z0, float x1, float h1, float z1)
+                    {
+                        wallVertices.insert(wallVertices.end(), {worldX + x0, h0, worldZ + z0, phase,
+                                                                 worldX + x1, h1, worldZ + z1, phase});
+                    };
+
+                    // Bottom and top face outlines
+                    for (float h : {0.0f, 1.0f})
+                    {
+                        edge(-cellHalf, h, -cellHalf, cellHalf, h, -cellHalf);
+                        edge(cellHalf, h, -cellHalf, cellHalf, h, cellHalf);
+                        edge(cellHalf, h, cellHalf, -cellHalf, h, cellHalf);
+                        edge(-cellHalf, h, cellHalf, -cellHalf, h, -cellHalf);
+                    }
+
+                    // Vertical edges connecting bottom to top
+                    edge(-cellHalf, 0.0f, -cellHalf, -cellHalf, 1.0f, -cellHalf);
+                    edge(cellHalf, 0.0f, -cellHalf, cellHalf, 1.0f, -cellHalf);
+                    edge(-cellHalf, 0.0f, cellHalf, -cellHalf, 1.0f, cellHalf);
+                    edge(cellHalf, 0.0f, cellHalf, cellHalf, 1.0f, cellHalf);
+
+                    // Cross pattern on front face
+                    edge(-cellHalf, 0.5f, -cellHalf, cellHalf, 0.5f, -cellHalf);
+                    edge(0.0f, 0.0f, -cellHalf, 0.0f, 1.0f, -cellHalf);
+                }
+            }
+
+            chunk.count = static_cast<GLsizei>(wallVertices.size() / 4) - chunk.first;
+            if (chunk.count > 0)
+            {
+                wallChunks.push_back(chunk);
+            }
+        }
     }
 }
 
+void MazeVisualizer::buildLineGeometry()
+{
+    lineVertices.clear();
+
+    // Grids centered on the camera and reaching VIEW_DISTANCE both ways, so
+    // their size does not depend on the maze's; the ceiling has half as
+    // many lines
+    const float gridSize = VIEW_DISTANCE;
+    auto grid = [&](float step, GLint &first, GLsizei &count)
+    {
+        first = static_cast<GLint>(lineVertices.size() / 2);
+        int lines = static_cast<int>(gridSize / step);
+        for (int i = -lines; i <= lines; i++)
+        {
+            float offset = i * step;
+            lineVertices.insert(lineVertices.end(), {offset, -VIEW_DISTANCE, offset, VIEW_DISTANCE,
+                                                     -gridSize, offset, gridSize, offset});
+        }
+        count = static_cast<GLsizei>(lineVertices.size() / 2) - first;
+    };
+    grid(CELL_SIZE, floorFirst, floorCount);
+    grid(CELL_SIZE * 2.0f, ceilingFirst, ceilingCount);
+
+    // Path along the open corridor of each row, one segment per row
+    pathFirst = static_cast<GLint>(lineVertices.size() / 2);
+    pathRowVertex.assign(MAZE_SIZE + 1, 0);
+    for (int z = 0; z < MAZE_SIZE; z++)
+    {
+        pathRowVertex[z] = static_cast<GLint>(lineVertices.size() / 2);
+        if (corridorX[z] < 0)
+            continue;
+
+        float worldX = (corridorX[z] - MAZE_SIZE / 2) * CELL_SIZE;
+        float rowZ = (z - MAZE_SIZE / 2) * CELL_SIZE;
+        lineVertices.insert(lineVertices.end(), {worldX, rowZ, worldX, rowZ + CELL_SIZE});
+    }
+    pathRowVertex[MAZE_SIZE] = static_cast<GLint>(lineVertices.size() / 2);
+}
+
 void MazeVisualizer::createTunnelSegment(float x, float z, float rotation)
 {
     tunnelPath.push_back({x, z, rotation, TUNNEL_WIDTH});
@@ -170,35 +353,20 @@ void MazeVisualizer::createTunnelSegment(float x, float z, float rotation)
 
 void MazeVisualizer::setupPerspectiveView()
 {
-    glMatrixMode(GL_PROJECTION);
-    glLoadIdentity();
-
     float aspect = static_cast<float>(screenWidth) / screenHeight;
-
-#ifdef __APPLE__
-#pragma clang diagnostic push
-#pragma clang diagnostic ignored "-Wdeprecated-declarations"
-#endif
-    gluPerspective(75.0f, aspect, 0.1f, 100.0f);
-
-    glMatrixMode(GL_MODELVIEW);
-    glLoadIdentity();
+    projection = perspectiveMatrix(FIELD_OF_VIEW, aspect, 0.1f, 100.0f);
 
     // Camera follows a path through the maze
     // Convert world position to maze coordinates
     float worldZ = mazePosition;
     int mazeZ = static_cast<int>((worldZ / CELL_SIZE) + MAZE_SIZE / 2);
 
-    // Find a valid path to follow
-    float cameraX = 0.0f;
-    for (int x = 1; x < MAZE_SIZE - 1; x++)
+    // Follow the open corridor of the current row
+    int checkZ = mazeZ % MAZE_SIZE;
+    cameraX = 0.0f;
+    if (checkZ >= 0 && corridorX[checkZ] >= 0)
     {
-        int checkZ = mazeZ % MAZE_SIZE;
-        if (checkZ >= 0 && checkZ < MAZE_SIZE && !maze[x][checkZ].hasWall)
-        {
-            cameraX = (x - MAZE_SIZE / 2) * CELL_SIZE;
-            break;
-        }
+        cameraX = (corridorX[checkZ] - MAZE_SIZE / 2) * CELL_SIZE;
     }
 
     float cameraY = 0.4f + audioAmplitude * 0.1f; // Eye level with slight audio bob
@@ -209,12 +377,10 @@ void MazeVisualizer::setupPerspectiveView()
     float targetY = 0.4f;
     float targetZ = mazePosition - 2.0f;
 
-    gluLookAt(cameraX, cameraY, cameraZ, // Eye
-              targetX, targetY, targetZ, // Target
-              0.0f, 1.0f, 0.0f);         // Up
-#ifdef __APPLE__
-#pragma clang diagnostic pop
-#endif
+    view = lookAtMatrix({cameraX, cameraY, cameraZ}, // Eye
+                             {targetX, targetY, targetZ}, // Target
+                             {0.0f, 1.0f, 0.0f});         // Up
+    camera.set(projection * view);
 }
 
 void MazeVisualizer::updateMaze(float deltaTime)
@@ -222,22 +388,8 @@ void MazeVisualizer::updateMaze(float deltaTime)
     mazePosition -= deltaTime * MOVE_SPEED;
     cameraRotation += deltaTime * 0.5f;
 
-    // Update wall heights and glow based on audio
-    for (int x = 0; x < MAZE_SIZE; x++)
-    {
-        for (int z = 0; z < MAZE_SIZE; z++)
-        {
-            if (maze[x][z].hasWall)
-            {
-                // Pulse wall height with audio
-                float basePulse = std::sin((x + z) * 0.5f + mazePosition * 0.1f);
-                maze[x][z].height = WALL_HEIGHT * (1.0f + audioAmplitude * PULSE_INTENSITY * basePulse);
-
-                // Update glow intensity
-                maze[x][z].glowIntensity = audioAmplitude * (0.5f + 0.5f * std::sin(mazePosition * 0.2f + x + z));
-            }
-        }
-    }
+    // Wall height and glow follow mazePosition and the amplitude in the
+    // wall shader
 }
 
 void MazeVisualizer::updateTunnel(float deltaTime)
@@ -262,191 +414,156 @@ void MazeVisualizer::updateTunnel(float deltaTime)
 
 void MazeVisualizer::renderMazeWalls()
 {
-    glLineWidth(2.0f + audioAmplitude * 3.0f);
+    if (wallChunks.empty() || !wallShader.build(WALL_VERTEX_SHADER, WALL_FRAGMENT_SHADER, {"wallVertex"}))
+        return;
 
-    glBegin(GL_LINES);
+    if (!wallVbo)
+    {
+        glGenBuffers(1, &wallVbo);
+        glBindBuffer(GL_ARRAY_BUFFER, wallVbo);
+        glBufferData(GL_ARRAY_BUFFER, wallVertices.size() * sizeof(float), wallVertices.data(), GL_STATIC_DRAW);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        // The buffer is the only copy from here on
+        std::vector<float>().swap(wallVertices);
+        walls.attribute(0, wallVbo, 4);
+    }
 
-    for (int x = 0; x < MAZE_SIZE; x++)
+    // Cull whole chunks against the view volume, cut off at VIEW_DISTANCE
+    float aspect = static_cast<float>(screenWidth) / screenHeight;
+    Frustum frustum = frustumFromMatrix(perspectiveMatrix(FIELD_OF_VIEW, aspect, 0.1f, VIEW_DISTANCE) * view);
+    const float maxHeight = WALL_HEIGHT * (1.0f + PULSE_INTENSITY);
+
+    wallShader.use();
+    camera.apply(wallShader);
+    ShaderProgram::set(wallShader.uniform("scroll"), mazePosition);
+    ShaderProgram::set(wallShader.uniform("amplitude"), audioAmplitude);
+    ShaderProgram::set(wallShader.uniform("wallHeight"), WALL_HEIGHT);
+    ShaderProgram::set(wallShader.uniform("pulseIntensity"), PULSE_INTENSITY);
+    ShaderProgram::set(wallShader.uniform("wallColor"), WALL_COLOR[0], WALL_COLOR[1], WALL_COLOR[2]);
+
+    GLProfile::lineWidth(2.0f + audioAmplitude * 3.0f);
+    walls.bind();
+
+    // Visible chunks that follow each other in the buffer share a draw
+    GLint runFirst = 0;
+    GLsizei runCount = 0;
+    for (const WallChunk &chunk : wallChunks)
     {
-        for (int z = 0; z < MAZE_SIZE; z++)
+        bool visible = boxInFrustum(frustum,
+                                    {chunk.minX, 0.0f, chunk.minZ + mazePosition},
+                                    {chunk.maxX, maxHeight, chunk.maxZ + mazePosition});
+        if (visible && runCount > 0 && chunk.first == runFirst + runCount)
         {
-            if (!maze[x][z].hasWall)
-                continue;
-
-            float worldX = (x - MAZE_SIZE / 2) * CELL_SIZE;
-            float worldZ = (z - MAZE_SIZE / 2) * CELL_SIZE + mazePosition;
-            float height = maze[x][z].height;
-            float glow = maze[x][z].glowIntensity;
-
-            // Skip walls that are too far away
-            if (worldZ < mazePosition - 20.0f || worldZ > mazePosition + 20.0f)
-                continue;
-
-            // Set color with glow effect
-            glColor3f(WALL_COLOR[0] * (0.5f + glow * 0.5f),
-                      WALL_COLOR[1] * (0.5f + glow * 0.5f),
-                      WALL_COLOR[2] * (0.5f + glow * 0.5f));
-
-            float cellHalf = CELL_SIZE * 0.5f;
-
-            // Draw a solid cube-like wall structure
-            // Bottom face outline
-            glVertex3f(worldX - cellHalf, 0.0f, worldZ - cellHalf);
-            glVertex3f(worldX + cellHalf, 0.0f, worldZ - cellHalf);
-
-            glVertex3f(worldX + cellHalf, 0.0f, worldZ - cellHalf);
-            glVertex3f(worldX + cellHalf, 0.0f, worldZ + cellHalf);
-
-            glVertex3f(worldX + cellHalf, 0.0f, worldZ + cellHalf);
-            glVertex3f(worldX - cellHalf, 0.0f, worldZ + cellHalf);
-
-            glVertex3f(worldX - cellHalf, 0.0f, worldZ + cellHalf);
-            glVertex3f(worldX - cellHalf, 0.0f, worldZ - cellHalf);
-
-            // Top face outline
-            glVertex3f(worldX - cellHalf, height, worldZ - cellHalf);
-            glVertex3f(worldX + cellHalf, height, worldZ - cellHalf);
-
-            glVertex3f(worldX + cellHalf, height, worldZ - cellHalf);
-            glVertex3f(worldX + cellHalf, height, worldZ + cellHalf);
-
-            glVertex3f(worldX + cellHalf, height, worldZ + cellHalf);
-            glVertex3f(worldX - cellHalf, height, worldZ + cellHalf);
-
-            glVertex3f(worldX - cellHalf, height, worldZ + cellHalf);
-            glVertex3f(worldX - cellHalf, height, worldZ - cellHalf);
-
-            // Vertical edges connecting bottom to top
-            glVertex3f(worldX - cellHalf, 0.0f, worldZ - cellHalf);
-            glVertex3f(worldX - cellHalf, height, worldZ - cellHalf);
-
-            glVertex3f(worldX + cellHalf, 0.0f, worldZ - cellHalf);
-            glVertex3f(worldX + cellHalf, height, worldZ - cellHalf);
-
-            glVertex3f(worldX - cellHalf, 0.0f, worldZ + cellHalf);
-            glVertex3f(worldX - cellHalf, height, worldZ + cellHalf);
-
-            glVertex3f(worldX + cellHalf, 0.0f, worldZ + cellHalf);
-            glVertex3f(worldX + cellHalf, height, worldZ + cellHalf);
-
-            // Add some internal structure for more detail
-            // Cross pattern on front face
-            glVertex3f(worldX - cellHalf, height * 0.5f, worldZ - cellHalf);
-            glVertex3f(worldX + cellHalf, height * 0.5f, worldZ - cellHalf);
+            runCount += chunk.count;
+            continue;
+        }
 
-            glVertex3f(worldX, 0.0f, worldZ - cellHalf);
-            glVertex3f(worldX, height, worldZ - cellHalf);
+        if (runCount > 0)
+        {
+            glDrawArrays(GL_LINES, runFirst, runCount);
         }
+        runFirst = chunk.first;
+        runCount = visible ? chunk.count : 0;
+    }
+    if (runCount > 0)
+    {
+        glDrawArrays(GL_LINES, runFirst, runCount);
     }
 
-    glEnd();
+    walls.unbind();
+    ShaderProgram::release();
 }
 
-void MazeVisualizer::renderFloorAndCeiling()
+bool MazeVisualizer::beginLines()
 {
-    glLineWidth(1.0f);
-
-    // Floor grid
-    glBegin(GL_LINES);
-    glColor3fv(FLOOR_COLOR);
+    if (!lineShader.build(LINE_VERTEX_SHADER, LINE_FRAGMENT_SHADER, {"lineVertex"}))
+        return false;
 
-    float gridSize = MAZE_SIZE * CELL_SIZE;
-    float gridStep = CELL_SIZE;
-
-    for (float x = -gridSize; x <= gridSize; x += gridStep)
+    if (!lineVbo)
     {
-        glVertex3f(x, 0.0f, mazePosition - 20.0f);
-        glVertex3f(x, 0.0f, mazePosition + 20.0f);
+        glGenBuffers(1, &lineVbo);
+        glBindBuffer(GL_ARRAY_BUFFER, lineVbo);
+        glBufferData(GL_ARRAY_BUFFER, lineVertices.size() * sizeof(float), lineVertices.data(), GL_STATIC_DRAW);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        std::vector<float>().swap(lineVertices);
+        lines.attribute(0, lineVbo, 2);
     }
 
-    for (float z = mazePosition - 20.0f; z <= mazePosition + 20.0f; z += gridStep)
-    {
-        glVertex3f(-gridSize, 0.0f, z);
-        glVertex3f(gridSize, 0.0f, z);
-    }
+    lineShader.use();
+    camera.apply(lineShader);
+    lines.bind();
+    return true;
+}
 
-    glEnd();
+void MazeVisualizer::endLines()
+{
+    lines.unbind();
+    ShaderProgram::release();
+}
 
-    // Ceiling grid (higher up)
-    glBegin(GL_LINES);
-    glColor3fv(CEILING_COLOR);
+void MazeVisualizer::renderFloorAndCeiling()
+{
+    if (!beginLines())
+        return;
 
-    float ceilingHeight = 3.0f + audioAmplitude * 0.5f;
+    GLProfile::lineWidth(1.0f);
 
-    for (float x = -gridSize; x <= gridSize; x += gridStep * 2)
-    {
-        glVertex3f(x, ceilingHeight, mazePosition - 20.0f);
-        glVertex3f(x, ceilingHeight, mazePosition + 20.0f);
-    }
+    // Both grids move with the camera; the ceiling's lines are two cells
+    // apart, so it only follows the camera in steps of two cells
+    const float ceilingStep = CELL_SIZE * 2.0f;
+    const float ceilingX = std::round(cameraX / ceilingStep) * ceilingStep;
+    const float ceilingHeight = 3.0f + audioAmplitude * 0.5f;
 
-    for (float z = mazePosition - 20.0f; z <= mazePosition + 20.0f; z += gridStep * 2)
-    {
-        glVertex3f(-gridSize, ceilingHeight, z);
-        glVertex3f(gridSize, ceilingHeight, z);
-    }
+    ShaderProgram::set(lineShader.uniform("scroll"), cameraX, mazePosition);
+    ShaderProgram::set(lineShader.uniform("height"), 0.0f);
+    ShaderProgram::set(lineShader.uniform("color"), FLOOR_COLOR[0], FLOOR_COLOR[1], FLOOR_COLOR[2]);
+    glDrawArrays(GL_LINES, floorFirst, floorCount);
 
-    glEnd();
+    ShaderProgram::set(lineShader.uniform("scroll"), ceilingX, mazePosition);
+    ShaderProgram::set(lineShader.uniform("height"), ceilingHeight);
+    ShaderProgram::set(lineShader.uniform("color"), CEILING_COLOR[0], CEILING_COLOR[1], CEILING_COLOR[2]);
+    glDrawArrays(GL_LINES, ceilingFirst, ceilingCount);
+
+    endLines();
 }
 
 void MazeVisualizer::renderTunnelEffects()
 {
-    // Render a simple path line through the maze corridors
-    glLineWidth(2.0f + audioAmplitude * 3.0f);
-
-    glBegin(GL_LINE_STRIP);
-    glColor3f(GLOW_COLOR[0] * (0.5f + audioAmplitude * 0.5f),
-              GLOW_COLOR[1] * (0.5f + audioAmplitude * 0.5f),
-              GLOW_COLOR[2] * (0.5f + audioAmplitude * 0.5f));
-
-    // Draw a path line at floor level through open corridors
-    for (float z = mazePosition - 15.0f; z <= mazePosition + 5.0f; z += 0.5f)
-    {
-        int mazeZ = static_cast<int>((z / CELL_SIZE) + MAZE_SIZE / 2);
-        if (mazeZ >= 0 && mazeZ < MAZE_SIZE)
-        {
-            // Find an open path at this Z level
-            for (int x = 1; x < MAZE_SIZE - 1; x++)
-            {
-                if (!maze[x][mazeZ].hasWall)
-                {
-                    float worldX = (x - MAZE_SIZE / 2) * CELL_SIZE;
-                    glVertex3f(worldX, 0.05f, z);
-                    break;
-                }
-            }
-        }
-    }
-
-    glEnd();
+    // Path line at floor level through the rows from 15 units ahead of
+    // the camera to 5 behind
+    int firstRow = std::max(0, static_cast<int>(std::floor((mazePosition - 15.0f) / CELL_SIZE)) + MAZE_SIZE / 2);
+    int lastRow = std::min(MAZE_SIZE - 1, static_cast<int>(std::floor((mazePosition + 5.0f) / CELL_SIZE)) + MAZE_SIZE / 2);
+    if (lastRow < firstRow)
+        return;
+
+    GLint first = pathRowVertex[firstRow];
+    GLsizei count = pathRowVertex[lastRow + 1] - first;
+    if (count < 2 || !beginLines())
+        return;
+
+    GLProfile::lineWidth(2.0f + audioAmplitude * 3.0f);
+
+    float glow = 0.5f + audioAmplitude * 0.5f;
+    ShaderProgram::set(lineShader.uniform("scroll"), 0.0f, 0.0f);
+    ShaderProgram::set(lineShader.uniform("height"), 0.05f);
+    ShaderProgram::set(lineShader.uniform("color"), GLOW_COLOR[0] * glow, GLOW_COLOR[1] * glow, GLOW_COLOR[2] * glow);
+    glDrawArrays(GL_LINE_STRIP, first, count);
+
+    endLines();
 }
 
-float MazeVisualizer::calculateAudioAmplitude(const std::vector<float> &audioData, size_t position)
+float MazeVisualizer::calculateAudioAmplitude(const SourceSpectrum &spectrum)
 {
-    const size_t windowSize = 1024;
-    size_t end = std::min(position + windowSize, audioData.size());
-
-    float sum = 0.0f;
-    for (size_t i = position; i < end; i++)
-    {
-        sum += std::fabs(audioData[i]);
-    }
-
-    float average = 0.0f;
-    size_t count = end - position;
-    if (count > 0)
-        average = sum / static_cast<float>(count);
-
-    return std::min(1.0f, average * 5.0f); // Amplify for dramatic effect
+    // The analysis level is the mean absolute sample over the block
+    // Amplify for dramatic effect
+    return std::min(1.0f, spectrum.level * 5.0f);
 }
 
-void MazeVisualizer::renderFrame(const std::vector<float> &audioData,
-                                 double * /* fftInputBuffer */,
-                                 fftw_complex * /* fftOutputBuffer */,
-                                 fftw_plan & /* fftPlan */,
+void MazeVisualizer::renderFrame(const AnalysisFrame &analysis,
                                  float timeSeconds)
 {
-    size_t sampleIndex = static_cast<size_t>(timeSeconds * 44100);
-    audioAmplitude = calculateAudioAmplitude(audioData, sampleIndex);
+    (void)timeSeconds; // Animation is frame-driven
+    audioAmplitude = calculateAudioAmplitude(analysis.primary());
 
     setupPerspectiveView();
 
@@ -470,13 +587,11 @@ void MazeVisualizer::renderFrame(const std::vector<float> &audioData,
     glDisable(GL_BLEND);
 }
 
-void MazeVisualizer::renderLiveFrame(const std::vector<float> &audioData,
-                                     double * /* fftInputBuffer */,
-                                     fftw_complex * /* fftOutputBuffer */,
-                                     fftw_plan & /* fftPlan */,
+void MazeVisualizer::renderLiveFrame(const AnalysisFrame &analysis,
                                      size_t currentPosition)
 {
-    audioAmplitude = calculateAudioAmplitude(audioData, currentPosition);
+    (void)currentPosition; // Animation is frame-driven
+    audioAmplitude = calculateAudioAmplitude(analysis.primary());
 
     setupPerspectiveView();
 
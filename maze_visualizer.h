@@ -1,5 +1,10 @@
 #pragma once
 #include "visualizer_base.h"
+#include "gl_math.h"
+#include "shader_program.h"
+#include "uniform_buffer.h"
+#include "vertex_array.h"
+#include <GL/glew.h>
 #include <vector>
 #include <deque>
 
@@ -11,25 +16,34 @@ public:
 
     void initialize(int width, int height) override;
 
-    void renderFrame(const std::vector<float> &audioData,
-                     double *fftInputBuffer,
-                     fftw_complex *fftOutputBuffer,
-                     fftw_plan &fftPlan,
+    bool supportsCoreProfile() const override { return true; }
+
+    void renderFrame(const AnalysisFrame &analysis,
                      float timeSeconds) override;
 
-    void renderLiveFrame(const std::vector<float> &audioData,
-                         double *fftInputBuffer,
-                         fftw_complex *fftOutputBuffer,
-                         fftw_plan &fftPlan,
+    void renderLiveFrame(const AnalysisFrame &analysis,
                          size_t currentPosition) override;
 
+    // Glowing vector walls that leave a short trail as the camera moves
+    CRTSettings crtSettings() const override
+    {
+        CRTSettings settings;
+        settings.bloom = 0.6f;
+        settings.scanlines = 0.15f;
+        settings.persistence = 0.35f;
+        return settings;
+    }
+
 private:
-    static constexpr int MAZE_SIZE = 32;           // Larger maze for more complexity
+    static constexpr int MAZE_SIZE = 256;          // Per-frame cost does not depend on this
     static constexpr float CELL_SIZE = 0.8f;       // Larger cells for better corridors
     static constexpr float WALL_HEIGHT = 1.5f;     // Taller walls for better maze feel
     static constexpr float MOVE_SPEED = 1.5f;      // Slower movement to appreciate the maze
     static constexpr float TUNNEL_WIDTH = 0.3f;    // Width of the tunnel path
     static constexpr float PULSE_INTENSITY = 0.3f; // Reduced pulse for more stable walls
+    static constexpr float FIELD_OF_VIEW = 75.0f;  // Vertical, in degrees
+    static constexpr float VIEW_DISTANCE = 20.0f;  // Walls further ahead are not drawn
+    static constexpr int CHUNK_CELLS = 8;          // Walls are culled in squares of this many cells
 
     // Green vector colors
     static constexpr float WALL_COLOR[3] = {0.0f, 1.0f, 0.0f};    // Bright green
@@ -40,8 +54,15 @@ private:
     struct MazeCell
     {
         bool hasWall;
-        float height;
-        float glowIntensity;
+    };
+
+    // A square of cells whose wall edges are contiguous in the wall buffer
+    struct WallChunk
+    {
+        GLint first;
+        GLsizei count;
+        float minX, maxX; // Extent in maze space, before scrolling
+        float minZ, maxZ;
     };
 
     struct TunnelSegment
@@ -54,16 +75,44 @@ private:
     float audioAmplitude;
     float mazePosition;
     float cameraRotation;
+    float cameraX = 0.0f;
     std::vector<std::vector<MazeCell>> maze;
+    std::vector<int> corridorX; // First open cell x of each z row, -1 if none
     std::deque<TunnelSegment> tunnelPath;
 
+    // Wall edges, built once per maze; the camera matrices are kept for
+    // culling, and their product goes to every shader through camera
+    ShaderProgram wallShader;
+    GLuint wallVbo = 0;
+    VertexArray walls;
+    std::vector<float> wallVertices; // Until uploaded: x, share of wall height, z, pulse phase
+    std::vector<WallChunk> wallChunks;
+    Mat4 projection = identityMatrix();
+    Mat4 view = identityMatrix();
+    CameraUniforms camera;
+
+    // Floor and ceiling grids around the camera and the corridor path
+    // through the whole maze, built once and drawn with the line shader.
+    // The grids are shifted to the camera by its scroll uniform.
+    ShaderProgram lineShader;
+    GLuint lineVbo = 0;
+    VertexArray lines;
+    std::vector<float> lineVertices; // Until uploaded: x, z
+    GLint floorFirst = 0, ceilingFirst = 0, pathFirst = 0;
+    GLsizei floorCount = 0, ceilingCount = 0;
+    std::vector<GLint> pathRowVertex; // First path vertex of each z row, and one past the last
+
     void generateMaze();
+    void buildWallGeometry();
+    void buildLineGeometry();
+    bool beginLines();
+    void endLines();
     void updateMaze(float deltaTime);
     void updateTunnel(float deltaTime);
     void renderMazeWalls();
     void renderFloorAndCeiling();
     void renderTunnelEffects();
     void setupPerspectiveView();
-    float calculateAudioAmplitude(const std::vector<float> &audioData, size_t position);
+    float calculateAudioAmplitude(const SourceSpectrum &spectrum);
     void createTunnelSegment(float x, float z, float rotation);
 };
\ No newline at end of file
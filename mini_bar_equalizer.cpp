@@ -21,57 +21,35 @@ void MiniBarEqualizer::initialize(int width, int height)
     Visualizer::initialize(128, 43);
 }
 
-void MiniBarEqualizer::renderFrame(const std::vector<float> &audioData,
-                                   double *fftInputBuffer,
-                                   fftw_complex *fftOutputBuffer,
-                                   fftw_plan &fftPlan,
+void MiniBarEqualizer::renderFrame(const AnalysisFrame &analysis,
                                    float timeSeconds)
 {
-    // Calculate the sample index for the current time
-    size_t sampleIndex = static_cast<size_t>(timeSeconds * 44100); // Assuming 44.1kHz
-    if (sampleIndex >= audioData.size())
-        return;
-
-    // Fill the FFT input buffer with samples at this time
-    for (int i = 0; i < N; i++)
-    {
-        if (sampleIndex + i < audioData.size())
-        {
-            fftInputBuffer[i] = audioData[sampleIndex + i];
-        }
-        else
-        {
-            fftInputBuffer[i] = 0.0;
-        }
-    }
+    // Mark unused parameters to silence compiler warnings
+    (void)timeSeconds;
 
-    // Execute FFT
-    fftw_execute(fftPlan);
+    // Nothing to draw once the audio has ended
+    if (!analysis.primary().active)
+        return;
 
-    // Render bars based on FFT output
-    renderBars(fftOutputBuffer);
+    // Render bars based on the shared spectrum
+    renderBars(analysis);
 }
 
-void MiniBarEqualizer::renderLiveFrame(const std::vector<float> &audioData,
-                                       double *fftInputBuffer,
-                                       fftw_complex *fftOutputBuffer,
-                                       fftw_plan &fftPlan,
+void MiniBarEqualizer::renderLiveFrame(const AnalysisFrame &analysis,
                                        size_t currentPosition)
 {
     // Mark unused parameters to silence compiler warnings
-    (void)audioData;
-    (void)fftInputBuffer;
     (void)currentPosition;
 
-    // Execute FFT
-    fftw_execute(fftPlan);
-
-    // Render bars based on FFT output
-    renderBars(fftOutputBuffer);
+    // Render bars based on the shared spectrum
+    renderBars(analysis);
 }
 
-void MiniBarEqualizer::renderBars(fftw_complex *fftOutputBuffer)
+void MiniBarEqualizer::renderBars(const AnalysisFrame &analysis)
 {
+    const std::vector<float> &magnitudes = analysis.primary().magnitudes;
+    const int N = analysis.fftSize;
+
     // Calculate frequency bands for bars using logarithmic scale
     float barWidth = 2.0f / numBars; // normalized width in [-1, 1] space
 
@@ -99,8 +77,7 @@ void MiniBarEqualizer::renderBars(fftw_complex *fftOutputBuffer)
         float sum = 0.0f;
         for (int j = startIdx; j <= endIdx; j++)
         {
-            float magnitude = std::sqrt(fftOutputBuffer[j][0] * fftOutputBuffer[j][0] +
-                                        fftOutputBuffer[j][1] * fftOutputBuffer[j][1]);
+            float magnitude = magnitudes[j] * WINDOW_GAIN;
 
             // Apply gentler frequency-dependent scaling
             float freqScaling = std::pow(static_cast<float>(j) / (startIdx + 1), 0.3f);
@@ -136,13 +113,8 @@ void MiniBarEqualizer::renderBars(fftw_complex *fftOutputBuffer)
         float xRight = xLeft + barWidth * 0.8f; // Small gap between bars
 
         // Draw the main bar in green (monochrome)
-        glColor3f(0.0f, 1.0f, 0.0f);
-        glBegin(GL_QUADS);
-        glVertex2f(xLeft, -1.0f);
-        glVertex2f(xRight, -1.0f);
-        glVertex2f(xRight, -1.0f + height * 2);
-        glVertex2f(xLeft, -1.0f + height * 2);
-        glEnd();
+        batch.color(0.0f, 1.0f, 0.0f);
+        batch.rect(xLeft, -1.0f, xRight, -1.0f + height * 2);
 
         // Update peak (using the actual height, not scaled)
         float targetPeakHeight = height; // Removed PEAK_HEIGHT scaling
@@ -158,14 +130,23 @@ void MiniBarEqualizer::renderBars(fftw_complex *fftOutputBuffer)
                                       peakHeights[i] - peakDecay[i] * peakDecay[i]);
         }
 
-        // Draw peak line in green (monochrome - brighter green for visibility)
-        glColor3f(0.0f, 0.8f, 0.0f);
-        glLineWidth(3.0f); // Set line thickness to 3 pixels
-        glBegin(GL_LINES);
+    }
+
+    // Draw peak lines in green (monochrome - brighter green for visibility),
+    // all bars in one batch on top of the bars
+    batch.color(0.0f, 0.8f, 0.0f);
+    batch.lineWidth(3.0f); // Set line thickness to 3 pixels
+    batch.begin(GL_LINES);
+    for (int i = 0; i < numBars; i++)
+    {
+        float xLeft = -1.0f + i * barWidth;
+        float xRight = xLeft + barWidth * 0.8f;
         float peakY = -1.0f + peakHeights[i] * 2;
-        glVertex2f(xLeft, peakY);
-        glVertex2f(xRight, peakY);
-        glEnd();
-        glLineWidth(1.0f); // Reset line width to default
+        batch.vertex(xLeft, peakY);
+        batch.vertex(xRight, peakY);
     }
+    batch.end();
+    batch.lineWidth(1.0f); // Reset line width to default
+
+    batch.flush();
 }
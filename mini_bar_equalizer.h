@@ -13,24 +13,18 @@ public:
     void initialize(int width, int height) override;
 
     // Implement the base class methods
-    void renderFrame(const std::vector<float> &audioData,
-                     double *fftInputBuffer,
-                     fftw_complex *fftOutputBuffer,
-                     fftw_plan &fftPlan,
+    void renderFrame(const AnalysisFrame &analysis,
                      float timeSeconds) override;
 
-    void renderLiveFrame(const std::vector<float> &audioData,
-                         double *fftInputBuffer,
-                         fftw_complex *fftOutputBuffer,
-                         fftw_plan &fftPlan,
+    void renderLiveFrame(const AnalysisFrame &analysis,
                          size_t currentPosition) override;
 
 private:
     // Helper method for actual rendering (used by both render methods)
-    void renderBars(fftw_complex *fftOutputBuffer);
+    void renderBars(const AnalysisFrame &analysis);
 
     const int numBars;
-    const int N = 1024; // FFT size
+    static constexpr float WINDOW_GAIN = 2.0f; // Compensates the Hann window's coherent gain of 0.5
 
     // Peak tracking
     std::vector<float> peakHeights;
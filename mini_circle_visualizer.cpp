@@ -24,72 +24,48 @@ void MiniCircleVisualizer::initialize(int width, int height)
     Visualizer::initialize(128, 43);
 }
 
-void MiniCircleVisualizer::processAudioForFFT(const std::vector<float>& audioData, size_t position, double* fftInputBuffer) {
-    // Apply Hanning window and fill FFT input buffer
-    for (int i = 0; i < N; i++) {
-        if (position + i < audioData.size()) {
-            // Apply Hanning window to reduce spectral leakage
-            double window = 0.5 * (1.0 - cos(2.0 * M_PI * i / (N - 1)));
-            fftInputBuffer[i] = audioData[position + i] * window;
-        } else {
-            fftInputBuffer[i] = 0.0;
-        }
-    }
-}
-
-void MiniCircleVisualizer::renderFrame(const std::vector<float> &audioData,
-                                       double *fftInputBuffer,
-                                       fftw_complex *fftOutputBuffer,
-                                       fftw_plan &fftPlan,
+void MiniCircleVisualizer::renderFrame(const AnalysisFrame &analysis,
                                        float timeSeconds)
 {
-    // Calculate the sample index for the current time
-    size_t sampleIndex = static_cast<size_t>(timeSeconds * 44100); // Assuming 44.1kHz
+    // Mark unused parameters to silence compiler warnings
+    (void)timeSeconds;
 
-    if (sampleIndex >= audioData.size())
+    if (!analysis.primary().active)
         return;
 
-    // Process audio data for FFT
-    processAudioForFFT(audioData, sampleIndex, fftInputBuffer);
-
-    // Execute FFT
-    fftw_execute(fftPlan);
-
-    // Filter audio into frequency bands with adjusted scaling
-    std::vector<float> lowBand = filterBand(fftOutputBuffer, 0, (LOW_CUTOFF * N) / 44100, 1.0f);
-    std::vector<float> midBand = filterBand(fftOutputBuffer, (LOW_CUTOFF * N) / 44100, (MID_CUTOFF * N) / 44100, 2.0f);
-    std::vector<float> highBand = filterBand(fftOutputBuffer, (MID_CUTOFF * N) / 44100, (HIGH_CUTOFF * N) / 44100, 3.0f);
-
-    // Render each band as a circle
-    renderCircularBand(lowBand, LOW_RADIUS, THICKNESS * 1.5f, LOW_COLOR);
-    renderCircularBand(midBand, MID_RADIUS, THICKNESS * 1.5f, MID_COLOR);
-    renderCircularBand(highBand, HIGH_RADIUS, THICKNESS * 1.5f, HIGH_COLOR);
+    renderBands(analysis);
 }
 
-void MiniCircleVisualizer::renderLiveFrame(const std::vector<float> &audioData,
-                                            double *fftInputBuffer,
-                                            fftw_complex *fftOutputBuffer,
-                                            fftw_plan &fftPlan,
+void MiniCircleVisualizer::renderLiveFrame(const AnalysisFrame &analysis,
                                             size_t currentPosition)
 {
-    if (currentPosition >= audioData.size())
+    // Mark unused parameters to silence compiler warnings
+    (void)currentPosition;
+
+    if (!analysis.primary().active)
         return;
 
-    // Process audio data for FFT
-    processAudioForFFT(audioData, currentPosition, fftInputBuffer);
+    renderBands(analysis);
+}
 
-    // Execute FFT
-    fftw_execute(fftPlan);
+void MiniCircleVisualizer::renderBands(const AnalysisFrame &analysis)
+{
+    const SourceSpectrum &spectrum = analysis.primary();
+    const int lowBin = analysis.binForFrequency(LOW_CUTOFF);
+    const int midBin = analysis.binForFrequency(MID_CUTOFF);
+    const int highBin = analysis.binForFrequency(HIGH_CUTOFF);
 
     // Filter audio into frequency bands with adjusted scaling
-    std::vector<float> lowBand = filterBand(fftOutputBuffer, 0, (LOW_CUTOFF * N) / 44100, 1.0f);
-    std::vector<float> midBand = filterBand(fftOutputBuffer, (LOW_CUTOFF * N) / 44100, (MID_CUTOFF * N) / 44100, 2.0f);
-    std::vector<float> highBand = filterBand(fftOutputBuffer, (MID_CUTOFF * N) / 44100, (HIGH_CUTOFF * N) / 44100, 3.0f);
+    std::vector<float> lowBand = filterBand(spectrum, 0, lowBin, 1.0f);
+    std::vector<float> midBand = filterBand(spectrum, lowBin, midBin, 2.0f);
+    std::vector<float> highBand = filterBand(spectrum, midBin, highBin, 3.0f);
 
     // Render each band as a circle
     renderCircularBand(lowBand, LOW_RADIUS, THICKNESS * 1.5f, LOW_COLOR);
     renderCircularBand(midBand, MID_RADIUS, THICKNESS * 1.5f, MID_COLOR);
     renderCircularBand(highBand, HIGH_RADIUS, THICKNESS * 1.5f, HIGH_COLOR);
+
+    batch.flush();
 }
 
 void MiniCircleVisualizer::renderCircularBand(const std::vector<float> &bandData, float radius, float thickness, 
@@ -98,9 +74,9 @@ void MiniCircleVisualizer::renderCircularBand(const std::vector<float> &bandData
     const int numPoints = 100; // Number of points to draw the circle
     const float twoPi = 2.0f * M_PI;
 
-    glColor3fv(color);
-    glLineWidth(4.0f); // Doubled line width for mini version
-    glBegin(GL_LINE_STRIP);
+    batch.color(color);
+    batch.lineWidth(4.0f); // Doubled line width for mini version
+    batch.begin(GL_LINE_STRIP);
 
     for (int i = 0; i <= numPoints; i++)
     {
@@ -116,25 +92,24 @@ void MiniCircleVisualizer::renderCircularBand(const std::vector<float> &bandData
         float x = r * cos(angle);
         float y = r * sin(angle);
 
-        glVertex2f(x, y);
+        batch.vertex(x, y);
     }
 
-    glEnd();
-    glLineWidth(1.0f); // Reset line width
+    batch.end();
+    batch.lineWidth(1.0f); // Reset line width
 }
 
-std::vector<float> MiniCircleVisualizer::filterBand(fftw_complex *fftOutput, int startBin, int endBin, float bandScaling)
+std::vector<float> MiniCircleVisualizer::filterBand(const SourceSpectrum &spectrum, int startBin, int endBin, float bandScaling)
 {
+    const int lastBin = static_cast<int>(spectrum.magnitudes.size()) - 1;
     std::vector<float> bandData;
-    startBin = std::max(0, std::min(startBin, N / 2));
-    endBin = std::max(0, std::min(endBin, N / 2));
+    startBin = std::max(0, std::min(startBin, lastBin));
+    endBin = std::max(0, std::min(endBin, lastBin));
 
     // Process each FFT bin in the frequency range
     for (int i = startBin; i < endBin; i++)
     {
-        // Calculate magnitude
-        float magnitude = std::sqrt(fftOutput[i][0] * fftOutput[i][0] +
-                                    fftOutput[i][1] * fftOutput[i][1]);
+        float magnitude = spectrum.magnitudes[i];
 
         // Apply frequency-dependent scaling
         float freqScaling = std::pow(static_cast<float>(i) / (startBin + 1), 0.5f);
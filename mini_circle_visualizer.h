@@ -10,29 +10,22 @@ public:
 
     void initialize(int width, int height) override;
 
-    void renderFrame(const std::vector<float> &audioData,
-                     double *fftInputBuffer,
-                     fftw_complex *fftOutputBuffer,
-                     fftw_plan &fftPlan,
+    void renderFrame(const AnalysisFrame &analysis,
                      float timeSeconds) override;
 
-    void renderLiveFrame(const std::vector<float> &audioData,
-                         double *fftInputBuffer,
-                         fftw_complex *fftOutputBuffer,
-                         fftw_plan &fftPlan,
+    void renderLiveFrame(const AnalysisFrame &analysis,
                          size_t currentPosition) override;
 
 private:
     // Helper method to render a single circular band
     void renderCircularBand(const std::vector<float> &bandData, float radius, float thickness, const float *color);
 
-    // Helper method to filter audio data into frequency bands
-    std::vector<float> filterBand(fftw_complex *fftOutput, int startBin, int endBin, float bandScaling);
+    // Helper method to render all three bands of the primary source
+    void renderBands(const AnalysisFrame &analysis);
 
-    // Helper method to process audio data for FFT
-    void processAudioForFFT(const std::vector<float>& audioData, size_t position, double* fftInputBuffer);
+    // Helper method to filter audio data into frequency bands
+    std::vector<float> filterBand(const SourceSpectrum &spectrum, int startBin, int endBin, float bandScaling);
 
-    const int N = 1024;                       // FFT size
     static constexpr int LOW_CUTOFF = 250;    // 20-250 Hz
     static constexpr int MID_CUTOFF = 2000;   // 250-2000 Hz
     static constexpr int HIGH_CUTOFF = 20000; // 2000-20000 Hz
@@ -17,52 +17,23 @@ void MiniCubeVisualizer::initialize(int width, int height) {
     glDepthFunc(GL_LESS);
 }
 
-void MiniCubeVisualizer::renderFrame(const std::vector<float>& audioData,
-                               double* in,
-                               fftw_complex* out,
-                               fftw_plan& plan,
+void MiniCubeVisualizer::renderFrame(const AnalysisFrame& analysis,
                                float timeSeconds) {
-    // Process audio data for FFT
-    size_t numSamples = std::min(static_cast<size_t>(N), audioData.size());
-    for (size_t i = 0; i < numSamples; i++) {
-        // Apply Hanning window
-        double multiplier = 0.5 * (1 - cos(2 * M_PI * i / (N - 1)));
-        in[i] = audioData[i] * multiplier;
-    }
-    
-    // Execute FFT
-    fftw_execute(plan);
-    
-    std::vector<float> magnitudes = calculateMagnitudes(out);
+    std::vector<float> magnitudes = calculateMagnitudes(analysis.primary());
     render(timeSeconds, magnitudes);
 }
 
-void MiniCubeVisualizer::renderLiveFrame(const std::vector<float>& audioData,
-                                   double* in,
-                                   fftw_complex* out,
-                                   fftw_plan& plan,
+void MiniCubeVisualizer::renderLiveFrame(const AnalysisFrame& analysis,
                                    size_t currentPosition) {
-    // Process audio data for FFT
-    size_t numSamples = std::min(static_cast<size_t>(N), audioData.size());
-    for (size_t i = 0; i < numSamples; i++) {
-        size_t index = (currentPosition + i) % audioData.size();
-        // Apply Hanning window
-        double multiplier = 0.5 * (1 - cos(2 * M_PI * i / (N - 1)));
-        in[i] = audioData[index] * multiplier;
-    }
-    
-    // Execute FFT
-    fftw_execute(plan);
-    
-    float timeSeconds = static_cast<float>(currentPosition) / 44100.0f;
-    std::vector<float> magnitudes = calculateMagnitudes(out);
+    float timeSeconds = static_cast<float>(currentPosition) / analysis.sampleRate;
+    std::vector<float> magnitudes = calculateMagnitudes(analysis.primary());
     render(timeSeconds, magnitudes);
 }
 
-std::vector<float> MiniCubeVisualizer::calculateMagnitudes(fftw_complex* out) {
-    std::vector<float> magnitudes(N/2);
-    for (size_t i = 0; i < static_cast<size_t>(N/2); i++) {
-        magnitudes[i] = sqrt(out[i][0] * out[i][0] + out[i][1] * out[i][1]) / N;
+std::vector<float> MiniCubeVisualizer::calculateMagnitudes(const SourceSpectrum& spectrum) {
+    std::vector<float> magnitudes(spectrum.magnitudes.size() - 1);
+    for (size_t i = 0; i < magnitudes.size(); i++) {
+        magnitudes[i] = spectrum.magnitudes[i] / N;
     }
     return magnitudes;
 }
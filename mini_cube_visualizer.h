@@ -11,22 +11,16 @@ public:
 
     void initialize(int width, int height) override;
     
-    void renderFrame(const std::vector<float>& audioData,
-                    double* in,
-                    fftw_complex* out,
-                    fftw_plan& plan,
+    void renderFrame(const AnalysisFrame& analysis,
                     float timeSeconds) override;
                     
-    void renderLiveFrame(const std::vector<float>& audioData,
-                        double* in,
-                        fftw_complex* out,
-                        fftw_plan& plan,
+    void renderLiveFrame(const AnalysisFrame& analysis,
                         size_t currentPosition) override;
 
 private:
     void render(float time, const std::vector<float>& magnitudes);
     void drawCube(float rotationAngle, float scale);
-    std::vector<float> calculateMagnitudes(fftw_complex* out);
+    std::vector<float> calculateMagnitudes(const SourceSpectrum& spectrum);
     
     // Cube vertices (8 corners)
     static constexpr std::array<float, 24> vertices = {
@@ -64,6 +58,6 @@ private:
     
     float aspectRatio;
     float lastAmplitude = 0.0f;  // Store last amplitude for smoothing
-    const int N = 1024;  // FFT size for mini visualizer
+    const int N = 1024;  // Magnitude normalization for mini visualizer
 };
 
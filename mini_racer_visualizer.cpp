@@ -1,14 +1,9 @@
 #include "mini_racer_visualizer.h"
+#include "gl_math.h"
 #include <GL/glew.h>
 #include <cmath>
 #include <algorithm>
 
-#ifdef __APPLE__
-#include <OpenGL/glu.h>
-#else
-#include <GL/glu.h>
-#endif
-
 MiniRacerVisualizer::MiniRacerVisualizer() : audioAmplitude(0.0f), roadPosition(0.0f)
 {
     // Initialize road lines
@@ -64,22 +59,16 @@ void MiniRacerVisualizer::setupPerspectiveView()
 
     float aspect = static_cast<float>(screenWidth) / screenHeight;
 
-#ifdef __APPLE__
-#pragma clang diagnostic push
-#pragma clang diagnostic ignored "-Wdeprecated-declarations"
-#endif
-    gluPerspective(80.0f, aspect, 0.1f, 100.0f);
+    glLoadMatrixf(perspectiveMatrix(80.0f, aspect, 0.1f, 100.0f).data());
 
     glMatrixMode(GL_MODELVIEW);
     glLoadIdentity();
 
     // Position camera lower and closer to the road for a driver's perspective
-    gluLookAt(0.0f, 0.6f, 1.8f,  // Eye
-              0.0f, 0.1f, -5.0f, // Target
-              0.0f, 1.0f, 0.0f); // Up
-#ifdef __APPLE__
-#pragma clang diagnostic pop
-#endif
+    Mat4 view = lookAtMatrix({0.0f, 0.6f, 1.8f},  // Eye
+                             {0.0f, 0.1f, -5.0f}, // Target
+                             {0.0f, 1.0f, 0.0f}); // Up
+    glLoadMatrixf(view.data());
 }
 
 void MiniRacerVisualizer::updateRoad(float deltaTime)
@@ -197,25 +186,11 @@ void MiniRacerVisualizer::renderBuildings()
     glEnd();
 }
 
-float MiniRacerVisualizer::calculateAudioAmplitude(const std::vector<float> &audioData, size_t position)
+float MiniRacerVisualizer::calculateAudioAmplitude(const SourceSpectrum &spectrum)
 {
-    const size_t windowSize = 1024;
-    // Clamp the end so we don't read beyond the audioData
-    size_t end = std::min(position + windowSize, audioData.size());
-
-    float sum = 0.0f;
-    for (size_t i = position; i < end; i++)
-    {
-        sum += std::fabs(audioData[i]);
-    }
-
-    float average = 0.0f;
-    size_t count = end - position;
-    if (count > 0)
-        average = sum / static_cast<float>(count);
-
+    // The analysis level is the mean absolute sample over the block
     // Scale for dramatic effect but max out at 1.0
-    return std::min(1.0f, average * 4.0f);
+    return std::min(1.0f, spectrum.level * 4.0f);
 }
 
 void MiniRacerVisualizer::renderSun()
@@ -273,14 +248,11 @@ void MiniRacerVisualizer::renderSun()
     glPopMatrix();
 }
 
-void MiniRacerVisualizer::renderFrame(const std::vector<float> &audioData,
-                                      double * /* fftInputBuffer */,
-                                      fftw_complex * /* fftOutputBuffer */,
-                                      fftw_plan & /* fftPlan */,
+void MiniRacerVisualizer::renderFrame(const AnalysisFrame &analysis,
                                       float timeSeconds)
 {
-    size_t sampleIndex = static_cast<size_t>(timeSeconds * 44100);
-    audioAmplitude = calculateAudioAmplitude(audioData, sampleIndex);
+    (void)timeSeconds; // Animation is frame-driven
+    audioAmplitude = calculateAudioAmplitude(analysis.primary());
 
     // Move the road
     roadPosition = std::fmod(roadPosition + ROAD_SPEED, 1.0f);
@@ -305,13 +277,11 @@ void MiniRacerVisualizer::renderFrame(const std::vector<float> &audioData,
     glDisable(GL_BLEND);
 }
 
-void MiniRacerVisualizer::renderLiveFrame(const std::vector<float> &audioData,
-                                          double * /* fftInputBuffer */,
-                                          fftw_complex * /* fftOutputBuffer */,
-                                          fftw_plan & /* fftPlan */,
+void MiniRacerVisualizer::renderLiveFrame(const AnalysisFrame &analysis,
                                           size_t currentPosition)
 {
-    audioAmplitude = calculateAudioAmplitude(audioData, currentPosition);
+    (void)currentPosition; // Animation is frame-driven
+    audioAmplitude = calculateAudioAmplitude(analysis.primary());
     roadPosition = std::fmod(roadPosition + ROAD_SPEED, 1.0f);
 
     setupPerspectiveView();
@@ -11,18 +11,20 @@ public:
 
     void initialize(int width, int height) override;
 
-    void renderFrame(const std::vector<float> &audioData,
-                     double *fftInputBuffer,
-                     fftw_complex *fftOutputBuffer,
-                     fftw_plan &fftPlan,
+    void renderFrame(const AnalysisFrame &analysis,
                      float timeSeconds) override;
 
-    void renderLiveFrame(const std::vector<float> &audioData,
-                         double *fftInputBuffer,
-                         fftw_complex *fftOutputBuffer,
-                         fftw_plan &fftPlan,
+    void renderLiveFrame(const AnalysisFrame &analysis,
                          size_t currentPosition) override;
 
+    // Neon glow from the shared CRT pass; too small for scanlines
+    CRTSettings crtSettings() const override
+    {
+        CRTSettings settings;
+        settings.bloom = 0.8f;
+        return settings;
+    }
+
 private:
     static constexpr int NUM_ROAD_LINES = 30;      // More lines for smoother road
     static constexpr int NUM_BUILDINGS = 40;       // More buildings for better density
@@ -62,7 +64,7 @@ private:
     void renderRoad();
     void renderBuildings();
     void renderSun();
-    float calculateAudioAmplitude(const std::vector<float> &audioData, size_t position);
+    float calculateAudioAmplitude(const SourceSpectrum &spectrum);
     void setupPerspectiveView();
 
     static constexpr float ROAD_SPEED = 0.02f;
@@ -4,12 +4,6 @@
 
 MiniSpectrogram::MiniSpectrogram()
 {
-    // Initialize Hanning window
-    window.resize(N);
-    for (int i = 0; i < N; i++)
-    {
-        window[i] = 0.5f * (1.0f - std::cos(2.0f * M_PI * i / (N - 1)));
-    }
 }
 
 MiniSpectrogram::~MiniSpectrogram()
@@ -24,58 +18,39 @@ void MiniSpectrogram::initialize(int width, int height)
     Visualizer::initialize(128, 43);
 }
 
-void MiniSpectrogram::renderFrame(const std::vector<float> &audioData,
-                                  double *fftInputBuffer,
-                                  fftw_complex *fftOutputBuffer,
-                                  fftw_plan &fftPlan,
+void MiniSpectrogram::renderFrame(const AnalysisFrame &analysis,
                                   float timeSeconds)
 {
-    // Calculate the sample index for the current time
-    size_t sampleIndex = static_cast<size_t>(timeSeconds * 44100); // Assuming 44.1kHz
-    if (sampleIndex >= audioData.size())
-        return;
-
-    // Apply window function and copy to FFT input buffer
-    for (int i = 0; i < N && (sampleIndex + i) < audioData.size(); i++)
-    {
-        fftInputBuffer[i] = audioData[sampleIndex + i] * window[i];
-    }
+    // Mark unused parameters to silence compiler warnings
+    (void)timeSeconds;
 
-    // Perform FFT
-    fftw_execute(fftPlan);
+    // Nothing to draw once the audio has ended
+    if (!analysis.primary().active)
+        return;
 
     // Render the spectrum
-    renderSpectrum(fftOutputBuffer);
+    renderSpectrum(analysis.primary());
 }
 
-void MiniSpectrogram::renderLiveFrame(const std::vector<float> &audioData,
-                                      double *fftInputBuffer,
-                                      fftw_complex *fftOutputBuffer,
-                                      fftw_plan &fftPlan,
+void MiniSpectrogram::renderLiveFrame(const AnalysisFrame &analysis,
                                       size_t currentPosition)
 {
-    // Apply window function and copy to FFT input buffer
-    for (int i = 0; i < N && (currentPosition + i) < audioData.size(); i++)
-    {
-        fftInputBuffer[i] = audioData[currentPosition + i] * window[i];
-    }
-
-    // Perform FFT
-    fftw_execute(fftPlan);
+    // Mark unused parameters to silence compiler warnings
+    (void)currentPosition;
 
     // Render the spectrum
-    renderSpectrum(fftOutputBuffer);
+    renderSpectrum(analysis.primary());
 }
 
-void MiniSpectrogram::renderSpectrum(const fftw_complex *fftData)
+void MiniSpectrogram::renderSpectrum(const SourceSpectrum &spectrum)
 {
     // We only need the first N/2 + 1 points due to symmetry
-    const int numPoints = N / 2 + 1;
+    const int numPoints = static_cast<int>(spectrum.decibels.size());
 
     // Render as a line graph (peak only) in monochrome green
-    glColor3f(0.0f, 1.0f, 0.0f); // Bright green
-    glLineWidth(1.5f);
-    glBegin(GL_LINE_STRIP);
+    batch.color(0.0f, 1.0f, 0.0f); // Bright green
+    batch.lineWidth(1.5f);
+    batch.begin(GL_LINE_STRIP);
 
     // Calculate magnitudes and render spectrum line
     for (int i = 0; i < numPoints; i++)
@@ -83,19 +58,18 @@ void MiniSpectrogram::renderSpectrum(const fftw_complex *fftData)
         // Calculate frequency bin position
         float x = -1.0f + 2.0f * i / (float)(numPoints - 1);
 
-        // Calculate magnitude (using log scale for better visualization)
-        float re = fftData[i][0];
-        float im = fftData[i][1];
-        float magnitude = std::sqrt(re * re + im * im);
-        float dB = 20.0f * std::log10(magnitude + 1e-6f); // Add small value to avoid log(0)
+        // Use the log-scaled magnitude for better visualization
+        float dB = spectrum.decibels[i];
 
         // Normalize to [-1, 1] range
         float y = std::max(-1.0f, std::min(1.0f, dB / 60.0f)); // Assuming typical range of -60dB to 0dB
 
         // Add vertex for spectrum line
-        glVertex2f(x, y);
+        batch.vertex(x, y);
     }
 
-    glEnd();
-    glLineWidth(1.0f); // Reset line width
+    batch.end();
+    batch.lineWidth(1.0f); // Reset line width
+
+    batch.flush();
 }
@@ -12,22 +12,17 @@ public:
 
     void initialize(int width, int height) override;
 
-    void renderFrame(const std::vector<float> &audioData,
-                     double *fftInputBuffer,
-                     fftw_complex *fftOutputBuffer,
-                     fftw_plan &fftPlan,
+    void renderFrame(const AnalysisFrame &analysis,
                      float timeSeconds) override;
 
-    void renderLiveFrame(const std::vector<float> &audioData,
-                         double *fftInputBuffer,
-                         fftw_complex *fftOutputBuffer,
-                         fftw_plan &fftPlan,
+    void renderLiveFrame(const AnalysisFrame &analysis,
                          size_t currentPosition) override;
 
+    // Small inset view, coarse bins are plenty
+    int preferredFFTSize() const override { return 256; }
+
 private:
-    void renderSpectrum(const fftw_complex *fftData);
-    const int N = 1024;        // FFT size
-    std::vector<float> window; // Hanning window for better frequency resolution
+    void renderSpectrum(const SourceSpectrum &spectrum);
 };
 
 #endif // MINI_SPECTROGRAM_H
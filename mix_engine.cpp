@@ -0,0 +1,87 @@
+#include "mix_engine.h"
+#include <algorithm>
+
+// Accumulate one source into all three outputs. Written as a plain loop over
+// restrict pointers so the compiler vectorizes it.
+static void accumulate(const float *__restrict samples, size_t count,
+                       float monoGain, float leftGain, float rightGain,
+                       float *__restrict mono, float *__restrict left, float *__restrict right)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        float sample = samples[i];
+        mono[i] += sample * monoGain;
+        left[i] += sample * leftGain;
+        right[i] += sample * rightGain;
+    }
+}
+
+void MixEngine::setSources(const AudioSourceList &newSources)
+{
+    sources = newSources;
+    gains.assign(sources.size(), 1.0f);
+    pans.assign(sources.size(), 0.0f);
+    views.resize(sources.size());
+    fetchStorage.resize(sources.size());
+    decoded.resize(sources.size());
+    cacheValid = false;
+}
+
+void MixEngine::setGain(size_t index, float gain)
+{
+    if (index >= gains.size())
+        return;
+    gains[index] = gain;
+    cacheValid = false;
+}
+
+void MixEngine::setPan(size_t index, float pan)
+{
+    if (index >= pans.size())
+        return;
+    pans[index] = std::max(-1.0f, std::min(1.0f, pan));
+    cacheValid = false;
+}
+
+const MixBlock &MixEngine::mix(size_t position, size_t frames)
+{
+    if (cacheValid && block.position == position && block.frames == frames)
+        return block;
+
+    block.position = position;
+    block.frames = frames;
+    block.mono.assign(frames, 0.0f);
+    block.left.assign(frames, 0.0f);
+    block.right.assign(frames, 0.0f);
+    block.sources.resize(sources.size());
+
+    // Equal weighting (1/number of sources), folded into the per-source gain
+    const float weight = sources.empty() ? 0.0f : 1.0f / static_cast<float>(sources.size());
+
+    for (size_t s = 0; s < sources.size(); s++)
+    {
+        views[s] = sources[s]->fetch(position, frames, fetchStorage[s]);
+        const AudioView &samples = views[s];
+
+        // Mapped mono float files are mixed in place; everything else is
+        // decoded to float once per block
+        const float *data = samples.available() == frames ? samples.floatData() : nullptr;
+        if (!data)
+        {
+            decoded[s].resize(frames);
+            samples.copyTo(decoded[s].data());
+            data = decoded[s].data();
+        }
+        block.sources[s] = data;
+
+        // Past the end of a shorter source there is nothing to add
+        const float gain = gains[s] * weight;
+        const float leftGain = gain * std::min(1.0f, 1.0f - pans[s]);
+        const float rightGain = gain * std::min(1.0f, 1.0f + pans[s]);
+        accumulate(data, samples.available(), gain, leftGain, rightGain,
+                   block.mono.data(), block.left.data(), block.right.data());
+    }
+
+    cacheValid = true;
+    return block;
+}
@@ -0,0 +1,54 @@
+#ifndef MIX_ENGINE_H
+#define MIX_ENGINE_H
+
+#include "audio_source.h"
+#include <cstddef>
+#include <vector>
+
+// One mixed block of output, plus the per-source samples it was made from
+struct MixBlock
+{
+    size_t position = 0; // Sample index of the first frame
+    size_t frames = 0;
+    std::vector<float> mono;
+    std::vector<float> left;
+    std::vector<float> right;
+    std::vector<const float *> sources; // Per-source samples before gain, silent past the end
+};
+
+// Mixes every source into mono and stereo output in a single pass over the
+// sources, with per-source gain and pan. The last block is cached, so
+// consumers asking for the same range share one mix. Not thread-safe; each
+// mode drives it from one thread.
+class MixEngine
+{
+public:
+    // Replaces the sources and resets every gain and pan
+    void setSources(const AudioSourceList &sources);
+    const AudioSourceList &getSources() const { return sources; }
+
+    // Linear gain, on top of the equal 1/N weighting between sources
+    void setGain(size_t index, float gain);
+
+    // -1 is hard left, 1 is hard right. Balance law: the far side is faded
+    // out and the near side stays at full level, so centred sources mix
+    // exactly as in mono.
+    void setPan(size_t index, float pan);
+
+    // Mix frames samples starting at position. The result stays valid until
+    // the next call with a different range or a settings change.
+    const MixBlock &mix(size_t position, size_t frames);
+
+private:
+    AudioSourceList sources;
+    std::vector<float> gains;
+    std::vector<float> pans;
+
+    MixBlock block;
+    bool cacheValid = false;
+    std::vector<AudioView> views;                 // Per source, keeps zero-copy samples alive
+    std::vector<std::vector<float>> fetchStorage; // Per source, backs non-view fetches
+    std::vector<std::vector<float>> decoded;      // Per source, mono float copies of the block
+};
+
+#endif // MIX_ENGINE_H
@@ -10,20 +10,11 @@ public:
     MultiBandCircleWaveform();
     ~MultiBandCircleWaveform() override;
 
-    // Add method to set multiple audio sources
-    void setAudioSources(const std::vector<std::vector<float>>& sources);
-
     // Implement the base class methods
-    void renderFrame(const std::vector<float> &audioData,
-                     double *fftInputBuffer,
-                     fftw_complex *fftOutputBuffer,
-                     fftw_plan &fftPlan,
+    void renderFrame(const AnalysisFrame &analysis,
                      float timeSeconds) override;
 
-    void renderLiveFrame(const std::vector<float> &audioData,
-                         double *fftInputBuffer,
-                         fftw_complex *fftOutputBuffer,
-                         fftw_plan &fftPlan,
+    void renderLiveFrame(const AnalysisFrame &analysis,
                          size_t currentPosition) override;
 
 private:
@@ -31,16 +22,15 @@ private:
     void renderCircularBand(const std::vector<float> &bandData, float radius, float thickness, const float *color, 
                           float xOffset, float yOffset, float scale);
 
+    // Helper method to render one grid cell per audio source
+    void renderSources(const AnalysisFrame &analysis);
+
     // Helper method to filter audio data into frequency bands
-    std::vector<float> filterBand(fftw_complex *fftOutput, int startBin, int endBin, float bandScaling);
+    std::vector<float> filterBand(const SourceSpectrum &spectrum, int startBin, int endBin, float bandScaling);
 
     // Helper method to calculate grid dimensions
     void calculateGridDimensions(int numSources, int& rows, int& cols) const;
 
-    // Helper method to process audio data for FFT
-    void processAudioForFFT(const std::vector<float>& audioData, size_t position, double* fftInputBuffer);
-
-    const int N = 1024;                       // FFT size
     static constexpr int LOW_CUTOFF = 250;    // 20-250 Hz
     static constexpr int MID_CUTOFF = 2000;   // 250-2000 Hz
     static constexpr int HIGH_CUTOFF = 20000; // 2000-20000 Hz
@@ -55,9 +45,6 @@ private:
     static constexpr float MID_RADIUS = 0.5f;
     static constexpr float HIGH_RADIUS = 0.8f;
     static constexpr float THICKNESS = 0.15f;
-
-    // Store multiple audio sources
-    std::vector<std::vector<float>> audioSources;
 };
 
 #endif // MULTI_BAND_CIRCLE_WAVEFORM_H
\ No newline at end of file
@@ -15,10 +15,6 @@ MultiBandWaveform::~MultiBandWaveform()
 {
 }
 
-void MultiBandWaveform::setAudioSources(const std::vector<std::vector<float>>& sources) {
-    audioSources = sources;
-}
-
 void MultiBandWaveform::calculateGridDimensions(int numSources, int& rows, int& cols) const {
     if (numSources <= 1) {
         rows = 1;
@@ -38,116 +34,44 @@ void MultiBandWaveform::calculateGridDimensions(int numSources, int& rows, int&
     }
 }
 
-void MultiBandWaveform::processAudioForFFT(const std::vector<float>& audioData, size_t position, double* fftInputBuffer) {
-    // Apply Hanning window and fill FFT input buffer
-    for (int i = 0; i < N; i++) {
-        if (position + i < audioData.size()) {
-            // Apply Hanning window to reduce spectral leakage
-            double window = 0.5 * (1.0 - cos(2.0 * M_PI * i / (N - 1)));
-            fftInputBuffer[i] = audioData[position + i] * window;
-        } else {
-            fftInputBuffer[i] = 0.0;
-        }
-    }
-}
-
-void MultiBandWaveform::renderFrame(const std::vector<float> &audioData,
-                                    double *fftInputBuffer,
-                                    fftw_complex *fftOutputBuffer,
-                                    fftw_plan &fftPlan,
+void MultiBandWaveform::renderFrame(const AnalysisFrame &analysis,
                                     float timeSeconds)
 {
-    // Calculate the sample index for the current time
-    size_t sampleIndex = static_cast<size_t>(timeSeconds * 44100); // Assuming 44.1kHz
-
-    // Calculate grid dimensions
-    int rows, cols;
-    calculateGridDimensions(audioSources.empty() ? 1 : audioSources.size(), rows, cols);
-
-    // Calculate cell dimensions
-    float cellWidth = 2.0f / cols;
-    float cellHeight = 2.0f / rows;
-
-    // Process each audio source
-    for (size_t sourceIdx = 0; sourceIdx < (audioSources.empty() ? 1 : audioSources.size()); sourceIdx++) {
-        const auto& source = audioSources.empty() ? audioData : audioSources[sourceIdx];
-        
-        if (sampleIndex >= source.size())
-            continue;
-
-        // Calculate grid position
-        int row = sourceIdx / cols;
-        int col = sourceIdx % cols;
-
-        // Calculate cell boundaries with padding
-        float padding = 0.02f;
-        float x1 = -1.0f + col * cellWidth + padding;
-        float y1 = 1.0f - (row + 1) * cellHeight + padding;
-        float x2 = x1 + cellWidth - 2 * padding;
-        float y2 = y1 + cellHeight - 2 * padding;
-        float cellCenterY = (y1 + y2) / 2.0f;
-        float effectiveHeight = (y2 - y1) / 3.0f; // Divide height by 3 for the three bands
+    // Mark unused parameters to silence compiler warnings
+    (void)timeSeconds;
 
-        // Process audio data for FFT
-        processAudioForFFT(source, sampleIndex, fftInputBuffer);
-
-        // Execute FFT
-        fftw_execute(fftPlan);
-
-        // Calculate frequency bin indices for cutoff frequencies
-        const int lowBin = LOW_CUTOFF * N / 44100;
-        const int midBin = MID_CUTOFF * N / 44100;
-        const int highBin = HIGH_CUTOFF * N / 44100;
-
-        // Filter and render each band
-        std::vector<float> lowBand = filterBand(fftOutputBuffer, 0, lowBin);
-        std::vector<float> midBand = filterBand(fftOutputBuffer, lowBin, midBin);
-        std::vector<float> highBand = filterBand(fftOutputBuffer, midBin, highBin);
-
-        // Apply band-specific scaling factors
-        float lowScale = 2.0f;  // Boost low frequencies
-        float midScale = 1.5f;  // Moderate boost for mids
-        float highScale = 1.0f; // Normal scale for highs
+    renderSources(analysis);
+}
 
-        float cellWidth = x2 - x1;
-        
-        // Render bands in their respective positions with bipolar display
-        renderBand(lowBand, cellCenterY - effectiveHeight, effectiveHeight * lowScale, x1, cellWidth, LOW_COLOR);
-        renderBand(midBand, cellCenterY, effectiveHeight * midScale, x1, cellWidth, MID_COLOR);
-        renderBand(highBand, cellCenterY + effectiveHeight, effectiveHeight * highScale, x1, cellWidth, HIGH_COLOR);
+void MultiBandWaveform::renderLiveFrame(const AnalysisFrame &analysis,
+                                        size_t currentPosition)
+{
+    // Mark unused parameters to silence compiler warnings
+    (void)currentPosition;
 
-        // Draw cell border
-        glLineWidth(1.0f);
-        glColor3f(0.3f, 0.3f, 0.3f);
-        glBegin(GL_LINE_LOOP);
-        glVertex2f(x1 - padding, y1 - padding);
-        glVertex2f(x2 + padding, y1 - padding);
-        glVertex2f(x2 + padding, y2 + padding);
-        glVertex2f(x1 - padding, y2 + padding);
-        glEnd();
-    }
+    renderSources(analysis);
 }
 
-void MultiBandWaveform::renderLiveFrame(const std::vector<float> &audioData,
-                                        double *fftInputBuffer,
-                                        fftw_complex *fftOutputBuffer,
-                                        fftw_plan &fftPlan,
-                                        size_t currentPosition)
+void MultiBandWaveform::renderSources(const AnalysisFrame &analysis)
 {
-    // Similar to renderFrame but using currentPosition
     // Calculate grid dimensions
     int rows, cols;
-    calculateGridDimensions(audioSources.empty() ? 1 : audioSources.size(), rows, cols);
+    calculateGridDimensions(analysis.sources.size(), rows, cols);
 
     // Calculate cell dimensions
     float cellWidth = 2.0f / cols;
     float cellHeight = 2.0f / rows;
 
+    // Calculate frequency bin indices for cutoff frequencies
+    const int lowBin = analysis.binForFrequency(LOW_CUTOFF);
+    const int midBin = analysis.binForFrequency(MID_CUTOFF);
+    const int highBin = analysis.binForFrequency(HIGH_CUTOFF);
+
     // Process each audio source
-    for (size_t sourceIdx = 0; sourceIdx < (audioSources.empty() ? 1 : audioSources.size()); sourceIdx++) {
-        const auto& source = audioSources.empty() ? audioData : audioSources[sourceIdx];
-        
-        if (currentPosition >= source.size())
+    for (size_t sourceIdx = 0; sourceIdx < analysis.sources.size(); sourceIdx++) {
+        const SourceSpectrum &spectrum = analysis.sources[sourceIdx];
+
+        if (!spectrum.active)
             continue;
 
         // Calculate grid position
@@ -163,21 +87,10 @@ void MultiBandWaveform::renderLiveFrame(const std::vector<float> &audioData,
         float cellCenterY = (y1 + y2) / 2.0f;
         float effectiveHeight = (y2 - y1) / 3.0f; // Divide height by 3 for the three bands
 
-        // Process audio data for FFT
-        processAudioForFFT(source, currentPosition, fftInputBuffer);
-
-        // Execute FFT
-        fftw_execute(fftPlan);
-
-        // Calculate frequency bin indices for cutoff frequencies
-        const int lowBin = LOW_CUTOFF * N / 44100;
-        const int midBin = MID_CUTOFF * N / 44100;
-        const int highBin = HIGH_CUTOFF * N / 44100;
-
         // Filter and render each band
-        std::vector<float> lowBand = filterBand(fftOutputBuffer, 0, lowBin);
-        std::vector<float> midBand = filterBand(fftOutputBuffer, lowBin, midBin);
-        std::vector<float> highBand = filterBand(fftOutputBuffer, midBin, highBin);
+        std::vector<float> lowBand = filterBand(spectrum, 0, lowBin);
+        std::vector<float> midBand = filterBand(spectrum, lowBin, midBin);
+        std::vector<float> highBand = filterBand(spectrum, midBin, highBin);
 
         // Apply band-specific scaling factors
         float lowScale = 2.0f;  // Boost low frequencies
@@ -192,26 +105,28 @@ void MultiBandWaveform::renderLiveFrame(const std::vector<float> &audioData,
         renderBand(highBand, cellCenterY + effectiveHeight, effectiveHeight * highScale, x1, cellWidth, HIGH_COLOR);
 
         // Draw cell border
-        glLineWidth(1.0f);
-        glColor3f(0.3f, 0.3f, 0.3f);
-        glBegin(GL_LINE_LOOP);
-        glVertex2f(x1 - padding, y1 - padding);
-        glVertex2f(x2 + padding, y1 - padding);
-        glVertex2f(x2 + padding, y2 + padding);
-        glVertex2f(x1 - padding, y2 + padding);
-        glEnd();
+        batch.lineWidth(1.0f);
+        batch.color(0.3f, 0.3f, 0.3f);
+        batch.begin(GL_LINE_LOOP);
+        batch.vertex(x1 - padding, y1 - padding);
+        batch.vertex(x2 + padding, y1 - padding);
+        batch.vertex(x2 + padding, y2 + padding);
+        batch.vertex(x1 - padding, y2 + padding);
+        batch.end();
     }
+
+    batch.flush();
 }
 
 void MultiBandWaveform::renderBand(const std::vector<float> &bandData, float yOffset, float height, float xOffset, float width, const float *color)
 {
-    glColor3fv(color);
+    batch.color(color);
 
     // Set line thickness to 5 pixels
-    glLineWidth(5.0f);
+    batch.lineWidth(5.0f);
 
     // Draw the waveform
-    glBegin(GL_LINE_STRIP);
+    batch.begin(GL_LINE_STRIP);
 
     // Use 200 points across the screen for smooth rendering
     const int numPoints = 200;
@@ -237,16 +152,18 @@ void MultiBandWaveform::renderBand(const std::vector<float> &bandData, float yOf
         float avgAmplitude = count > 0 ? (sum / count) : 0.0f;
         float y = yOffset + (avgAmplitude * 2.0f - 1.0f) * height;
 
-        glVertex2f(x, y);
+        batch.vertex(x, y);
     }
-    glEnd();
+    batch.end();
 
     // Reset line width to default (1.0)
-    glLineWidth(1.0f);
+    batch.lineWidth(1.0f);
 }
 
-std::vector<float> MultiBandWaveform::filterBand(fftw_complex *fftOutput, int startBin, int endBin)
+std::vector<float> MultiBandWaveform::filterBand(const SourceSpectrum &spectrum, int startBin, int endBin)
 {
+    const int lastBin = static_cast<int>(spectrum.logMagnitudes.size()) - 1;
+
     // Create a fixed-size output array for consistent width display
     const int outputSize = 200; // Match the number of points we use for rendering
     std::vector<float> bandData(outputSize, 0.0f);
@@ -269,14 +186,10 @@ std::vector<float> MultiBandWaveform::filterBand(fftw_complex *fftOutput, int st
         float sum = 0.0f;
         float weight = 0.0f;
 
-        for (int bin = binStart; bin < binEnd && bin < N / 2; bin++)
+        for (int bin = binStart; bin < binEnd && bin < lastBin; bin++)
         {
-            // Calculate magnitude
-            float magnitude = std::sqrt(fftOutput[bin][0] * fftOutput[bin][0] +
-                                        fftOutput[bin][1] * fftOutput[bin][1]);
-
-            // Apply logarithmic scaling
-            magnitude = magnitude > 0 ? std::log10(1 + magnitude) : 0;
+            // Logarithmically scaled magnitude
+            float magnitude = spectrum.logMagnitudes[bin];
 
             // Calculate the weight for this bin (handle partial bins at boundaries)
             float binWeight = 1.0f;
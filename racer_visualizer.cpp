@@ -1,53 +1,127 @@
 #include "racer_visualizer.h"
+#include "gl_math.h"
 #include <GL/glew.h>
 #include <cmath>
 #include <algorithm>
 
-#ifdef __APPLE__
-#include <OpenGL/glu.h>
-#else
-#include <GL/glu.h>
-#endif
+// Grid lines slide from the far end towards the camera and wrap; the
+// road edges stay put
+static const char *ROAD_VERTEX_SHADER = R"(#version 120
+CAMERA_UNIFORMS
+uniform float scroll;
+uniform float nearZ;
+uniform float farZ;
+uniform float nearWidth;
+uniform float farWidth;
+attribute vec3 roadVertex; // Side, distance along the road from 0 near to 1 far, 1 if it scrolls
+
+void main()
+{
+    float along = roadVertex.y;
+    if (roadVertex.z > 0.5)
+        along = fract(along - scroll);
+    float width = mix(nearWidth, farWidth, along);
+    gl_Position = viewProjection * vec4(roadVertex.x * width, 0.0, mix(nearZ, farZ, along), 1.0);
+}
+)";
+
+// One unit box per building, placed beside the road at the building's
+// scrolled slot and stretched to its wave height
+static const char *BUILDING_VERTEX_SHADER = R"(#version 120
+CAMERA_UNIFORMS
+uniform float scroll;
+uniform float wavePhase;
+uniform float amplitude;
+uniform float nearZ;
+uniform float farZ;
+uniform float nearWidth;
+uniform float farWidth;
+uniform float buildingHeight;
+uniform float buildingOffset;
+uniform float buildingWidth;
+uniform float sineFrequency;
+attribute vec3 boxVertex;
+attribute float slot;
+attribute float side;
+attribute float heightScale;
+
+void main()
+{
+    float z = farZ + mod(slot - farZ + scroll, nearZ - farZ);
+    float roadWidth = mix(nearWidth, farWidth, (z - nearZ) / (farZ - nearZ));
+    float wave = sin(z * sineFrequency + wavePhase) * amplitude;
+    float height = buildingHeight * heightScale * (1.0 + wave * 1.5);
+
+    vec3 position = vec3(side * (roadWidth + buildingOffset + boxVertex.x * buildingWidth),
+                         boxVertex.y * height,
+                         z + (boxVertex.z - 0.5) * buildingWidth);
+    gl_Position = viewProjection * vec4(position, 1.0);
+}
+)";
 
-RacerVisualizer::RacerVisualizer() : audioAmplitude(0.0f), roadPosition(0.0f)
+static const char *FLAT_FRAGMENT_SHADER = R"(#version 120
+uniform vec3 color;
+
+void main()
 {
-    // Initialize road lines
-    roadLines.resize(NUM_ROAD_LINES);
-    float spacing = 2.0f / NUM_ROAD_LINES;
-    for (int i = 0; i < NUM_ROAD_LINES; i++)
-    {
-        roadLines[i] = -1.0f + i * spacing;
-    }
+    gl_FragColor = vec4(color, 1.0);
+}
+)";
+
+// The sun's gradient and rays, colored per vertex
+static const char *SUN_VERTEX_SHADER = R"(#version 120
+CAMERA_UNIFORMS
+attribute vec3 sunVertex;
+attribute vec4 sunColor;
+varying vec4 color;
+
+void main()
+{
+    color = sunColor;
+    gl_Position = viewProjection * vec4(sunVertex, 1.0);
+}
+)";
 
+static const char *SUN_FRAGMENT_SHADER = R"(#version 120
+varying vec4 color;
+
+void main()
+{
+    gl_FragColor = color;
+}
+)";
+
+RacerVisualizer::RacerVisualizer() : audioAmplitude(0.0f), roadPosition(0.0f), roadScroll(0.0f), cityScroll(0.0f)
+{
     // Initialize buildings
     for (int i = 0; i < NUM_BUILDINGS; i++)
     {
         // Distribute buildings from far to near
-        float z = -5.0f + (8.0f * i / NUM_BUILDINGS); // From -5 to 3
-
-        // Calculate width at this z position (linear interpolation)
-        float t = (z - 3.0f) / (-5.0f - 3.0f);
-        float roadWidthAtZ = ROAD_WIDTH * 2.5f * (1.0f - t) + ROAD_WIDTH * 0.9f * t;
+        float z = FAR_Z + ((NEAR_Z - FAR_Z) * i / NUM_BUILDINGS);
 
         // Add some random variation to building height
         float heightVariation = 0.8f + (rand() % 100) / 100.0f * 0.4f;
 
-        // Position buildings *outside* the road edges (add offset)
-        float buildingOffset = 0.2f;
-
-        // Left building - position outside road edge
-        leftBuildings.push_back({BUILDING_HEIGHT * heightVariation,
-                                 -(roadWidthAtZ + buildingOffset), // Offset from road edge
-                                 z});
-
-        // Right building - position outside road edge
-        rightBuildings.push_back({BUILDING_HEIGHT * heightVariation,
-                                  (roadWidthAtZ + buildingOffset), // Offset from road edge
-                                  z});
+        // A building on each side of the road
+        for (float side : {-1.0f, 1.0f})
+        {
+            buildingSlots.push_back(z);
+            buildingSides.push_back(side);
+            buildingScales.push_back(heightVariation);
+        }
     }
 }
 
-RacerVisualizer::~RacerVisualizer() {}
+RacerVisualizer::~RacerVisualizer()
+{
+    for (GLuint buffer : {roadVbo, boxVbo, buildingVbo, sunVbo})
+    {
+        if (buffer)
+        {
+            glDeleteBuffers(1, &buffer);
+        }
+    }
+}
 
 void RacerVisualizer::initialize(int width, int height)
 {
@@ -56,228 +130,233 @@ void RacerVisualizer::initialize(int width, int height)
 
 void RacerVisualizer::setupPerspectiveView()
 {
-    glMatrixMode(GL_PROJECTION);
-    glLoadIdentity();
-
     float aspect = static_cast<float>(screenWidth) / screenHeight;
-
-#ifdef __APPLE__
-#pragma clang diagnostic push
-#pragma clang diagnostic ignored "-Wdeprecated-declarations"
-#endif
-    gluPerspective(80.0f, aspect, 0.1f, 100.0f);
-
-    glMatrixMode(GL_MODELVIEW);
-    glLoadIdentity();
+    Mat4 projection = perspectiveMatrix(80.0f, aspect, 0.1f, 100.0f);
 
     // Position camera lower and closer to the road for a driver's perspective
-    gluLookAt(0.0f, 0.6f, 1.8f,  // Eye
-              0.0f, 0.1f, -5.0f, // Target
-              0.0f, 1.0f, 0.0f); // Up
-#ifdef __APPLE__
-#pragma clang diagnostic pop
-#endif
+    Mat4 view = lookAtMatrix({0.0f, 0.6f, 1.8f},  // Eye
+                             {0.0f, 0.1f, -5.0f}, // Target
+                             {0.0f, 1.0f, 0.0f}); // Up
+    camera.set(projection * view);
 }
 
 void RacerVisualizer::updateRoad(float deltaTime)
 {
-    for (float &z : roadLines)
-    {
-        z -= deltaTime * MOVE_SPEED;
-        if (z < -1.0f)
-            z = 1.0f;
-    }
+    // Grid lines cross the whole road every 2 / MOVE_SPEED seconds
+    roadScroll = std::fmod(roadScroll + deltaTime * MOVE_SPEED * 0.5f, 1.0f);
 }
 
 void RacerVisualizer::updateBuildings(float deltaTime)
 {
-    // We'll reuse the same calculations but remove redundant computations
-    const float zRange = (-5.0f - 3.0f); // -8.0f
-    float move = deltaTime * MOVE_SPEED;
+    cityScroll = std::fmod(cityScroll + deltaTime * MOVE_SPEED, NEAR_Z - FAR_Z);
+}
 
-    // Left buildings
-    for (auto &building : leftBuildings)
+void RacerVisualizer::createBuffers()
+{
+    // Road edges from the near end to the far end, then the grid lines,
+    // each vertex being (side, distance along the road, scrolls)
+    std::vector<float> roadVertices = {-1.0f, 0.0f, 0.0f, -1.0f, 1.0f, 0.0f,
+                               1.0f, 0.0f, 0.0f, 1.0f, 1.0f, 0.0f};
+    for (int i = 0; i < NUM_ROAD_LINES; i++)
     {
-        building.zPos += move;
-        if (building.zPos > 3.0f)
+        float along = static_cast<float>(i) / NUM_ROAD_LINES;
+        roadVertices.insert(roadVertices.end(), {-1.0f, along, 1.0f, 1.0f, along, 1.0f});
+    }
+
+    // Edges of a box from (0, 0, 0) to (1, 1, 1)
+    std::vector<float> boxVertices;
+    for (int axis = 0; axis < 3; axis++)
+    {
+        for (int corner = 0; corner < 4; corner++)
         {
-            // Wrap to far point
-            building.zPos = -5.0f;
+            float start[3];
+            start[axis] = 0.0f;
+            start[(axis + 1) % 3] = static_cast<float>(corner & 1);
+            start[(axis + 2) % 3] = static_cast<float>(corner >> 1);
+            boxVertices.insert(boxVertices.end(), start, start + 3);
+            start[axis] = 1.0f;
+            boxVertices.insert(boxVertices.end(), start, start + 3);
         }
+    }
 
-        // Interpolate road width
-        float t = (building.zPos - 3.0f) / zRange;
-        float roadWidthAtZ = ROAD_WIDTH * 2.5f * (1.0f - t) + ROAD_WIDTH * 0.9f * t;
-
-        // Audio-based sine wave
-        float wave = std::sin(building.zPos * SINE_FREQ + roadPosition) * audioAmplitude;
-        building.height = BUILDING_HEIGHT * (1.0f + wave * 1.5f);
+    std::vector<float> buildingFields = buildingSlots;
+    buildingFields.insert(buildingFields.end(), buildingSides.begin(), buildingSides.end());
+    buildingFields.insert(buildingFields.end(), buildingScales.begin(), buildingScales.end());
 
-        // Position the building
-        building.xPos = -(roadWidthAtZ + 0.2f);
+    // The sun stands at the far end of the road on the horizon: a half
+    // disc from the inner color at its center to the outer at the rim,
+    // then rays around it. Each vertex is x, y, z, r, g, b, a.
+    std::vector<float> sunVertices;
+    auto sunVertex = [&](float x, float y, const float color[3], float alpha)
+    {
+        sunVertices.insert(sunVertices.end(), {x, SUN_Y_POS + y, SUN_Z_POS, color[0], color[1], color[2], alpha});
+    };
+    sunVertex(0.0f, 0.0f, SUN_INNER_COLOR, 1.0f);
+    for (int i = 0; i <= SUN_SEGMENTS; i++)
+    {
+        float angle = M_PI * i / SUN_SEGMENTS;
+        float x = SUN_RADIUS * std::cos(angle) * 1.25f;
+        float y = SUN_RADIUS * std::sin(angle) * 1.25f;
+        if (y >= 0.0f)
+        {
+            sunVertex(x, y, SUN_OUTER_COLOR, 1.0f);
+        }
     }
+    sunFanVertices = static_cast<GLsizei>(sunVertices.size() / 7);
 
-    // Right buildings
-    for (auto &building : rightBuildings)
+    const float rayColor[3] = {1.0f, 0.4f, 0.8f};
+    for (int i = 0; i < 12; i++)
     {
-        building.zPos += move;
-        if (building.zPos > 3.0f)
+        float angle = M_PI * i / 11;
+        if (std::sin(angle) >= 0.0f)
         {
-            // Wrap to far point
-            building.zPos = -5.0f;
+            float x = SUN_RADIUS * std::cos(angle) * 1.25f;
+            float y = SUN_RADIUS * std::sin(angle) * 1.25f;
+            sunVertex(x, y, rayColor, 0.5f);
+            sunVertex(x * 1.3f, y * 1.3f, rayColor, 0.5f);
         }
+    }
+    sunRayVertices = static_cast<GLsizei>(sunVertices.size() / 7) - sunFanVertices;
 
-        float t = (building.zPos - 3.0f) / zRange;
-        float roadWidthAtZ = ROAD_WIDTH * 2.5f * (1.0f - t) + ROAD_WIDTH * 0.9f * t;
-
-        float wave = std::sin(building.zPos * SINE_FREQ + roadPosition) * audioAmplitude;
-        building.height = BUILDING_HEIGHT * (1.0f + wave * 1.5f);
+    GLuint *buffers[] = {&roadVbo, &boxVbo, &buildingVbo, &sunVbo};
+    const std::vector<float> *contents[] = {&roadVertices, &boxVertices, &buildingFields, &sunVertices};
+    for (int i = 0; i < 4; i++)
+    {
+        glGenBuffers(1, buffers[i]);
+        glBindBuffer(GL_ARRAY_BUFFER, *buffers[i]);
+        glBufferData(GL_ARRAY_BUFFER, contents[i]->size() * sizeof(float), contents[i]->data(), GL_STATIC_DRAW);
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
 
-        building.xPos = (roadWidthAtZ + 0.2f);
+    road.attribute(0, roadVbo, 3);
+    buildings.attribute(0, boxVbo, 3);
+    if (VertexArray::instancing())
+    {
+        // The building arrays follow one another in the buffer, one value
+        // per instance
+        const size_t count = buildingSlots.size();
+        for (GLuint field = 0; field < 3; field++)
+        {
+            buildings.attribute(field + 1, buildingVbo, 1, 0, field * count * sizeof(float), 1);
+        }
     }
+    const GLsizei sunStride = 7 * sizeof(float);
+    sun.attribute(0, sunVbo, 3, sunStride, 0);
+    sun.attribute(1, sunVbo, 4, sunStride, 3 * sizeof(float));
 }
 
 void RacerVisualizer::renderRoad()
 {
-    glLineWidth(2.0f);
+    if (!roadShader.build(ROAD_VERTEX_SHADER, FLAT_FRAGMENT_SHADER, {"roadVertex"}))
+        return;
 
-    float nearZ = 3.0f;
-    float farZ = -5.0f;
-    float nearWidth = ROAD_WIDTH * 2.5f;
-    float farWidth = ROAD_WIDTH * 0.9f;
+    roadShader.use();
+    camera.apply(roadShader);
+    ShaderProgram::set(roadShader.uniform("scroll"), roadScroll);
+    ShaderProgram::set(roadShader.uniform("nearZ"), NEAR_Z);
+    ShaderProgram::set(roadShader.uniform("farZ"), FAR_Z);
+    ShaderProgram::set(roadShader.uniform("nearWidth"), ROAD_WIDTH * 2.5f);
+    ShaderProgram::set(roadShader.uniform("farWidth"), ROAD_WIDTH * 0.9f);
+    GLint color = roadShader.uniform("color");
 
-    // Merge road edges + horizontal lines into one GL_LINES call
-    glBegin(GL_LINES);
+    GLProfile::lineWidth(2.0f);
+    road.bind();
 
     // Road edges
-    glColor3fv(ROAD_COLOR);
-    glVertex3f(-nearWidth, 0.0f, nearZ);
-    glVertex3f(-farWidth, 0.0f, farZ);
-
-    glVertex3f(nearWidth, 0.0f, nearZ);
-    glVertex3f(farWidth, 0.0f, farZ);
+    ShaderProgram::set(color, ROAD_COLOR[0], ROAD_COLOR[1], ROAD_COLOR[2]);
+    glDrawArrays(GL_LINES, 0, 4);
 
     // Horizontal grid lines
-    glColor3fv(GRID_COLOR);
-    for (float z : roadLines)
-    {
-        float mappedZ = nearZ + (z + 1.0f) * (farZ - nearZ) * 0.5f; // same as /2.0f
-        float t = (mappedZ - nearZ) / (farZ - nearZ);
-        float width = nearWidth * (1.0f - t) + farWidth * t;
+    ShaderProgram::set(color, GRID_COLOR[0], GRID_COLOR[1], GRID_COLOR[2]);
+    glDrawArrays(GL_LINES, 4, NUM_ROAD_LINES * 2);
 
-        glVertex3f(-width, 0.0f, mappedZ);
-        glVertex3f(width, 0.0f, mappedZ);
-    }
-
-    glEnd();
+    road.unbind();
+    ShaderProgram::release();
 }
 
 void RacerVisualizer::renderBuildings()
 {
-    glLineWidth(2.0f);
-
-    // Combine left & right buildings into a single draw call
-    glBegin(GL_LINES);
-    glColor3fv(BUILDING_COLOR);
-
-    for (const auto &building : leftBuildings)
+    if (!buildingShader.build(BUILDING_VERTEX_SHADER, FLAT_FRAGMENT_SHADER,
+                              {"boxVertex", "slot", "side", "heightScale"}))
+        return;
+
+    const GLsizei count = static_cast<GLsizei>(buildingSlots.size());
+    const GLsizei boxVertices = 24;
+
+    buildingShader.use();
+    camera.apply(buildingShader);
+    ShaderProgram::set(buildingShader.uniform("scroll"), cityScroll);
+    ShaderProgram::set(buildingShader.uniform("wavePhase"), roadPosition);
+    ShaderProgram::set(buildingShader.uniform("amplitude"), audioAmplitude);
+    ShaderProgram::set(buildingShader.uniform("nearZ"), NEAR_Z);
+    ShaderProgram::set(buildingShader.uniform("farZ"), FAR_Z);
+    ShaderProgram::set(buildingShader.uniform("nearWidth"), ROAD_WIDTH * 2.5f);
+    ShaderProgram::set(buildingShader.uniform("farWidth"), ROAD_WIDTH * 0.9f);
+    ShaderProgram::set(buildingShader.uniform("buildingHeight"), BUILDING_HEIGHT);
+    ShaderProgram::set(buildingShader.uniform("buildingOffset"), BUILDING_OFFSET);
+    ShaderProgram::set(buildingShader.uniform("buildingWidth"), BUILDING_WIDTH);
+    ShaderProgram::set(buildingShader.uniform("sineFrequency"), SINE_FREQ);
+    ShaderProgram::set(buildingShader.uniform("color"), BUILDING_COLOR[0], BUILDING_COLOR[1], BUILDING_COLOR[2]);
+
+    GLProfile::lineWidth(2.0f);
+    buildings.bind();
+
+    if (VertexArray::instancing())
     {
-        glVertex3f(building.xPos, 0.0f, building.zPos);
-        glVertex3f(building.xPos, building.height, building.zPos);
+        // Every building in one call
+        VertexArray::drawArraysInstanced(GL_LINES, 0, boxVertices, count);
     }
-    for (const auto &building : rightBuildings)
+    else
     {
-        glVertex3f(building.xPos, 0.0f, building.zPos);
-        glVertex3f(building.xPos, building.height, building.zPos);
+        // Without instancing the building values become constant
+        // attributes and each building is its own draw of the box
+        for (GLsizei i = 0; i < count; i++)
+        {
+            glVertexAttrib1f(1, buildingSlots[i]);
+            glVertexAttrib1f(2, buildingSides[i]);
+            glVertexAttrib1f(3, buildingScales[i]);
+            glDrawArrays(GL_LINES, 0, boxVertices);
+        }
     }
 
-    glEnd();
+    buildings.unbind();
+    ShaderProgram::release();
 }
 
-float RacerVisualizer::calculateAudioAmplitude(const std::vector<float> &audioData, size_t position)
+float RacerVisualizer::calculateAudioAmplitude(const SourceSpectrum &spectrum)
 {
-    const size_t windowSize = 1024;
-    // Clamp the end so we don't read beyond the audioData
-    size_t end = std::min(position + windowSize, audioData.size());
-
-    float sum = 0.0f;
-    for (size_t i = position; i < end; i++)
-    {
-        sum += std::fabs(audioData[i]);
-    }
-
-    float average = 0.0f;
-    size_t count = end - position;
-    if (count > 0)
-        average = sum / static_cast<float>(count);
-
+    // The analysis level is the mean absolute sample over the block
     // Scale for dramatic effect but max out at 1.0
-    return std::min(1.0f, average * 4.0f);
+    return std::min(1.0f, spectrum.level * 4.0f);
 }
 
 void RacerVisualizer::renderSun()
 {
+    if (!sunShader.build(SUN_VERTEX_SHADER, SUN_FRAGMENT_SHADER, {"sunVertex", "sunColor"}))
+        return;
+
     // Enable blending for glow effect
     glEnable(GL_BLEND);
     glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
-    float horizonY = 0.0f; // The Y coordinate of the horizon
+    sunShader.use();
+    camera.apply(sunShader);
+    sun.bind();
 
-    // Draw sun at horizon
-    glPushMatrix();
-    glTranslatef(0.0f, horizonY, SUN_Z_POS);
+    // Half disc, then the rays
+    glDrawArrays(GL_TRIANGLE_FAN, 0, sunFanVertices);
+    GLProfile::lineWidth(1.5f);
+    glDrawArrays(GL_LINES, sunFanVertices, sunRayVertices);
 
-    // Half-circle (upper half)
-    glBegin(GL_TRIANGLE_FAN);
-    // Center - inner color
-    glColor3fv(SUN_INNER_COLOR);
-    glVertex3f(0.0f, 0.0f, 0.0f);
-
-    // Outer - outer color
-    glColor3fv(SUN_OUTER_COLOR);
-    for (int i = 0; i <= SUN_SEGMENTS; i++)
-    {
-        float angle = M_PI * i / SUN_SEGMENTS;
-        float x = SUN_RADIUS * std::cos(angle) * 1.25f;
-        float y = SUN_RADIUS * std::sin(angle) * 1.25f;
-        if (y >= 0.0f)
-        {
-            glVertex3f(x, y, 0.0f);
-        }
-    }
-    glEnd();
-
-    // Rays
-    glLineWidth(1.5f);
-    glBegin(GL_LINES);
-    glColor4f(1.0f, 0.4f, 0.8f, 0.5f);
-    for (int i = 0; i < 12; i++)
-    {
-        float angle = M_PI * i / 11;
-        if (std::sin(angle) >= 0.0f)
-        {
-            float x1 = SUN_RADIUS * std::cos(angle) * 1.25f;
-            float y1 = SUN_RADIUS * std::sin(angle) * 1.25f;
-            float x2 = (SUN_RADIUS * 1.3f) * std::cos(angle) * 1.25f;
-            float y2 = (SUN_RADIUS * 1.3f) * std::sin(angle) * 1.25f;
-
-            glVertex3f(x1, y1, 0.0f);
-            glVertex3f(x2, y2, 0.0f);
-        }
-    }
-    glEnd();
-
-    glPopMatrix();
+    sun.unbind();
+    ShaderProgram::release();
 }
 
-void RacerVisualizer::renderFrame(const std::vector<float> &audioData,
-                                  double * /* fftInputBuffer */,
-                                  fftw_complex * /* fftOutputBuffer */,
-                                  fftw_plan & /* fftPlan */,
+void RacerVisualizer::renderFrame(const AnalysisFrame &analysis,
                                   float timeSeconds)
 {
-    size_t sampleIndex = static_cast<size_t>(timeSeconds * 44100);
-    audioAmplitude = calculateAudioAmplitude(audioData, sampleIndex);
+    (void)timeSeconds; // Animation is frame-driven
+    audioAmplitude = calculateAudioAmplitude(analysis.primary());
 
     // Move the road
     roadPosition = std::fmod(roadPosition + ROAD_SPEED, 1.0f);
@@ -292,6 +371,11 @@ void RacerVisualizer::renderFrame(const std::vector<float> &audioData,
 
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
+    if (!roadVbo)
+    {
+        createBuffers();
+    }
+
     // Furthest away first
     renderSun();
 
@@ -305,13 +389,11 @@ void RacerVisualizer::renderFrame(const std::vector<float> &audioData,
     glDisable(GL_BLEND);
 }
 
-void RacerVisualizer::renderLiveFrame(const std::vector<float> &audioData,
-                                      double * /* fftInputBuffer */,
-                                      fftw_complex * /* fftOutputBuffer */,
-                                      fftw_plan & /* fftPlan */,
+void RacerVisualizer::renderLiveFrame(const AnalysisFrame &analysis,
                                       size_t currentPosition)
 {
-    audioAmplitude = calculateAudioAmplitude(audioData, currentPosition);
+    (void)currentPosition; // Animation is frame-driven
+    audioAmplitude = calculateAudioAmplitude(analysis.primary());
     roadPosition = std::fmod(roadPosition + ROAD_SPEED, 1.0f);
 
     setupPerspectiveView();
@@ -323,6 +405,10 @@ void RacerVisualizer::renderLiveFrame(const std::vector<float> &audioData,
 
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
+    if (!roadVbo)
+    {
+        createBuffers();
+    }
     renderSun();
 
     updateRoad(1.0f / 60.0f);
@@ -1,7 +1,11 @@
 #pragma once
 #include "visualizer_base.h"
+#include "gl_math.h"
+#include "shader_program.h"
+#include "uniform_buffer.h"
+#include "vertex_array.h"
+#include <GL/glew.h>
 #include <vector>
-#include <deque>
 
 class RacerVisualizer : public Visualizer
 {
@@ -11,18 +15,23 @@ public:
 
     void initialize(int width, int height) override;
 
-    void renderFrame(const std::vector<float> &audioData,
-                     double *fftInputBuffer,
-                     fftw_complex *fftOutputBuffer,
-                     fftw_plan &fftPlan,
+    bool supportsCoreProfile() const override { return true; }
+
+    void renderFrame(const AnalysisFrame &analysis,
                      float timeSeconds) override;
 
-    void renderLiveFrame(const std::vector<float> &audioData,
-                         double *fftInputBuffer,
-                         fftw_complex *fftOutputBuffer,
-                         fftw_plan &fftPlan,
+    void renderLiveFrame(const AnalysisFrame &analysis,
                          size_t currentPosition) override;
 
+    // Neon glow and faint scanlines from the shared CRT pass
+    CRTSettings crtSettings() const override
+    {
+        CRTSettings settings;
+        settings.bloom = 0.8f;
+        settings.scanlines = 0.15f;
+        return settings;
+    }
+
 private:
     static constexpr int NUM_ROAD_LINES = 30;      // More lines for smoother road
     static constexpr int NUM_BUILDINGS = 40;       // More buildings for better density
@@ -30,6 +39,10 @@ private:
     static constexpr float BUILDING_HEIGHT = 1.0f; // Slightly taller buildings
     static constexpr float MOVE_SPEED = 2.5f;      // Faster movement for better effect
     static constexpr float SINE_FREQ = 3.0f;       // Higher frequency for wave effect
+    static constexpr float NEAR_Z = 3.0f;          // Near end of the road, behind the camera
+    static constexpr float FAR_Z = -5.0f;          // Far end of the road, at the horizon
+    static constexpr float BUILDING_OFFSET = 0.2f; // Gap between the road edge and the buildings
+    static constexpr float BUILDING_WIDTH = 0.1f;  // Footprint of a building box
 
     // Colors
     static constexpr float ROAD_COLOR[3] = {0.0f, 0.6f, 0.8f};     // Cyan
@@ -44,25 +57,43 @@ private:
     static constexpr float SUN_INNER_COLOR[3] = {1.0f, 0.6f, 0.0f}; // Brighter orange
     static constexpr float SUN_OUTER_COLOR[3] = {0.9f, 0.1f, 0.9f}; // Brighter magenta
 
-    struct Building
-    {
-        float height;
-        float xPos;
-        float zPos;
-    };
-
     float audioAmplitude;
     float roadPosition; // Position of the road (0.0 to 1.0)
-    std::deque<Building> leftBuildings;
-    std::deque<Building> rightBuildings;
-    std::vector<float> roadLines;
+    float roadScroll;   // How far the grid lines have come, as a share of the road length
+    float cityScroll;   // How far the buildings have come, from 0 to the road length
+
+    // The buildings are a ring of slots along both road edges, one array
+    // per field. A building's place is its slot moved on by cityScroll and
+    // wrapped back to the far end, so nothing per building changes from
+    // frame to frame; the height wave is applied in the vertex shader.
+    std::vector<float> buildingSlots;  // z when cityScroll is 0
+    std::vector<float> buildingSides;  // -1 left of the road, 1 right
+    std::vector<float> buildingScales; // Height variation
+
+    // Static meshes: the road with its grid lines, a unit box, the
+    // building arrays one after another, and the sun's fan and rays with
+    // their colors
+    ShaderProgram roadShader;
+    ShaderProgram buildingShader;
+    ShaderProgram sunShader;
+    GLuint roadVbo = 0;
+    GLuint boxVbo = 0;
+    GLuint buildingVbo = 0;
+    GLuint sunVbo = 0;
+    GLsizei sunFanVertices = 0;
+    GLsizei sunRayVertices = 0;
+    VertexArray road;
+    VertexArray buildings;
+    VertexArray sun;
+    CameraUniforms camera;
 
     void updateRoad(float deltaTime);
     void updateBuildings(float deltaTime);
+    void createBuffers();
     void renderRoad();
     void renderBuildings();
     void renderSun();
-    float calculateAudioAmplitude(const std::vector<float> &audioData, size_t position);
+    float calculateAudioAmplitude(const SourceSpectrum &spectrum);
     void setupPerspectiveView();
 
     static constexpr float ROAD_SPEED = 0.02f;
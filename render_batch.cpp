@@ -0,0 +1,190 @@
+#include "render_batch.h"
+#include <algorithm>
+
+static uint8_t toByte(float value)
+{
+    // Fixed-function colors are clamped to [0, 1] as well
+    return static_cast<uint8_t>(std::max(0.0f, std::min(1.0f, value)) * 255.0f + 0.5f);
+}
+
+RenderBatch::~RenderBatch()
+{
+    if (vbo)
+    {
+        glDeleteBuffers(1, &vbo);
+    }
+}
+
+void RenderBatch::color(float r, float g, float b, float a)
+{
+    currentColor[0] = toByte(r);
+    currentColor[1] = toByte(g);
+    currentColor[2] = toByte(b);
+    currentColor[3] = toByte(a);
+}
+
+void RenderBatch::begin(GLenum mode)
+{
+    primitiveMode = mode;
+    primitive.clear();
+}
+
+void RenderBatch::vertex(float x, float y, float z)
+{
+    Vertex v = {x, y, z, {currentColor[0], currentColor[1], currentColor[2], currentColor[3]}};
+    primitive.push_back(v);
+}
+
+void RenderBatch::end()
+{
+    const size_t count = primitive.size();
+    const Vertex *v = primitive.data();
+
+    switch (primitiveMode)
+    {
+    case GL_POINTS:
+        emit(GL_POINTS, v, count);
+        break;
+    case GL_LINES:
+        emit(GL_LINES, v, count - count % 2);
+        break;
+    case GL_TRIANGLES:
+        emit(GL_TRIANGLES, v, count - count % 3);
+        break;
+    case GL_QUADS:
+        emit(GL_QUADS, v, count - count % 4);
+        break;
+    case GL_LINE_STRIP:
+    case GL_LINE_LOOP:
+        for (size_t i = 0; i + 1 < count; i++)
+        {
+            emitLine(v[i], v[i + 1]);
+        }
+        if (primitiveMode == GL_LINE_LOOP && count > 2)
+        {
+            emitLine(v[count - 1], v[0]);
+        }
+        break;
+    case GL_TRIANGLE_STRIP:
+        // Swap every other triangle to keep the strip's winding
+        for (size_t i = 0; i + 2 < count; i++)
+        {
+            if (i % 2 == 0)
+                emitTriangle(v[i], v[i + 1], v[i + 2]);
+            else
+                emitTriangle(v[i + 1], v[i], v[i + 2]);
+        }
+        break;
+    case GL_TRIANGLE_FAN:
+    case GL_POLYGON:
+        for (size_t i = 1; i + 1 < count; i++)
+        {
+            emitTriangle(v[0], v[i], v[i + 1]);
+        }
+        break;
+    case GL_QUAD_STRIP:
+        for (size_t i = 0; i + 3 < count; i += 2)
+        {
+            Vertex quad[4] = {v[i], v[i + 1], v[i + 3], v[i + 2]};
+            emit(GL_QUADS, quad, 4);
+        }
+        break;
+    default:
+        break;
+    }
+
+    primitive.clear();
+}
+
+void RenderBatch::rect(float x1, float y1, float x2, float y2)
+{
+    begin(GL_QUADS);
+    vertex(x1, y1);
+    vertex(x2, y1);
+    vertex(x2, y2);
+    vertex(x1, y2);
+    end();
+}
+
+void RenderBatch::emit(GLenum mode, const Vertex *data, size_t count)
+{
+    if (count == 0)
+        return;
+
+    // Join the previous batch when nothing that affects drawing changed
+    if (batches.empty() || batches.back().mode != mode ||
+        batches.back().lineWidth != currentLineWidth || batches.back().pointSize != currentPointSize)
+    {
+        Batch batch = {mode, currentLineWidth, currentPointSize, static_cast<GLint>(vertices.size()), 0};
+        batches.push_back(batch);
+    }
+
+    vertices.insert(vertices.end(), data, data + count);
+    batches.back().count += static_cast<GLsizei>(count);
+}
+
+void RenderBatch::emitTriangle(const Vertex &a, const Vertex &b, const Vertex &c)
+{
+    Vertex triangle[3] = {a, b, c};
+    emit(GL_TRIANGLES, triangle, 3);
+}
+
+void RenderBatch::emitLine(const Vertex &a, const Vertex &b)
+{
+    Vertex segment[2] = {a, b};
+    emit(GL_LINES, segment, 2);
+}
+
+void RenderBatch::flush()
+{
+    if (batches.empty())
+        return;
+
+    if (!vbo)
+    {
+        glGenBuffers(1, &vbo);
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+
+    // Orphan the previous contents so the driver never waits for the last
+    // frame's draws before accepting new data
+    size_t bytes = vertices.size() * sizeof(Vertex);
+    if (bytes > vboCapacity)
+    {
+        vboCapacity = std::max(bytes, vboCapacity * 2);
+    }
+    glBufferData(GL_ARRAY_BUFFER, vboCapacity, nullptr, GL_STREAM_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, bytes, vertices.data());
+
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glEnableClientState(GL_COLOR_ARRAY);
+    glVertexPointer(3, GL_FLOAT, sizeof(Vertex), reinterpret_cast<const void *>(offsetof(Vertex, x)));
+    glColorPointer(4, GL_UNSIGNED_BYTE, sizeof(Vertex), reinterpret_cast<const void *>(offsetof(Vertex, rgba)));
+
+    float lineWidth = 1.0f;
+    float pointSize = 1.0f;
+    for (const Batch &batch : batches)
+    {
+        if (batch.lineWidth != lineWidth)
+        {
+            lineWidth = batch.lineWidth;
+            glLineWidth(lineWidth);
+        }
+        if (batch.pointSize != pointSize)
+        {
+            pointSize = batch.pointSize;
+            glPointSize(pointSize);
+        }
+        glDrawArrays(batch.mode, batch.first, batch.count);
+    }
+
+    // Leave the defaults the immediate-mode visualizers expect
+    glLineWidth(1.0f);
+    glPointSize(1.0f);
+    glDisableClientState(GL_COLOR_ARRAY);
+    glDisableClientState(GL_VERTEX_ARRAY);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    vertices.clear();
+    batches.clear();
+}
@@ -0,0 +1,81 @@
+#ifndef RENDER_BATCH_H
+#define RENDER_BATCH_H
+
+#include <GL/glew.h>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Collects geometry with an immediate-mode style interface and draws it from
+// one streamed vertex buffer. Consecutive primitives that share a mode, line
+// width and point size form one batch, drawn with a single glDrawArrays, so
+// submission order (and with it overdraw) is preserved.
+//
+// Strips, fans, loops and polygons are split into independent lines or
+// triangles on end(), which lets neighbouring shapes join the same batch.
+// Matrices, blending and other GL state are read when flush() draws, so
+// flush before changing them.
+class RenderBatch
+{
+public:
+    RenderBatch() = default;
+    ~RenderBatch();
+
+    RenderBatch(const RenderBatch &) = delete;
+    RenderBatch &operator=(const RenderBatch &) = delete;
+
+    // State for the primitives that follow, as with glLineWidth/glPointSize
+    void lineWidth(float width) { currentLineWidth = width; }
+    void pointSize(float size) { currentPointSize = size; }
+
+    // Color for the vertices that follow, as with glColor
+    void color(float r, float g, float b, float a = 1.0f);
+    void color(const float rgb[3]) { color(rgb[0], rgb[1], rgb[2]); }
+
+    // Same meaning as glBegin/glVertex/glEnd
+    void begin(GLenum mode);
+    void vertex(float x, float y, float z = 0.0f);
+    void end();
+
+    // Shorthand for an axis-aligned filled rectangle
+    void rect(float x1, float y1, float x2, float y2);
+
+    // Upload everything collected since the last flush and draw it
+    void flush();
+
+private:
+    struct Vertex
+    {
+        float x, y, z;
+        uint8_t rgba[4];
+    };
+
+    struct Batch
+    {
+        GLenum mode;
+        float lineWidth;
+        float pointSize;
+        GLint first;
+        GLsizei count;
+    };
+
+    void emit(GLenum mode, const Vertex *data, size_t count);
+    void emitTriangle(const Vertex &a, const Vertex &b, const Vertex &c);
+    void emitLine(const Vertex &a, const Vertex &b);
+
+    std::vector<Vertex> vertices;
+    std::vector<Batch> batches;
+
+    // Primitive being assembled between begin() and end()
+    GLenum primitiveMode = GL_POINTS;
+    std::vector<Vertex> primitive;
+
+    uint8_t currentColor[4] = {255, 255, 255, 255};
+    float currentLineWidth = 1.0f;
+    float currentPointSize = 1.0f;
+
+    GLuint vbo = 0;
+    size_t vboCapacity = 0; // Bytes
+};
+
+#endif // RENDER_BATCH_H
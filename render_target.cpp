@@ -0,0 +1,129 @@
+#include "render_target.h"
+#include <algorithm>
+#include <iostream>
+
+RenderTarget::~RenderTarget()
+{
+    destroy();
+}
+
+bool RenderTarget::create(int newWidth, int newHeight, int samples)
+{
+    destroy();
+
+    if (!GLEW_ARB_framebuffer_object)
+    {
+        std::cerr << "Framebuffer objects are not supported; cannot render offscreen" << std::endl;
+        return false;
+    }
+
+    width = newWidth;
+    height = newHeight;
+
+    GLint maxSamples = 0;
+    glGetIntegerv(GL_MAX_SAMPLES, &maxSamples);
+    if (samples > maxSamples)
+    {
+        std::cout << "Multisampling limited to " << maxSamples << " samples" << std::endl;
+        samples = maxSamples;
+    }
+    bool multisample = samples > 1;
+
+    // The depth buffer goes with whichever framebuffer is drawn into
+    bool complete = createFramebuffer(framebuffer, colorBuffer, depthBuffer, width, height, 0, !multisample);
+    if (complete && multisample)
+    {
+        complete = createFramebuffer(multisampleFramebuffer, multisampleColor, multisampleDepth,
+                                     width, height, samples, true);
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    if (!complete)
+    {
+        std::cerr << "Offscreen framebuffer of " << width << "x" << height << " is incomplete" << std::endl;
+        destroy();
+        return false;
+    }
+    return true;
+}
+
+bool RenderTarget::createFramebuffer(GLuint &target, GLuint &color, GLuint &depth,
+                                     int targetWidth, int targetHeight, int samples, bool withDepth)
+{
+    glGenRenderbuffers(1, &color);
+    glBindRenderbuffer(GL_RENDERBUFFER, color);
+    glRenderbufferStorageMultisample(GL_RENDERBUFFER, samples, GL_RGBA8, targetWidth, targetHeight);
+    if (withDepth)
+    {
+        glGenRenderbuffers(1, &depth);
+        glBindRenderbuffer(GL_RENDERBUFFER, depth);
+        glRenderbufferStorageMultisample(GL_RENDERBUFFER, samples, GL_DEPTH_COMPONENT24, targetWidth, targetHeight);
+    }
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+    glGenFramebuffers(1, &target);
+    glBindFramebuffer(GL_FRAMEBUFFER, target);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, color);
+    if (withDepth)
+    {
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, depth);
+    }
+    return glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+}
+
+void RenderTarget::destroy()
+{
+    for (GLuint *target : {&framebuffer, &multisampleFramebuffer})
+    {
+        if (*target)
+        {
+            glDeleteFramebuffers(1, target);
+            *target = 0;
+        }
+    }
+    for (GLuint *buffer : {&colorBuffer, &depthBuffer, &multisampleColor, &multisampleDepth})
+    {
+        if (*buffer)
+        {
+            glDeleteRenderbuffers(1, buffer);
+            *buffer = 0;
+        }
+    }
+    width = 0;
+    height = 0;
+}
+
+void RenderTarget::bind() const
+{
+    glBindFramebuffer(GL_FRAMEBUFFER, multisampleFramebuffer ? multisampleFramebuffer : framebuffer);
+    glViewport(0, 0, width, height);
+}
+
+void RenderTarget::resolve() const
+{
+    if (multisampleFramebuffer)
+    {
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, multisampleFramebuffer);
+        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, framebuffer);
+        glBlitFramebuffer(0, 0, width, height, 0, 0, width, height, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+    }
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, framebuffer);
+}
+
+void RenderTarget::present(int windowWidth, int windowHeight) const
+{
+    // Largest size with the frame's aspect ratio that fits the window
+    float scale = std::min(static_cast<float>(windowWidth) / width, static_cast<float>(windowHeight) / height);
+    int presentWidth = static_cast<int>(width * scale);
+    int presentHeight = static_cast<int>(height * scale);
+    int left = (windowWidth - presentWidth) / 2;
+    int bottom = (windowHeight - presentHeight) / 2;
+
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+    glClear(GL_COLOR_BUFFER_BIT);
+
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, framebuffer);
+    glBlitFramebuffer(0, 0, width, height, left, bottom, left + presentWidth, bottom + presentHeight,
+                      GL_COLOR_BUFFER_BIT, GL_LINEAR);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
@@ -0,0 +1,51 @@
+#ifndef RENDER_TARGET_H
+#define RENDER_TARGET_H
+
+#include <GL/glew.h>
+
+// Offscreen framebuffer that recordings are drawn into, so the output size
+// does not depend on the window, the display's pixel density or whether a
+// window is shown at all. With multisampling the frame is drawn into a
+// multisampled buffer and resolved into a single-sampled one, which is the
+// one read back.
+class RenderTarget
+{
+public:
+    RenderTarget() = default;
+    ~RenderTarget();
+
+    RenderTarget(const RenderTarget &) = delete;
+    RenderTarget &operator=(const RenderTarget &) = delete;
+
+    // Allocate width x height buffers. A sample count above 1 enables
+    // multisampling, clamped to what the driver supports. Errors are
+    // reported on std::cerr.
+    bool create(int width, int height, int samples);
+
+    // Send the following drawing to the target, the viewport covering it
+    void bind() const;
+
+    // Resolve the frame if multisampled, and leave the result bound as the
+    // read framebuffer for glReadPixels
+    void resolve() const;
+
+    // Scale the resolved frame into the window, letterboxed to keep its
+    // aspect ratio; leaves the window's framebuffer bound
+    void present(int windowWidth, int windowHeight) const;
+
+private:
+    static bool createFramebuffer(GLuint &target, GLuint &color, GLuint &depth,
+                                  int width, int height, int samples, bool withDepth);
+    void destroy();
+
+    GLuint framebuffer = 0; // Single-sampled, resolved into and read back
+    GLuint colorBuffer = 0;
+    GLuint depthBuffer = 0; // Only when not multisampled
+    GLuint multisampleFramebuffer = 0;
+    GLuint multisampleColor = 0;
+    GLuint multisampleDepth = 0;
+    int width = 0;
+    int height = 0;
+};
+
+#endif // RENDER_TARGET_H
@@ -1,5 +1,6 @@
 #include "scroller_text.h"
 #include <GL/glew.h>
+#include "stroke_font.h"
 #include <cmath>
 
 ScrollerText::ScrollerText() : screenWidth(800), screenHeight(600), scrollPosition(0.0f) {
@@ -10,46 +11,35 @@ void ScrollerText::initialize(int width, int height) {
     screenHeight = height;
 }
 
-void ScrollerText::renderFrame(const std::vector<float>& audioData,
-                             double* in,
-                             fftw_complex* out,
-                             fftw_plan& plan,
+void ScrollerText::renderFrame(const AnalysisFrame& analysis,
                              float timeSeconds) {
-    (void)audioData;  // Mark as intentionally unused
-    (void)in;         // Mark as intentionally unused
-    (void)plan;       // Mark as intentionally unused
-    
     // Calculate magnitudes for audio reactivity
-    std::vector<float> magnitudes(N/2);
-    for (int i = 0; i < N/2; i++) {
-        magnitudes[i] = sqrt(out[i][0] * out[i][0] + out[i][1] * out[i][1]) / N;
+    const SourceSpectrum& spectrum = analysis.primary();
+    spectrumMagnitudes.resize(spectrum.magnitudes.size() - 1);
+    for (size_t i = 0; i < spectrumMagnitudes.size(); i++) {
+        spectrumMagnitudes[i] = spectrum.magnitudes[i] / N;
     }
     
-    render(timeSeconds, magnitudes);
+    render(timeSeconds, spectrumMagnitudes);
 }
 
-void ScrollerText::renderLiveFrame(const std::vector<float>& audioData,
-                                 double* in,
-                                 fftw_complex* out,
-                                 fftw_plan& plan,
+void ScrollerText::renderLiveFrame(const AnalysisFrame& analysis,
                                  size_t currentPosition) {
-    (void)audioData;  // Mark as intentionally unused
-    (void)in;         // Mark as intentionally unused
-    (void)plan;       // Mark as intentionally unused
-    
     // Calculate magnitudes for audio reactivity
-    std::vector<float> magnitudes(N/2);
-    for (int i = 0; i < N/2; i++) {
-        magnitudes[i] = sqrt(out[i][0] * out[i][0] + out[i][1] * out[i][1]) / N;
+    const SourceSpectrum& spectrum = analysis.primary();
+    spectrumMagnitudes.resize(spectrum.magnitudes.size() - 1);
+    for (size_t i = 0; i < spectrumMagnitudes.size(); i++) {
+        spectrumMagnitudes[i] = spectrum.magnitudes[i] / N;
     }
     
-    float timeSeconds = static_cast<float>(currentPosition) / 44100.0f;
-    render(timeSeconds, magnitudes);
+    float timeSeconds = static_cast<float>(currentPosition) / analysis.sampleRate;
+    render(timeSeconds, spectrumMagnitudes);
 }
 
 void ScrollerText::render(float time, const std::vector<float>& magnitudes) {
-    // Update scroll position
-    scrollPosition = fmod(scrollPosition + SCROLL_SPEED * 0.02f, 2.0f);
+    // Update scroll position, wrapping once the whole message has left the screen
+    float wrapLength = 1.5f + message.length() * LETTER_SPACING * 0.5f;
+    scrollPosition = fmod(scrollPosition + SCROLL_SPEED * 0.02f, wrapLength);
     
     // Calculate audio reactivity
     float avgMagnitude = 0.0f;
@@ -70,18 +60,30 @@ void ScrollerText::render(float time, const std::vector<float>& magnitudes) {
     glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
     
     // Render the text with metallic effect and bounce
-    renderMetallicText("Tone Coder", time, bounce);
+    renderMetallicText(message, time, bounce);
+    batch.flush();
     
     glDisable(GL_BLEND);
 }
 
-void ScrollerText::renderMetallicText(const char* text, float time, float bounce) {
-    float letterSpacing = 0.3f;
+void ScrollerText::renderMetallicText(const std::string& text, float time, float bounce) {
+    const StrokeFont& font = StrokeFont::get();
+    const std::vector<StrokeFont::Point>& points = font.points();
     float baseX = 1.0f - scrollPosition * 2.0f; // Start from right, move left
     
-    // For each character in the text
-    for (const char* c = text; *c != '\0'; c++) {
-        float charX = baseX + (c - text) * letterSpacing;
+    // One pass over the message: place each glyph on the wave, then copy its
+    // precompiled strokes once per metallic layer. Everything is thick lines,
+    // so the whole scroller is a single batch.
+    batch.lineWidth(3.0f);  // Thicker lines for better visibility
+    batch.begin(GL_LINES);
+    for (size_t i = 0; i < text.length(); i++) {
+        float charX = baseX + i * LETTER_SPACING;
+        
+        // Only render if the letter is within visible range (-1.5 to 1.5),
+        // skipping spaces but maintaining spacing
+        if (charX <= -1.5f || charX >= 1.5f || text[i] == ' ') {
+            continue;
+        }
         
         // Calculate y position using a more aggressive sine wave
         float wavePhase = charX * 2.0f + time * SINE_FREQUENCY;
@@ -90,142 +92,21 @@ void ScrollerText::renderMetallicText(const char* text, float time, float bounce
         // Add individual letter bounce based on audio
         letterY += bounce * sin(charX * 5.0f + time * 10.0f); // Faster oscillation
         
-        // Only render if the letter is within visible range (-1.5 to 1.5)
-        if (charX > -1.5f && charX < 1.5f) {
-            if (*c != ' ') {  // Skip rendering for spaces but maintain spacing
-                // Scale letters based on audio intensity
-                float scale = 0.12f * (1.0f + bounce * 0.5f);
-                renderCharacter(*c, charX, letterY, scale);
-            }
-        }
-    }
-}
-
-void ScrollerText::renderCharacter(char c, float x, float y, float scale) {
-    // Define stroke-based character shapes with adjusted positioning
-    switch (c) {
-        case 'T':
-            renderStroke({
-                {-0.35f, 1.0f}, {0.35f, 1.0f},  // Top horizontal
-                {0.0f, 1.0f}, {0.0f, 0.0f}      // Vertical
-            }, x, y, scale);
-            break;
-        case 'o':
-            renderCircle(x + scale * 0.0f, y + scale * 0.5f, scale * 0.3f);
-            break;
-        case 'n':
-            renderStroke({
-                {-0.3f, 0.0f}, {-0.3f, 1.0f},    // Left vertical
-                {-0.3f, 1.0f}, {0.3f, 0.0f},     // Diagonal
-                {0.3f, 0.0f}, {0.3f, 1.0f}       // Right vertical
-            }, x, y, scale);
-            break;
-        case 'e':
-            renderStroke({
-                {-0.3f, 0.0f}, {-0.3f, 1.0f},    // Left vertical
-                {-0.3f, 0.0f}, {0.25f, 0.0f},    // Bottom horizontal
-                {-0.3f, 0.5f}, {0.2f, 0.5f},     // Middle horizontal (slightly shorter)
-                {-0.3f, 1.0f}, {0.25f, 1.0f}     // Top horizontal
-            }, x, y, scale);
-            break;
-        case 'C':
-            renderArc(x + scale * 0.0f, y + scale * 0.5f, scale * 0.4f, M_PI * 0.25f, M_PI * 1.75f);
-            break;
-        case 'd':
-            renderStroke({
-                {0.3f, 0.0f}, {0.3f, 1.0f}      // Right vertical
-            }, x, y, scale);
-            renderArc(x + scale * 0.0f, y + scale * 0.5f, scale * 0.3f, 0, M_PI * 2);
-            break;
-        case 'r':
-            renderStroke({
-                {-0.3f, 0.0f}, {-0.3f, 1.0f},    // Left vertical
-                {-0.3f, 1.0f}, {0.25f, 1.0f},    // Top horizontal
-                {0.25f, 1.0f}, {0.25f, 0.5f},    // Right vertical
-                {0.25f, 0.5f}, {-0.3f, 0.5f},    // Middle horizontal
-                {-0.3f, 0.5f}, {0.25f, 0.0f}     // Diagonal
-            }, x, y, scale);
-            break;
-        default:
-            // For unsupported characters, draw a simple rectangle
-            glBegin(GL_LINE_LOOP);
-            glVertex2f(x - scale * 0.4f, y);
-            glVertex2f(x + scale * 0.4f, y);
-            glVertex2f(x + scale * 0.4f, y + scale);
-            glVertex2f(x - scale * 0.4f, y + scale);
-            glEnd();
-    }
-}
-
-void ScrollerText::renderStroke(const std::vector<std::pair<float, float>>& points, float x, float y, float scale) {
-    glLineWidth(3.0f);  // Thicker lines for better visibility
-    
-    // Apply metallic gradient
-    for (int i = 0; i < 4; i++) {
-        glColor3fv(METALLIC_GRADIENT[i]);
+        // Scale letters based on audio intensity
+        float scale = 0.12f * (1.0f + bounce * 0.5f);
         
-        glBegin(GL_LINE_STRIP);
-        for (size_t j = 0; j < points.size(); j += 2) {
-            float x1 = x + points[j].first * scale;
-            float y1 = y + points[j].second * scale;
-            float x2 = x + points[j+1].first * scale;
-            float y2 = y + points[j+1].second * scale;
+        const StrokeFont::Glyph& glyph = font.glyph(text[i]);
+        for (int layer = 0; layer < 4; layer++) {
+            batch.color(METALLIC_GRADIENT[layer]);
             
             // Offset each layer slightly upward and to the right for metallic effect
-            float offset = i * scale * 0.05f;  // Reduced from 0.25f to 0.05f
-            glVertex2f(x1 + offset, y1 + offset);
-            glVertex2f(x2 + offset, y2 + offset);
-        }
-        glEnd();
-    }
-    
-    glLineWidth(1.0f);  // Reset line width
-}
-
-void ScrollerText::renderCircle(float centerX, float centerY, float radius) {
-    glLineWidth(3.0f);
-    
-    const int segments = 32;
-    const float angleStep = 2.0f * M_PI / segments;
-    
-    // Draw multiple circles with metallic gradient
-    for (int i = 0; i < 4; i++) {
-        glColor3fv(METALLIC_GRADIENT[i]);
-        float r = radius * (1.0f + i * 0.1f);  // Slightly larger radius for each layer
-        
-        glBegin(GL_LINE_LOOP);
-        for (int j = 0; j < segments; j++) {
-            float angle = j * angleStep;
-            float x = centerX + cos(angle) * r;
-            float y = centerY + sin(angle) * r;
-            glVertex2f(x, y);
+            float x = charX + layer * scale * 0.05f;
+            float y = letterY + layer * scale * 0.05f;
+            for (size_t p = glyph.first; p < glyph.first + glyph.count; p++) {
+                batch.vertex(x + points[p].x * scale, y + points[p].y * scale);
+            }
         }
-        glEnd();
     }
-    
-    glLineWidth(1.0f);
+    batch.end();
+    batch.lineWidth(1.0f);  // Reset line width
 }
-
-void ScrollerText::renderArc(float centerX, float centerY, float radius, float startAngle, float endAngle) {
-    glLineWidth(3.0f);
-    
-    const int segments = 32;
-    const float angleStep = (endAngle - startAngle) / segments;
-    
-    // Draw multiple arcs with metallic gradient
-    for (int i = 0; i < 4; i++) {
-        glColor3fv(METALLIC_GRADIENT[i]);
-        float r = radius * (1.0f + i * 0.1f);  // Slightly larger radius for each layer
-        
-        glBegin(GL_LINE_STRIP);
-        for (int j = 0; j <= segments; j++) {
-            float angle = startAngle + j * angleStep;
-            float x = centerX + cos(angle) * r;
-            float y = centerY + sin(angle) * r;
-            glVertex2f(x, y);
-        }
-        glEnd();
-    }
-    
-    glLineWidth(1.0f);
-} 
\ No newline at end of file
@@ -3,7 +3,6 @@
 #include "visualizer_base.h"
 #include <string>
 #include <vector>
-#include <utility>
 
 class ScrollerText : public Visualizer {
 public:
@@ -13,31 +12,24 @@ public:
     void initialize(int width, int height) override;
     
     // Implement base class methods
-    void renderFrame(const std::vector<float>& audioData,
-                    double* in,
-                    fftw_complex* out,
-                    fftw_plan& plan,
+    void renderFrame(const AnalysisFrame& analysis,
                     float timeSeconds) override;
                     
-    void renderLiveFrame(const std::vector<float>& audioData,
-                        double* in,
-                        fftw_complex* out,
-                        fftw_plan& plan,
+    void renderLiveFrame(const AnalysisFrame& analysis,
                         size_t currentPosition) override;
     
     // Original scroller methods
     void render(float time, const std::vector<float>& magnitudes);
     
 private:
-    void renderMetallicText(const char* text, float time, float bounce);
-    void renderCharacter(char c, float x, float y, float scale);
-    void renderStroke(const std::vector<std::pair<float, float>>& points, float x, float y, float scale);
-    void renderCircle(float centerX, float centerY, float radius);
-    void renderArc(float centerX, float centerY, float radius, float startAngle, float endAngle);
+    void renderMetallicText(const std::string& text, float time, float bounce);
     
     int screenWidth;
     int screenHeight;
     float scrollPosition;
+    std::string message = "Tone Coder";
+    std::vector<float> spectrumMagnitudes; // Reused every frame
+    static constexpr float LETTER_SPACING = 0.3f;
     static constexpr float SCROLL_SPEED = 0.5f;
     static constexpr float SINE_AMPLITUDE = 0.5f;
     static constexpr float SINE_FREQUENCY = 3.0f;
@@ -0,0 +1,155 @@
+#include "shader_program.h"
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Replaces each shader's #version 120 line. On the core profile GLSL 3.30
+// takes the place of 1.20, with the removed qualifiers and texture lookups
+// mapped to their replacements.
+static const char *COMPATIBILITY_PROLOGUE = R"(#version 120
+#define CAMERA_UNIFORMS uniform mat4 viewProjection;
+)";
+
+static const char *CORE_VERTEX_PROLOGUE = R"(#version 330 core
+#define CORE_PROFILE
+#define CAMERA_UNIFORMS layout(std140) uniform Camera { mat4 viewProjection; };
+#define attribute in
+#define varying out
+)";
+
+// gl_FragColor is renamed in the source itself: gl_ names are reserved,
+// and drivers differ on whether a macro may take one
+static const char *CORE_FRAGMENT_PROLOGUE = R"(#version 330 core
+#define CORE_PROFILE
+#define CAMERA_UNIFORMS layout(std140) uniform Camera { mat4 viewProjection; };
+#define varying in
+#define texture1D texture
+#define texture2D texture
+out vec4 outputColor;
+)";
+
+static const struct
+{
+    const char *name;
+    UniformBlockBinding binding;
+} UNIFORM_BLOCKS[] = {{"Camera", CAMERA_BLOCK}, {"Colormap", COLORMAP_BLOCK}};
+
+ShaderProgram::~ShaderProgram()
+{
+    if (program)
+    {
+        glDeleteProgram(program);
+    }
+}
+
+GLuint ShaderProgram::compile(GLenum type, const char *source)
+{
+    // Everything after the #version line follows the profile's prologue
+    const char *body = source;
+    if (std::strncmp(body, "#version", 8) == 0)
+    {
+        body = std::strchr(body, '\n');
+        body = body ? body + 1 : "";
+    }
+
+    std::string translated = body;
+    const char *prologue = COMPATIBILITY_PROLOGUE;
+    if (GLProfile::core())
+    {
+        prologue = type == GL_VERTEX_SHADER ? CORE_VERTEX_PROLOGUE : CORE_FRAGMENT_PROLOGUE;
+        for (size_t at = translated.find("gl_FragColor"); at != std::string::npos;
+             at = translated.find("gl_FragColor", at))
+        {
+            translated.replace(at, std::strlen("gl_FragColor"), "outputColor");
+        }
+    }
+
+    const char *sources[2] = {prologue, translated.c_str()};
+    GLuint shader = glCreateShader(type);
+    glShaderSource(shader, 2, sources, nullptr);
+    glCompileShader(shader);
+
+    GLint status = GL_FALSE;
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &status);
+    if (status != GL_TRUE)
+    {
+        GLint length = 0;
+        glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &length);
+        std::vector<char> log(std::max(length, 1));
+        glGetShaderInfoLog(shader, static_cast<GLsizei>(log.size()), nullptr, log.data());
+        std::cerr << "Failed to compile " << (type == GL_VERTEX_SHADER ? "vertex" : "fragment")
+                  << " shader: " << log.data() << std::endl;
+        glDeleteShader(shader);
+        return 0;
+    }
+
+    return shader;
+}
+
+bool ShaderProgram::build(const char *vertexSource, const char *fragmentSource,
+                          std::initializer_list<const char *> attributes)
+{
+    if (program)
+        return true;
+    if (failed)
+        return false;
+    failed = true;
+
+    GLuint vertexShader = compile(GL_VERTEX_SHADER, vertexSource);
+    GLuint fragmentShader = compile(GL_FRAGMENT_SHADER, fragmentSource);
+    if (!vertexShader || !fragmentShader)
+    {
+        glDeleteShader(vertexShader);
+        glDeleteShader(fragmentShader);
+        return false;
+    }
+
+    GLuint linked = glCreateProgram();
+    glAttachShader(linked, vertexShader);
+    glAttachShader(linked, fragmentShader);
+
+    // Fixed locations, starting at 0, which some compatibility drivers need
+    // to be an enabled array before they draw anything
+    GLuint location = 0;
+    for (const char *name : attributes)
+    {
+        glBindAttribLocation(linked, location++, name);
+    }
+    glLinkProgram(linked);
+
+    // The program keeps what it needs from the shaders
+    glDeleteShader(vertexShader);
+    glDeleteShader(fragmentShader);
+
+    GLint status = GL_FALSE;
+    glGetProgramiv(linked, GL_LINK_STATUS, &status);
+    if (status != GL_TRUE)
+    {
+        GLint length = 0;
+        glGetProgramiv(linked, GL_INFO_LOG_LENGTH, &length);
+        std::vector<char> log(std::max(length, 1));
+        glGetProgramInfoLog(linked, static_cast<GLsizei>(log.size()), nullptr, log.data());
+        std::cerr << "Failed to link shader program: " << log.data() << std::endl;
+        glDeleteProgram(linked);
+        return false;
+    }
+
+    // Shared blocks read whichever buffer is bound at their binding point
+    if (GLProfile::core())
+    {
+        for (const auto &block : UNIFORM_BLOCKS)
+        {
+            GLuint index = glGetUniformBlockIndex(linked, block.name);
+            if (index != GL_INVALID_INDEX)
+            {
+                glUniformBlockBinding(linked, index, block.binding);
+            }
+        }
+    }
+
+    program = linked;
+    failed = false;
+    return true;
+}
@@ -0,0 +1,60 @@
+#ifndef SHADER_PROGRAM_H
+#define SHADER_PROGRAM_H
+
+#include "gl_math.h"
+#include "gl_profile.h"
+#include <GL/glew.h>
+#include <initializer_list>
+
+// Binding points of the uniform blocks that programs share on the core
+// profile; build() ties each block of these names to its point
+enum UniformBlockBinding : GLuint
+{
+    CAMERA_BLOCK = 0,   // Camera: mat4 viewProjection
+    COLORMAP_BLOCK = 1, // Colormap: vec4 colors[256]
+};
+
+// A GLSL program built from vertex and fragment shader source. Shaders are
+// written against GLSL 1.20 so they run on the same context as the
+// fixed-function visualizers; on the core profile build() compiles them
+// as GLSL 3.30 instead, defining CORE_PROFILE. CAMERA_UNIFORMS declares
+// the mat4 viewProjection, which is a plain uniform on the compatibility
+// profile and the Camera block on the core profile.
+class ShaderProgram
+{
+public:
+    ShaderProgram() = default;
+    ~ShaderProgram();
+
+    ShaderProgram(const ShaderProgram &) = delete;
+    ShaderProgram &operator=(const ShaderProgram &) = delete;
+
+    // Compile and link; the attributes get locations 0, 1, ... in order.
+    // Compile and link errors are reported on std::cerr, and after a
+    // failure valid() stays false and later calls return false at once.
+    bool build(const char *vertexSource, const char *fragmentSource,
+               std::initializer_list<const char *> attributes);
+
+    bool valid() const { return program != 0; }
+
+    void use() const { glUseProgram(program); }
+    static void release() { glUseProgram(0); }
+
+    GLint uniform(const char *name) const { return glGetUniformLocation(program, name); }
+
+    // Uniform setters, an int being a sampler's texture unit; the program
+    // must be in use
+    static void set(GLint location, int value) { glUniform1i(location, value); }
+    static void set(GLint location, float value) { glUniform1f(location, value); }
+    static void set(GLint location, float x, float y) { glUniform2f(location, x, y); }
+    static void set(GLint location, float x, float y, float z) { glUniform3f(location, x, y, z); }
+    static void set(GLint location, const Mat4 &matrix) { glUniformMatrix4fv(location, 1, GL_FALSE, matrix.data()); }
+
+private:
+    static GLuint compile(GLenum type, const char *source);
+
+    GLuint program = 0;
+    bool failed = false;
+};
+
+#endif // SHADER_PROGRAM_H
@@ -2,99 +2,236 @@
 #include <cmath>
 #include <algorithm>
 
+// Levels from -60 dB to +60 dB are stored as 0 to 255
+static const float LEVEL_RANGE_DB = 60.0f;
+
+// Pixel format of the history's single channel
+static GLenum historyFormat()
+{
+    return GLProfile::core() ? GL_RED : GL_LUMINANCE;
+}
+
+static const char *WATERFALL_VERTEX_SHADER = R"(#version 120
+CAMERA_UNIFORMS
+attribute vec2 position;
+varying vec2 screen;
+
+void main()
+{
+    screen = position * 0.5 + 0.5;
+    gl_Position = viewProjection * vec4(position, 0.0, 1.0);
+}
+)";
+
+// Time runs left to right from the oldest row to the newest, frequency
+// from the bottom up
+static const char *WATERFALL_FRAGMENT_SHADER = R"(#version 120
+uniform sampler2D history;
+#ifdef CORE_PROFILE
+layout(std140) uniform Colormap
+{
+    vec4 colors[256];
+};
+
+// Interpolated between entries the way the texture filters them
+vec3 colormap(float level)
+{
+    float position = clamp(level * 256.0 - 0.5, 0.0, 255.0);
+    int index = int(position);
+    return mix(colors[index], colors[min(index + 1, 255)], position - float(index)).rgb;
+}
+#else
+uniform sampler1D colormapTexture;
+
+vec3 colormap(float level)
+{
+    return texture1D(colormapTexture, level).rgb;
+}
+#endif
+uniform float newestRow;
+uniform float rows;
+varying vec2 screen;
+
+void main()
+{
+    float row = mod(newestRow + 1.0 + screen.x * (rows - 1.0), rows);
+    float level = texture2D(history, vec2(screen.y, (row + 0.5) / rows)).r;
+    gl_FragColor = vec4(colormap(level), 1.0);
+}
+)";
+
 Spectrogram::Spectrogram()
 {
-    // Initialize Hanning window
-    window.resize(N);
-    for (int i = 0; i < N; i++)
-    {
-        window[i] = 0.5f * (1.0f - std::cos(2.0f * M_PI * i / (N - 1)));
-    }
 }
 
 Spectrogram::~Spectrogram()
 {
+    if (historyTexture)
+    {
+        glDeleteTextures(1, &historyTexture);
+    }
+    if (colormapTexture)
+    {
+        glDeleteTextures(1, &colormapTexture);
+    }
+    if (quadVbo)
+    {
+        glDeleteBuffers(1, &quadVbo);
+    }
 }
 
-void Spectrogram::renderFrame(const std::vector<float> &audioData,
-                              double *fftInputBuffer,
-                              fftw_complex *fftOutputBuffer,
-                              fftw_plan &fftPlan,
+void Spectrogram::renderFrame(const AnalysisFrame &analysis,
                               float timeSeconds)
 {
-    // Calculate the sample index for the current time
-    size_t sampleIndex = static_cast<size_t>(timeSeconds * 44100); // Assuming 44.1kHz
-    if (sampleIndex >= audioData.size())
+    // Mark unused parameters to silence compiler warnings
+    (void)timeSeconds;
+
+    // Nothing to draw once the audio has ended
+    if (!analysis.primary().active)
         return;
 
-    // Apply window function and copy to FFT input buffer
-    for (int i = 0; i < N && (sampleIndex + i) < audioData.size(); i++)
-    {
-        fftInputBuffer[i] = audioData[sampleIndex + i] * window[i];
-    }
+    // Render the spectrum
+    renderSpectrum(analysis.primary());
+}
 
-    // Perform FFT
-    fftw_execute(fftPlan);
+void Spectrogram::renderLiveFrame(const AnalysisFrame &analysis,
+                                  size_t currentPosition)
+{
+    // Mark unused parameters to silence compiler warnings
+    (void)currentPosition;
 
     // Render the spectrum
-    renderSpectrum(fftOutputBuffer);
+    renderSpectrum(analysis.primary());
 }
 
-void Spectrogram::renderLiveFrame(const std::vector<float> &audioData,
-                                  double *fftInputBuffer,
-                                  fftw_complex *fftOutputBuffer,
-                                  fftw_plan &fftPlan,
-                                  size_t currentPosition)
+void Spectrogram::createColormap()
 {
-    // Apply window function and copy to FFT input buffer
-    for (int i = 0; i < N && (currentPosition + i) < audioData.size(); i++)
+    // Blue to red as the level rises, fading to black below -60 dB so
+    // silence stays dark
+    uint8_t colormap[256 * 3];
+    for (int i = 0; i < 256; i++)
     {
-        fftInputBuffer[i] = audioData[currentPosition + i] * window[i];
+        float intensity = i / 255.0f;
+        float brightness = std::min(1.0f, intensity * 2.0f);
+        colormap[i * 3] = static_cast<uint8_t>(255.0f * intensity * brightness);
+        colormap[i * 3 + 1] = static_cast<uint8_t>(255.0f * 0.2f * intensity * brightness);
+        colormap[i * 3 + 2] = static_cast<uint8_t>(255.0f * (1.0f - intensity) * brightness);
     }
 
-    // Perform FFT
-    fftw_execute(fftPlan);
+    if (GLProfile::core())
+    {
+        // std140 pads each array entry to a vec4
+        float colors[256 * 4];
+        for (int i = 0; i < 256; i++)
+        {
+            for (int channel = 0; channel < 3; channel++)
+            {
+                colors[i * 4 + channel] = colormap[i * 3 + channel] / 255.0f;
+            }
+            colors[i * 4 + 3] = 1.0f;
+        }
+        colormapBuffer.update(colors, sizeof(colors));
+        return;
+    }
 
-    // Render the spectrum
-    renderSpectrum(fftOutputBuffer);
+    glGenTextures(1, &colormapTexture);
+    glBindTexture(GL_TEXTURE_1D, colormapTexture);
+    glTexParameteri(GL_TEXTURE_1D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_1D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_1D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexImage1D(GL_TEXTURE_1D, 0, GL_RGB8, 256, 0, GL_RGB, GL_UNSIGNED_BYTE, colormap);
+    glBindTexture(GL_TEXTURE_1D, 0);
 }
 
-void Spectrogram::renderSpectrum(const fftw_complex *fftData)
+void Spectrogram::createTextures(int bins)
 {
-    // We only need the first N/2 + 1 points due to symmetry
-    const int numPoints = N / 2 + 1;
+    // A new FFT size starts the history over
+    if (!historyTexture)
+    {
+        glGenTextures(1, &historyTexture);
+    }
+    glBindTexture(GL_TEXTURE_2D, historyTexture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+
+    // One byte per level; the core profile has no luminance formats
+    std::vector<uint8_t> silence(static_cast<size_t>(bins) * HISTORY_FRAMES, 0);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexImage2D(GL_TEXTURE_2D, 0, GLProfile::core() ? GL_R8 : GL_LUMINANCE8, bins, HISTORY_FRAMES, 0,
+                 historyFormat(), GL_UNSIGNED_BYTE, silence.data());
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    historyBins = bins;
+    newestRow = HISTORY_FRAMES - 1;
+}
 
-    // Set color gradient from blue to red
-    glBegin(GL_TRIANGLE_STRIP);
+void Spectrogram::renderSpectrum(const SourceSpectrum &spectrum)
+{
+    // The Nyquist bin is left out, keeping a 4096-point FFT at 2048 texels
+    const int bins = static_cast<int>(spectrum.decibels.size()) - 1;
+    if (bins < 1 || !shader.build(WATERFALL_VERTEX_SHADER, WATERFALL_FRAGMENT_SHADER, {"position"}))
+        return;
 
-    // Add bottom vertices for filled area (at y = -1)
-    glColor3f(0.0f, 0.0f, 0.1f); // Dark blue at the bottom
-    glVertex2f(-1.0f, -1.0f);
+    if (!quadVbo)
+    {
+        static const float QUAD[8] = {-1.0f, -1.0f, 1.0f, -1.0f, 1.0f, 1.0f, -1.0f, 1.0f};
+        glGenBuffers(1, &quadVbo);
+        glBindBuffer(GL_ARRAY_BUFFER, quadVbo);
+        glBufferData(GL_ARRAY_BUFFER, sizeof(QUAD), QUAD, GL_STATIC_DRAW);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        quad.attribute(0, quadVbo, 2);
+        createColormap();
+    }
+    if (bins != historyBins)
+    {
+        createTextures(bins);
+    }
 
-    // Calculate magnitudes and render spectrum
-    for (int i = 0; i < numPoints; i++)
+    // Quantize this frame's levels into the next row of the ring
+    levels.resize(bins);
+    for (int i = 0; i < bins; i++)
+    {
+        float level = std::max(-1.0f, std::min(1.0f, spectrum.decibels[i] / LEVEL_RANGE_DB));
+        levels[i] = static_cast<uint8_t>((level + 1.0f) * 127.5f);
+    }
+    newestRow = (newestRow + 1) % HISTORY_FRAMES;
+
+    glBindTexture(GL_TEXTURE_2D, historyTexture);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, newestRow, bins, 1, historyFormat(), GL_UNSIGNED_BYTE, levels.data());
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+    shader.use();
+    camera.set(orthoMatrix(-1.0f, 1.0f, -1.0f, 1.0f, -1.0f, 1.0f));
+    camera.apply(shader);
+    ShaderProgram::set(shader.uniform("history"), 0);
+    ShaderProgram::set(shader.uniform("newestRow"), static_cast<float>(newestRow));
+    ShaderProgram::set(shader.uniform("rows"), static_cast<float>(HISTORY_FRAMES));
+    if (GLProfile::core())
     {
-        // Calculate frequency bin position
-        float x = -1.0f + 2.0f * i / (float)(numPoints - 1);
-
-        // Calculate magnitude (using log scale for better visualization)
-        float re = fftData[i][0];
-        float im = fftData[i][1];
-        float magnitude = std::sqrt(re * re + im * im);
-        float dB = 20.0f * std::log10(magnitude + 1e-6f); // Add small value to avoid log(0)
-
-        // Normalize to [-1, 1] range
-        float y = std::max(-1.0f, std::min(1.0f, dB / 60.0f)); // Assuming typical range of -60dB to 0dB
-
-        // Calculate color based on magnitude (blue to red gradient)
-        float intensity = (y + 1.0f) / 2.0f; // Map [-1,1] to [0,1]
-        glColor3f(intensity, 0.2f * intensity, 1.0f - intensity);
-
-        // Add bottom vertex for filled area
-        glVertex2f(x, -1.0f);
-        // Add top vertex for spectrum
-        glVertex2f(x, y);
+        colormapBuffer.bind();
     }
+    else
+    {
+        glActiveTexture(GL_TEXTURE1);
+        glBindTexture(GL_TEXTURE_1D, colormapTexture);
+        glActiveTexture(GL_TEXTURE0);
+        ShaderProgram::set(shader.uniform("colormapTexture"), 1);
+    }
+
+    quad.bind();
+    glDrawArrays(GL_TRIANGLE_FAN, 0, 4);
+    quad.unbind();
 
-    glEnd();
-}
\ No newline at end of file
+    ShaderProgram::release();
+    if (!GLProfile::core())
+    {
+        glActiveTexture(GL_TEXTURE1);
+        glBindTexture(GL_TEXTURE_1D, 0);
+        glActiveTexture(GL_TEXTURE0);
+    }
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
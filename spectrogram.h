@@ -2,6 +2,10 @@
 #define SPECTROGRAM_H
 
 #include "visualizer_base.h"
+#include "shader_program.h"
+#include "uniform_buffer.h"
+#include "vertex_array.h"
+#include <cstdint>
 #include <vector>
 
 class Spectrogram : public Visualizer
@@ -10,22 +14,40 @@ public:
     Spectrogram();
     ~Spectrogram() override;
 
-    void renderFrame(const std::vector<float> &audioData,
-                     double *fftInputBuffer,
-                     fftw_complex *fftOutputBuffer,
-                     fftw_plan &fftPlan,
+    bool supportsCoreProfile() const override { return true; }
+
+    void renderFrame(const AnalysisFrame &analysis,
                      float timeSeconds) override;
 
-    void renderLiveFrame(const std::vector<float> &audioData,
-                         double *fftInputBuffer,
-                         fftw_complex *fftOutputBuffer,
-                         fftw_plan &fftPlan,
+    void renderLiveFrame(const AnalysisFrame &analysis,
                          size_t currentPosition) override;
 
+    // Full-window spectrum, so use finer bins than the shared default
+    int preferredFFTSize() const override { return 4096; }
+
 private:
-    void renderSpectrum(const fftw_complex *fftData);
-    const int N = 1024;        // FFT size
-    std::vector<float> window; // Hanning window for better frequency resolution
+    void renderSpectrum(const SourceSpectrum &spectrum);
+    void createColormap();
+    void createTextures(int bins);
+
+    // One minute of history at 30 frames per second
+    static constexpr int HISTORY_FRAMES = 1800;
+
+    // Waterfall of past spectra in a ring texture: one row per frame with
+    // the bins across, so each frame uploads a single row and the shader
+    // turns it into a time-frequency heat map through the colormap. The
+    // colormap is a 1D texture on the compatibility profile and a uniform
+    // block on the core profile.
+    ShaderProgram shader;
+    GLuint historyTexture = 0;
+    GLuint colormapTexture = 0;
+    UniformBuffer colormapBuffer{COLORMAP_BLOCK};
+    CameraUniforms camera;
+    GLuint quadVbo = 0;
+    VertexArray quad;
+    int historyBins = 0;
+    int newestRow = 0;
+    std::vector<uint8_t> levels;
 };
 
 #endif // SPECTROGRAM_H
\ No newline at end of file
@@ -0,0 +1,369 @@
+#include "spectrum_analyzer.h"
+#include "fft_planner.h"
+#include "spectrum_kernels.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+// IEEE 754 half precision conversion for the precomputed magnitude matrix
+static uint16_t floatToHalf(float value)
+{
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+
+    uint32_t sign = (bits >> 16) & 0x8000;
+    int32_t exponent = static_cast<int32_t>((bits >> 23) & 0xff) - 127 + 15;
+    uint32_t mantissa = bits & 0x7fffff;
+
+    if (exponent >= 31)
+        return static_cast<uint16_t>(sign | 0x7c00); // Saturate to infinity
+
+    if (exponent <= 0)
+    {
+        if (exponent < -10)
+            return static_cast<uint16_t>(sign); // Too small, flush to zero
+
+        // Subnormal half: shift the implicit leading one into the mantissa
+        mantissa |= 0x800000;
+        int shift = 14 - exponent;
+        uint32_t half = mantissa >> shift;
+        if ((mantissa >> (shift - 1)) & 1)
+            half++;
+        return static_cast<uint16_t>(sign | half);
+    }
+
+    uint32_t half = sign | (static_cast<uint32_t>(exponent) << 10) | (mantissa >> 13);
+    if (mantissa & 0x1000)
+        half++; // Round to nearest, a carry into the exponent is still correct
+    return static_cast<uint16_t>(half);
+}
+
+static float halfToFloat(uint16_t half)
+{
+    uint32_t sign = static_cast<uint32_t>(half & 0x8000) << 16;
+    uint32_t exponent = (half >> 10) & 0x1f;
+    uint32_t mantissa = half & 0x3ff;
+
+    if (exponent == 0)
+    {
+        // Zero or subnormal
+        float value = std::ldexp(static_cast<float>(mantissa), -24);
+        return sign ? -value : value;
+    }
+
+    uint32_t bits;
+    if (exponent == 31)
+        bits = sign | 0x7f800000 | (mantissa << 13);
+    else
+        bits = sign | ((exponent + 112) << 23) | (mantissa << 13);
+
+    float value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+float SourceSpectrum::bandAverage(int startBin, int endBin) const
+{
+    const int numBins = static_cast<int>(magnitudes.size());
+    startBin = std::max(0, std::min(startBin, numBins));
+    endBin = std::max(startBin, std::min(endBin, numBins));
+    if (endBin == startBin)
+        return 0.0f;
+
+    return (cumulative[endBin] - cumulative[startBin]) / (endBin - startBin);
+}
+
+int AnalysisFrame::binForFrequency(float frequency) const
+{
+    int bin = static_cast<int>((frequency * fftSize) / sampleRate);
+    return std::max(0, std::min(bin, fftSize / 2));
+}
+
+SpectrumAnalyzer::SpectrumAnalyzer(int fftSize, int sampleRate) : fftSize(fftSize), buffers(fftSize)
+{
+    // Initialize Hanning window. A tone's peak magnitude grows with the
+    // transform size, so scaling the window keeps it size-independent.
+    const float scale = static_cast<float>(REFERENCE_FFT_SIZE) / fftSize;
+    window.resize(fftSize);
+    for (int i = 0; i < fftSize; i++)
+    {
+        window[i] = scale * 0.5f * (1.0f - std::cos(2.0f * M_PI * i / (fftSize - 1)));
+    }
+
+    frame.fftSize = fftSize;
+    frame.sampleRate = sampleRate;
+}
+
+SpectrumAnalyzer::~SpectrumAnalyzer()
+{
+    waitForPrecompute();
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (std::thread &worker : workers)
+    {
+        worker.join();
+    }
+}
+
+void SpectrumAnalyzer::ensurePlan()
+{
+    if (!plan)
+    {
+        plan = &FFTPlanner::plan(fftSize, FFTKind::RealToComplex);
+    }
+}
+
+const AnalysisFrame &SpectrumAnalyzer::analyze(const AudioSourceList &audioSources, size_t position)
+{
+    if (cacheValid && cachedSources == &audioSources &&
+        cachedSourceCount == audioSources.size() && frame.position == position)
+    {
+        return frame;
+    }
+
+    frame.position = position;
+    frame.sources.resize(std::max<size_t>(1, audioSources.size()));
+
+    if (loadPrecomputed(audioSources, position))
+    {
+        // Read from the precomputed matrix, no FFT needed
+    }
+    else if (audioSources.empty())
+    {
+        // No audio loaded: report a single silent source
+        analyzeSource(nullptr, position, frame.sources[0]);
+    }
+    else
+    {
+        for (size_t i = 0; i < audioSources.size(); i++)
+        {
+            analyzeSource(audioSources[i].get(), position, frame.sources[i]);
+        }
+    }
+
+    cachedSources = &audioSources;
+    cachedSourceCount = audioSources.size();
+    cacheValid = true;
+    return frame;
+}
+
+const AnalysisFrame &SpectrumAnalyzer::analyze(const std::vector<AudioView> &blocks, size_t position)
+{
+    cacheValid = false;
+    frame.position = position;
+    frame.sources.resize(std::max<size_t>(1, blocks.size()));
+
+    for (size_t i = 0; i < frame.sources.size(); i++)
+    {
+        SourceSpectrum &result = frame.sources[i];
+        result.magnitudes.resize(fftSize / 2 + 1);
+        result.samples = i < blocks.size() ? blocks[i] : AudioView(static_cast<const float *>(nullptr), 0, fftSize);
+        result.active = result.samples.available() > 0;
+        ensurePlan();
+        transformBlock(result.samples, buffers, result.magnitudes.data(), result.level);
+        deriveSpectrum(result);
+    }
+    return frame;
+}
+
+// Positions a worker claims at a time; every row is written by exactly one
+// worker so the result does not depend on scheduling
+static const size_t PRECOMPUTE_CHUNK = 8;
+
+void SpectrumAnalyzer::precompute(const AudioSourceList &audioSources, const std::vector<size_t> &positions)
+{
+    // The previous batch is complete once no worker is running
+    waitForPrecompute();
+    std::swap(precomputed, pending);
+    cacheValid = false;
+
+    pending.sources = &audioSources;
+    pending.positions = positions;
+    std::sort(pending.positions.begin(), pending.positions.end());
+    pending.positions.erase(std::unique(pending.positions.begin(), pending.positions.end()),
+                            pending.positions.end());
+
+    const size_t numRows = pending.positions.size() * audioSources.size();
+    pending.magnitudes.assign(numRows * (fftSize / 2 + 1), 0);
+    pending.levels.assign(numRows, 0.0f);
+    if (numRows == 0)
+        return;
+
+    // Workers share the one plan, which is safe to execute concurrently on
+    // separate buffers. One core is left for the render loop.
+    ensurePlan();
+    if (workers.empty())
+    {
+        size_t threads = std::max(2u, std::thread::hardware_concurrency()) - 1;
+        for (size_t t = 0; t < threads; t++)
+        {
+            workerBuffers.emplace_back(fftSize);
+        }
+        for (size_t t = 0; t < threads; t++)
+        {
+            workers.emplace_back(&SpectrumAnalyzer::precomputeLoop, this, t);
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        nextPosition = 0;
+        running = workers.size();
+        generation++;
+    }
+    wake.notify_all();
+}
+
+void SpectrumAnalyzer::waitForPrecompute()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    finished.wait(lock, [this]
+                  { return running == 0; });
+}
+
+void SpectrumAnalyzer::precomputeLoop(size_t worker)
+{
+    const int numBins = fftSize / 2 + 1;
+    std::vector<float> storage;
+    std::vector<float> magnitudes(numBins);
+    uint64_t seen = 0;
+
+    for (;;)
+    {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [&]
+                      { return stopping || generation != seen; });
+            if (stopping)
+                return;
+            seen = generation;
+        }
+
+        // The render thread leaves pending alone until every worker is done
+        const AudioSourceList &audioSources = *pending.sources;
+        const size_t numSources = audioSources.size();
+        const size_t numPositions = pending.positions.size();
+        for (;;)
+        {
+            size_t begin = nextPosition.fetch_add(PRECOMPUTE_CHUNK);
+            if (begin >= numPositions)
+                break;
+            size_t end = std::min(begin + PRECOMPUTE_CHUNK, numPositions);
+
+            for (size_t p = begin; p < end; p++)
+            {
+                for (size_t s = 0; s < numSources; s++)
+                {
+                    size_t row = p * numSources + s;
+                    AudioView samples = fetchBlock(audioSources[s].get(), pending.positions[p], storage);
+                    transformBlock(samples, workerBuffers[worker], magnitudes.data(), pending.levels[row]);
+
+                    uint16_t *dest = &pending.magnitudes[row * numBins];
+                    for (int k = 0; k < numBins; k++)
+                    {
+                        dest[k] = floatToHalf(magnitudes[k]);
+                    }
+                }
+            }
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (--running == 0)
+                finished.notify_all();
+        }
+    }
+}
+
+bool SpectrumAnalyzer::loadPrecomputed(const AudioSourceList &audioSources, size_t position)
+{
+    if (precomputed.sources != &audioSources || audioSources.empty())
+        return false;
+
+    auto it = std::lower_bound(precomputed.positions.begin(), precomputed.positions.end(), position);
+    if (it == precomputed.positions.end() || *it != position)
+        return false;
+
+    const size_t numSources = audioSources.size();
+    const int numBins = fftSize / 2 + 1;
+    const size_t p = static_cast<size_t>(it - precomputed.positions.begin());
+    if ((p + 1) * numSources * numBins > precomputed.magnitudes.size())
+        return false; // Sources were added after the precompute
+
+    for (size_t s = 0; s < numSources; s++)
+    {
+        SourceSpectrum &result = frame.sources[s];
+        size_t row = p * numSources + s;
+        const uint16_t *src = &precomputed.magnitudes[row * numBins];
+
+        result.magnitudes.resize(numBins);
+        for (int k = 0; k < numBins; k++)
+        {
+            result.magnitudes[k] = halfToFloat(src[k]);
+        }
+        result.level = precomputed.levels[row];
+        result.active = position < audioSources[s]->length();
+        result.samples = fetchBlock(audioSources[s].get(), position, result.sampleStorage);
+        deriveSpectrum(result);
+    }
+    return true;
+}
+
+void SpectrumAnalyzer::analyzeSource(AudioSource *source, size_t position, SourceSpectrum &result)
+{
+    result.magnitudes.resize(fftSize / 2 + 1);
+    result.active = source && position < source->length();
+    result.samples = fetchBlock(source, position, result.sampleStorage);
+    ensurePlan();
+    transformBlock(result.samples, buffers, result.magnitudes.data(), result.level);
+    deriveSpectrum(result);
+}
+
+AudioView SpectrumAnalyzer::fetchBlock(AudioSource *source, size_t position, std::vector<float> &storage) const
+{
+    // Without a source the block is all silence
+    if (!source)
+        return AudioView(static_cast<const float *>(nullptr), 0, fftSize);
+
+    return source->fetch(position, fftSize, storage);
+}
+
+void SpectrumAnalyzer::transformBlock(const AudioView &samples, const FFTBuffers &fft,
+                                      float *magnitudes, float &level) const
+{
+    // Apply the window; the view reads as zero past the end of the source,
+    // which pads the last block
+    float levelSum = 0.0f;
+    for (int i = 0; i < fftSize; i++)
+    {
+        float sample = samples[i];
+        levelSum += std::fabs(sample);
+        fft.real()[i] = sample * window[i];
+    }
+    level = samples.available() > 0 ? levelSum / samples.available() : 0.0f;
+
+    plan->execute(fft);
+
+    SpectrumKernels::get().magnitude(fft.complex(), magnitudes, fftSize / 2 + 1);
+}
+
+void SpectrumAnalyzer::deriveSpectrum(SourceSpectrum &result)
+{
+    const size_t numBins = result.magnitudes.size();
+    result.decibels.resize(numBins);
+    result.logMagnitudes.resize(numBins);
+    result.cumulative.resize(numBins + 1);
+
+    const SpectrumKernels &kernels = SpectrumKernels::get();
+    kernels.decibels(result.magnitudes.data(), result.decibels.data(), numBins);
+    kernels.logCompress(result.magnitudes.data(), result.logMagnitudes.data(), numBins);
+
+    result.cumulative[0] = 0.0f;
+    for (size_t k = 0; k < numBins; k++)
+    {
+        result.cumulative[k + 1] = result.cumulative[k] + result.magnitudes[k];
+    }
+}
@@ -0,0 +1,126 @@
+#ifndef SPECTRUM_ANALYZER_H
+#define SPECTRUM_ANALYZER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "audio_source.h"
+#include "fft_planner.h"
+
+// Spectrum of a single audio source at the analysis position
+struct SourceSpectrum
+{
+    bool active = false;              // False once the position is past the end of the source
+    float level = 0.0f;               // Mean absolute sample value over the analysis block
+    AudioView samples;                // Raw analysis block, silent past the end of the source
+    std::vector<float> sampleStorage; // Backs samples when the source cannot hand out views
+    std::vector<float> magnitudes;    // |X[k]| of the Hann-windowed block, k in [0, N/2]
+    std::vector<float> decibels;      // 20 * log10(|X[k]| + 1e-6)
+    std::vector<float> logMagnitudes; // log10(1 + |X[k]|)
+    std::vector<float> cumulative;    // Prefix sums of magnitudes for O(1) band aggregates
+
+    // Average magnitude over the bins [startBin, endBin)
+    float bandAverage(int startBin, int endBin) const;
+};
+
+// Read-only result of one analysis pass, shared by every visualizer in a frame
+struct AnalysisFrame
+{
+    size_t position = 0; // Sample index the analysis block starts at
+    int fftSize = 0;
+    int sampleRate = 0;
+    std::vector<SourceSpectrum> sources; // One entry per source, always at least one
+
+    int numBins() const { return fftSize / 2 + 1; }
+    int binForFrequency(float frequency) const;
+    const SourceSpectrum &primary() const { return sources[0]; }
+};
+
+// Owns the FFT and computes windowing, magnitudes, dB and band aggregates
+// once per frame for all sources, instead of once per visualizer.
+// Magnitudes are scaled to what a REFERENCE_FFT_SIZE-point transform gives
+// for the same tone, so visualizers tuned for that size work at any size.
+class SpectrumAnalyzer
+{
+public:
+    static const int REFERENCE_FFT_SIZE = 1024;
+
+    explicit SpectrumAnalyzer(int fftSize = 1024, int sampleRate = 44100);
+    ~SpectrumAnalyzer();
+
+    SpectrumAnalyzer(const SpectrumAnalyzer &) = delete;
+    SpectrumAnalyzer &operator=(const SpectrumAnalyzer &) = delete;
+
+    // Analyze every source starting at the given sample position. Repeated
+    // calls for the same sources and position return the cached frame.
+    const AnalysisFrame &analyze(const AudioSourceList &audioSources, size_t position);
+
+    // Analyze blocks that were already assembled elsewhere, e.g. from the
+    // samples live playback just played. Blocks with no available samples
+    // are reported as inactive. Never cached.
+    const AnalysisFrame &analyze(const std::vector<AudioView> &blocks, size_t position);
+
+    // Start analyzing every source at each of the given positions on the
+    // worker pool, and return without waiting. The batch started by the
+    // previous call is waited for first and becomes the one analyze() reads,
+    // replacing the batch before it, so a caller that starts batch k + 1 as
+    // it begins drawing batch k keeps the workers one batch ahead. analyze()
+    // calls for those positions only read the stored float16 magnitudes.
+    void precompute(const AudioSourceList &audioSources, const std::vector<size_t> &positions);
+
+    // Block until the batch in flight, if any, is done. The workers read
+    // the sources, so call this before the sources go away.
+    void waitForPrecompute();
+
+    int getFFTSize() const { return fftSize; }
+
+private:
+    void analyzeSource(AudioSource *source, size_t position, SourceSpectrum &result);
+    AudioView fetchBlock(AudioSource *source, size_t position, std::vector<float> &storage) const;
+    void ensurePlan();
+    void transformBlock(const AudioView &samples, const FFTBuffers &fft, float *magnitudes, float &level) const;
+    bool loadPrecomputed(const AudioSourceList &audioSources, size_t position);
+    static void deriveSpectrum(SourceSpectrum &result);
+
+    const int fftSize;
+    std::vector<float> window; // Hann window with the magnitude scale folded in, computed once
+    FFTBuffers buffers;
+    const FFTPlan *plan = nullptr; // Fetched on first use, after main() has loaded the wisdom cache
+
+    AnalysisFrame frame;
+    const AudioSourceList *cachedSources = nullptr;
+    size_t cachedSourceCount = 0;
+    bool cacheValid = false;
+
+    // Position x source x bin magnitude matrix, stored as float16
+    struct PrecomputedBatch
+    {
+        const AudioSourceList *sources = nullptr;
+        std::vector<size_t> positions; // Sorted, one row per position
+        std::vector<uint16_t> magnitudes;
+        std::vector<float> levels;
+    };
+
+    void precomputeLoop(size_t worker);
+
+    PrecomputedBatch precomputed; // Read by analyze()
+    PrecomputedBatch pending;     // Filled by the workers meanwhile
+
+    // Worker pool, started on the first precompute() and kept until
+    // destruction; each batch bumps the generation to wake the workers
+    std::vector<std::thread> workers;
+    std::vector<FFTBuffers> workerBuffers;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable finished;
+    std::atomic<size_t> nextPosition{0};
+    uint64_t generation = 0;
+    size_t running = 0;
+    bool stopping = false;
+};
+
+#endif // SPECTRUM_ANALYZER_H
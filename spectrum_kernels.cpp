@@ -0,0 +1,381 @@
+#include "spectrum_kernels.h"
+#include <cmath>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define SPECTRUM_KERNELS_X86 1
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#define SPECTRUM_KERNELS_NEON 1
+#endif
+
+// Scale factors turning a natural log into the two log10 outputs
+static const float DB_SCALE = 20.0f / 2.302585093f; // 20 / ln(10)
+static const float LOG10_SCALE = 1.0f / 2.302585093f;
+static const float DB_FLOOR = 1e-6f;
+
+// Cephes logf: split x into mantissa m in [sqrt(1/2), sqrt(2)) and exponent
+// e, then ln(x) = e * ln(2) + ln(m), with ln(m) from a degree-9 polynomial.
+// Good to about 1 ulp for positive normal inputs, which is all these kernels
+// ever see (magnitudes plus a positive offset).
+static const float LOG_SQRTHF = 0.707106781186547524f;
+static const float LOG_P0 = 7.0376836292E-2f;
+static const float LOG_P1 = -1.1514610310E-1f;
+static const float LOG_P2 = 1.1676998740E-1f;
+static const float LOG_P3 = -1.2420140846E-1f;
+static const float LOG_P4 = 1.4249322787E-1f;
+static const float LOG_P5 = -1.6668057665E-1f;
+static const float LOG_P6 = 2.0000714765E-1f;
+static const float LOG_P7 = -2.4999993993E-1f;
+static const float LOG_P8 = 3.3333331174E-1f;
+static const float LOG_Q1 = -2.12194440e-4f;
+static const float LOG_Q2 = 0.693359375f;
+
+// Scalar reference implementations
+
+static void magnitudeScalar(const fftwf_complex *bins, float *out, size_t count)
+{
+    for (size_t k = 0; k < count; k++)
+    {
+        out[k] = std::sqrt(bins[k][0] * bins[k][0] + bins[k][1] * bins[k][1]);
+    }
+}
+
+static void powerScalar(const fftwf_complex *bins, float *out, size_t count)
+{
+    for (size_t k = 0; k < count; k++)
+    {
+        out[k] = bins[k][0] * bins[k][0] + bins[k][1] * bins[k][1];
+    }
+}
+
+static void decibelsScalar(const float *magnitudes, float *out, size_t count)
+{
+    for (size_t k = 0; k < count; k++)
+    {
+        out[k] = 20.0f * std::log10(magnitudes[k] + DB_FLOOR);
+    }
+}
+
+static void logCompressScalar(const float *magnitudes, float *out, size_t count)
+{
+    for (size_t k = 0; k < count; k++)
+    {
+        out[k] = std::log10(1.0f + magnitudes[k]);
+    }
+}
+
+static const SpectrumKernels scalarKernels = {
+    "scalar", magnitudeScalar, powerScalar, decibelsScalar, logCompressScalar};
+
+#if SPECTRUM_KERNELS_X86 && defined(__SSE2__)
+
+// SSE2, the x86-64 baseline
+
+static inline __m128 logSse2(__m128 x)
+{
+    const __m128 one = _mm_set1_ps(1.0f);
+
+    __m128i exponent = _mm_sub_epi32(_mm_srli_epi32(_mm_castps_si128(x), 23), _mm_set1_epi32(126));
+    __m128 m = _mm_or_ps(_mm_and_ps(x, _mm_castsi128_ps(_mm_set1_epi32(0x007FFFFF))), _mm_set1_ps(0.5f));
+    __m128 e = _mm_cvtepi32_ps(exponent);
+
+    // Move m from [0.5, sqrt(1/2)) up to [1, sqrt(2)) and adjust e to match
+    __m128 small = _mm_cmplt_ps(m, _mm_set1_ps(LOG_SQRTHF));
+    e = _mm_sub_ps(e, _mm_and_ps(one, small));
+    m = _mm_add_ps(_mm_sub_ps(m, one), _mm_and_ps(m, small));
+
+    __m128 z = _mm_mul_ps(m, m);
+    __m128 y = _mm_set1_ps(LOG_P0);
+    y = _mm_add_ps(_mm_mul_ps(y, m), _mm_set1_ps(LOG_P1));
+    y = _mm_add_ps(_mm_mul_ps(y, m), _mm_set1_ps(LOG_P2));
+    y = _mm_add_ps(_mm_mul_ps(y, m), _mm_set1_ps(LOG_P3));
+    y = _mm_add_ps(_mm_mul_ps(y, m), _mm_set1_ps(LOG_P4));
+    y = _mm_add_ps(_mm_mul_ps(y, m), _mm_set1_ps(LOG_P5));
+    y = _mm_add_ps(_mm_mul_ps(y, m), _mm_set1_ps(LOG_P6));
+    y = _mm_add_ps(_mm_mul_ps(y, m), _mm_set1_ps(LOG_P7));
+    y = _mm_add_ps(_mm_mul_ps(y, m), _mm_set1_ps(LOG_P8));
+    y = _mm_mul_ps(_mm_mul_ps(y, m), z);
+
+    y = _mm_add_ps(y, _mm_mul_ps(e, _mm_set1_ps(LOG_Q1)));
+    y = _mm_sub_ps(y, _mm_mul_ps(z, _mm_set1_ps(0.5f)));
+    return _mm_add_ps(_mm_add_ps(m, y), _mm_mul_ps(e, _mm_set1_ps(LOG_Q2)));
+}
+
+// Squared magnitudes of four bins, in bin order
+static inline __m128 binPowerSse2(const float *pairs)
+{
+    __m128 a = _mm_loadu_ps(pairs);     // re0 im0 re1 im1
+    __m128 b = _mm_loadu_ps(pairs + 4); // re2 im2 re3 im3
+    __m128 re = _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0));
+    __m128 im = _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1));
+    return _mm_add_ps(_mm_mul_ps(re, re), _mm_mul_ps(im, im));
+}
+
+static void magnitudeSse2(const fftwf_complex *bins, float *out, size_t count)
+{
+    const float *pairs = &bins[0][0];
+    size_t k = 0;
+    for (; k + 4 <= count; k += 4)
+    {
+        _mm_storeu_ps(out + k, _mm_sqrt_ps(binPowerSse2(pairs + 2 * k)));
+    }
+    magnitudeScalar(bins + k, out + k, count - k);
+}
+
+static void powerSse2(const fftwf_complex *bins, float *out, size_t count)
+{
+    const float *pairs = &bins[0][0];
+    size_t k = 0;
+    for (; k + 4 <= count; k += 4)
+    {
+        _mm_storeu_ps(out + k, binPowerSse2(pairs + 2 * k));
+    }
+    powerScalar(bins + k, out + k, count - k);
+}
+
+static void decibelsSse2(const float *magnitudes, float *out, size_t count)
+{
+    size_t k = 0;
+    for (; k + 4 <= count; k += 4)
+    {
+        __m128 x = _mm_add_ps(_mm_loadu_ps(magnitudes + k), _mm_set1_ps(DB_FLOOR));
+        _mm_storeu_ps(out + k, _mm_mul_ps(logSse2(x), _mm_set1_ps(DB_SCALE)));
+    }
+    decibelsScalar(magnitudes + k, out + k, count - k);
+}
+
+static void logCompressSse2(const float *magnitudes, float *out, size_t count)
+{
+    size_t k = 0;
+    for (; k + 4 <= count; k += 4)
+    {
+        __m128 x = _mm_add_ps(_mm_loadu_ps(magnitudes + k), _mm_set1_ps(1.0f));
+        _mm_storeu_ps(out + k, _mm_mul_ps(logSse2(x), _mm_set1_ps(LOG10_SCALE)));
+    }
+    logCompressScalar(magnitudes + k, out + k, count - k);
+}
+
+static const SpectrumKernels sse2Kernels = {
+    "sse2", magnitudeSse2, powerSse2, decibelsSse2, logCompressSse2};
+
+#endif
+
+#if SPECTRUM_KERNELS_X86 && (defined(__GNUC__) || defined(__clang__))
+
+// AVX2 + FMA, compiled for that target only and picked after a CPUID check
+#define SPECTRUM_KERNELS_AVX2 1
+#define AVX2_TARGET __attribute__((target("avx2,fma")))
+
+AVX2_TARGET static inline __m256 logAvx2(__m256 x)
+{
+    const __m256 one = _mm256_set1_ps(1.0f);
+
+    __m256i exponent = _mm256_sub_epi32(_mm256_srli_epi32(_mm256_castps_si256(x), 23), _mm256_set1_epi32(126));
+    __m256 m = _mm256_or_ps(_mm256_and_ps(x, _mm256_castsi256_ps(_mm256_set1_epi32(0x007FFFFF))),
+                            _mm256_set1_ps(0.5f));
+    __m256 e = _mm256_cvtepi32_ps(exponent);
+
+    __m256 small = _mm256_cmp_ps(m, _mm256_set1_ps(LOG_SQRTHF), _CMP_LT_OQ);
+    e = _mm256_sub_ps(e, _mm256_and_ps(one, small));
+    m = _mm256_add_ps(_mm256_sub_ps(m, one), _mm256_and_ps(m, small));
+
+    __m256 z = _mm256_mul_ps(m, m);
+    __m256 y = _mm256_set1_ps(LOG_P0);
+    y = _mm256_fmadd_ps(y, m, _mm256_set1_ps(LOG_P1));
+    y = _mm256_fmadd_ps(y, m, _mm256_set1_ps(LOG_P2));
+    y = _mm256_fmadd_ps(y, m, _mm256_set1_ps(LOG_P3));
+    y = _mm256_fmadd_ps(y, m, _mm256_set1_ps(LOG_P4));
+    y = _mm256_fmadd_ps(y, m, _mm256_set1_ps(LOG_P5));
+    y = _mm256_fmadd_ps(y, m, _mm256_set1_ps(LOG_P6));
+    y = _mm256_fmadd_ps(y, m, _mm256_set1_ps(LOG_P7));
+    y = _mm256_fmadd_ps(y, m, _mm256_set1_ps(LOG_P8));
+    y = _mm256_mul_ps(_mm256_mul_ps(y, m), z);
+
+    y = _mm256_fmadd_ps(e, _mm256_set1_ps(LOG_Q1), y);
+    y = _mm256_fnmadd_ps(z, _mm256_set1_ps(0.5f), y);
+    return _mm256_fmadd_ps(e, _mm256_set1_ps(LOG_Q2), _mm256_add_ps(m, y));
+}
+
+// Squared magnitudes of eight bins, in bin order
+AVX2_TARGET static inline __m256 binPowerAvx2(const float *pairs)
+{
+    __m256 a = _mm256_loadu_ps(pairs);     // re0 im0 .. re3 im3
+    __m256 b = _mm256_loadu_ps(pairs + 8); // re4 im4 .. re7 im7
+    // Shuffles work per 128-bit lane, leaving bins as 0 1 4 5 | 2 3 6 7
+    __m256 re = _mm256_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0));
+    __m256 im = _mm256_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1));
+    __m256 power = _mm256_fmadd_ps(im, im, _mm256_mul_ps(re, re));
+    return _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(power), _MM_SHUFFLE(3, 1, 2, 0)));
+}
+
+AVX2_TARGET static void magnitudeAvx2(const fftwf_complex *bins, float *out, size_t count)
+{
+    const float *pairs = &bins[0][0];
+    size_t k = 0;
+    for (; k + 8 <= count; k += 8)
+    {
+        _mm256_storeu_ps(out + k, _mm256_sqrt_ps(binPowerAvx2(pairs + 2 * k)));
+    }
+    magnitudeScalar(bins + k, out + k, count - k);
+}
+
+AVX2_TARGET static void powerAvx2(const fftwf_complex *bins, float *out, size_t count)
+{
+    const float *pairs = &bins[0][0];
+    size_t k = 0;
+    for (; k + 8 <= count; k += 8)
+    {
+        _mm256_storeu_ps(out + k, binPowerAvx2(pairs + 2 * k));
+    }
+    powerScalar(bins + k, out + k, count - k);
+}
+
+AVX2_TARGET static void decibelsAvx2(const float *magnitudes, float *out, size_t count)
+{
+    size_t k = 0;
+    for (; k + 8 <= count; k += 8)
+    {
+        __m256 x = _mm256_add_ps(_mm256_loadu_ps(magnitudes + k), _mm256_set1_ps(DB_FLOOR));
+        _mm256_storeu_ps(out + k, _mm256_mul_ps(logAvx2(x), _mm256_set1_ps(DB_SCALE)));
+    }
+    decibelsScalar(magnitudes + k, out + k, count - k);
+}
+
+AVX2_TARGET static void logCompressAvx2(const float *magnitudes, float *out, size_t count)
+{
+    size_t k = 0;
+    for (; k + 8 <= count; k += 8)
+    {
+        __m256 x = _mm256_add_ps(_mm256_loadu_ps(magnitudes + k), _mm256_set1_ps(1.0f));
+        _mm256_storeu_ps(out + k, _mm256_mul_ps(logAvx2(x), _mm256_set1_ps(LOG10_SCALE)));
+    }
+    logCompressScalar(magnitudes + k, out + k, count - k);
+}
+
+static const SpectrumKernels avx2Kernels = {
+    "avx2", magnitudeAvx2, powerAvx2, decibelsAvx2, logCompressAvx2};
+
+#endif
+
+#if SPECTRUM_KERNELS_NEON
+
+// NEON, always present on AArch64
+
+static inline float32x4_t logNeon(float32x4_t x)
+{
+    const float32x4_t one = vdupq_n_f32(1.0f);
+
+    int32x4_t exponent = vsubq_s32(vreinterpretq_s32_u32(vshrq_n_u32(vreinterpretq_u32_f32(x), 23)),
+                                   vdupq_n_s32(126));
+    float32x4_t m = vreinterpretq_f32_u32(vorrq_u32(vandq_u32(vreinterpretq_u32_f32(x), vdupq_n_u32(0x007FFFFF)),
+                                                    vdupq_n_u32(0x3F000000)));
+    float32x4_t e = vcvtq_f32_s32(exponent);
+
+    uint32x4_t small = vcltq_f32(m, vdupq_n_f32(LOG_SQRTHF));
+    e = vsubq_f32(e, vreinterpretq_f32_u32(vandq_u32(vreinterpretq_u32_f32(one), small)));
+    m = vaddq_f32(vsubq_f32(m, one), vreinterpretq_f32_u32(vandq_u32(vreinterpretq_u32_f32(m), small)));
+
+    float32x4_t z = vmulq_f32(m, m);
+    float32x4_t y = vdupq_n_f32(LOG_P0);
+    y = vfmaq_f32(vdupq_n_f32(LOG_P1), y, m);
+    y = vfmaq_f32(vdupq_n_f32(LOG_P2), y, m);
+    y = vfmaq_f32(vdupq_n_f32(LOG_P3), y, m);
+    y = vfmaq_f32(vdupq_n_f32(LOG_P4), y, m);
+    y = vfmaq_f32(vdupq_n_f32(LOG_P5), y, m);
+    y = vfmaq_f32(vdupq_n_f32(LOG_P6), y, m);
+    y = vfmaq_f32(vdupq_n_f32(LOG_P7), y, m);
+    y = vfmaq_f32(vdupq_n_f32(LOG_P8), y, m);
+    y = vmulq_f32(vmulq_f32(y, m), z);
+
+    y = vfmaq_f32(y, e, vdupq_n_f32(LOG_Q1));
+    y = vfmsq_f32(y, z, vdupq_n_f32(0.5f));
+    return vfmaq_f32(vaddq_f32(m, y), e, vdupq_n_f32(LOG_Q2));
+}
+
+// Squared magnitudes of four bins, in bin order
+static inline float32x4_t binPowerNeon(const float *pairs)
+{
+    float32x4x2_t v = vld2q_f32(pairs); // Deinterleaves into re and im
+    return vfmaq_f32(vmulq_f32(v.val[0], v.val[0]), v.val[1], v.val[1]);
+}
+
+static void magnitudeNeon(const fftwf_complex *bins, float *out, size_t count)
+{
+    const float *pairs = &bins[0][0];
+    size_t k = 0;
+    for (; k + 4 <= count; k += 4)
+    {
+        vst1q_f32(out + k, vsqrtq_f32(binPowerNeon(pairs + 2 * k)));
+    }
+    magnitudeScalar(bins + k, out + k, count - k);
+}
+
+static void powerNeon(const fftwf_complex *bins, float *out, size_t count)
+{
+    const float *pairs = &bins[0][0];
+    size_t k = 0;
+    for (; k + 4 <= count; k += 4)
+    {
+        vst1q_f32(out + k, binPowerNeon(pairs + 2 * k));
+    }
+    powerScalar(bins + k, out + k, count - k);
+}
+
+static void decibelsNeon(const float *magnitudes, float *out, size_t count)
+{
+    size_t k = 0;
+    for (; k + 4 <= count; k += 4)
+    {
+        float32x4_t x = vaddq_f32(vld1q_f32(magnitudes + k), vdupq_n_f32(DB_FLOOR));
+        vst1q_f32(out + k, vmulq_f32(logNeon(x), vdupq_n_f32(DB_SCALE)));
+    }
+    decibelsScalar(magnitudes + k, out + k, count - k);
+}
+
+static void logCompressNeon(const float *magnitudes, float *out, size_t count)
+{
+    size_t k = 0;
+    for (; k + 4 <= count; k += 4)
+    {
+        float32x4_t x = vaddq_f32(vld1q_f32(magnitudes + k), vdupq_n_f32(1.0f));
+        vst1q_f32(out + k, vmulq_f32(logNeon(x), vdupq_n_f32(LOG10_SCALE)));
+    }
+    logCompressScalar(magnitudes + k, out + k, count - k);
+}
+
+static const SpectrumKernels neonKernels = {
+    "neon", magnitudeNeon, powerNeon, decibelsNeon, logCompressNeon};
+
+#endif
+
+const SpectrumKernels &SpectrumKernels::get()
+{
+    return *all().front();
+}
+
+const SpectrumKernels &SpectrumKernels::scalar()
+{
+    return scalarKernels;
+}
+
+const std::vector<const SpectrumKernels *> &SpectrumKernels::all()
+{
+    static const std::vector<const SpectrumKernels *> kernels = []
+    {
+        std::vector<const SpectrumKernels *> found;
+#if SPECTRUM_KERNELS_AVX2
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+            found.push_back(&avx2Kernels);
+#endif
+#if SPECTRUM_KERNELS_X86 && defined(__SSE2__)
+        found.push_back(&sse2Kernels);
+#elif SPECTRUM_KERNELS_NEON
+        found.push_back(&neonKernels);
+#endif
+        found.push_back(&scalarKernels);
+        return found;
+    }();
+    return kernels;
+}
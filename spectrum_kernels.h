@@ -0,0 +1,35 @@
+#ifndef SPECTRUM_KERNELS_H
+#define SPECTRUM_KERNELS_H
+
+#include <cstddef>
+#include <fftw3.h>
+#include <vector>
+
+// Per-bin spectrum math over whole arrays. Each CPU gets the widest
+// implementation it supports (AVX2, SSE2 or NEON), picked once at run time;
+// the scalar versions are the reference the others are checked against.
+struct SpectrumKernels
+{
+    const char *name;
+
+    // |X[k]| and |X[k]|^2 of count complex bins
+    void (*magnitude)(const fftwf_complex *bins, float *out, size_t count);
+    void (*power)(const fftwf_complex *bins, float *out, size_t count);
+
+    // 20 * log10(x + 1e-6), the small offset avoiding log(0)
+    void (*decibels)(const float *magnitudes, float *out, size_t count);
+
+    // log10(1 + x), compresses magnitudes for display
+    void (*logCompress)(const float *magnitudes, float *out, size_t count);
+
+    // Best implementation for this CPU
+    static const SpectrumKernels &get();
+
+    // Plain C++ loops, available everywhere
+    static const SpectrumKernels &scalar();
+
+    // Every implementation this CPU can run, best first, ending with scalar
+    static const std::vector<const SpectrumKernels *> &all();
+};
+
+#endif // SPECTRUM_KERNELS_H
@@ -0,0 +1,141 @@
+// Accuracy check of every SpectrumKernels implementation this CPU runs
+// against the scalar reference. Built and run by ./build.sh test.
+
+#include "spectrum_kernels.h"
+#include <cfloat>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+// Largest allowed differences from the scalar results: an absolute part
+// plus a number of units in the last place of the scalar result. The log
+// polynomial is good to about 1 ulp, and scaling its result to log10
+// rounds once more.
+static const float POWER_ULPS = 1.0f; // FMA rounds re^2 + im^2 once
+static const float MAGNITUDE_ULPS = 2.0f; // And the square root once more
+static const float DECIBELS_ABSOLUTE = 1.5e-5f;
+static const float DECIBELS_ULPS = 1.0f;
+static const float LOG_COMPRESS_ULPS = 3.0f;
+
+// Lengths around the 4 and 8 lane widths, so every tail size is covered
+static const size_t LENGTHS[] = {0, 1, 3, 4, 5, 7, 8, 9, 15, 16, 17, 31, 513, 2049};
+
+struct Inputs
+{
+    const char *name;
+    std::vector<float> values; // Non-negative magnitudes, and interleaved bins for magnitude
+};
+
+static std::vector<Inputs> makeInputs()
+{
+    const size_t size = 2 * 2049;
+    std::mt19937 random(1234);
+    std::vector<Inputs> inputs;
+
+    // Typical magnitudes span many decades
+    Inputs spread{"random", std::vector<float>(size)};
+    std::uniform_real_distribution<float> exponent(-8.0f, 6.0f);
+    for (float &value : spread.values)
+    {
+        value = std::pow(10.0f, exponent(random));
+    }
+    inputs.push_back(spread);
+
+    inputs.push_back(Inputs{"zeros", std::vector<float>(size, 0.0f)});
+
+    Inputs denormals{"denormals", std::vector<float>(size)};
+    std::uniform_int_distribution<int> steps(1, 1 << 20);
+    for (float &value : denormals.values)
+    {
+        value = FLT_MIN / static_cast<float>(steps(random));
+    }
+    inputs.push_back(denormals);
+
+    // Mantissas near the sqrt(1/2) split in the log polynomial
+    Inputs split{"log split", std::vector<float>(size)};
+    std::uniform_real_distribution<float> nearSplit(0.70f, 0.715f);
+    std::uniform_int_distribution<int> scale(-20, 20);
+    for (float &value : split.values)
+    {
+        value = std::ldexp(nearSplit(random), scale(random));
+    }
+    inputs.push_back(split);
+
+    return inputs;
+}
+
+// Compare count outputs, allowing an absolute difference plus ulps
+static bool compare(const char *kernels, const char *function, const char *inputs, size_t count,
+                    const std::vector<float> &expected, const std::vector<float> &actual,
+                    float absolute, float ulps)
+{
+    for (size_t k = 0; k < count; k++)
+    {
+        float magnitude = std::fabs(expected[k]);
+        float ulp = std::nextafter(magnitude, FLT_MAX) - magnitude;
+        float difference = std::fabs(actual[k] - expected[k]);
+        if (!(difference <= absolute + ulps * ulp))
+        {
+            std::printf("FAIL %s %s, %s inputs, length %zu, index %zu: %.9g, scalar %.9g\n",
+                        kernels, function, inputs, count, k, actual[k], expected[k]);
+            return false;
+        }
+    }
+    return true;
+}
+
+int main()
+{
+    const SpectrumKernels &scalar = SpectrumKernels::scalar();
+    const std::vector<Inputs> inputs = makeInputs();
+    int failures = 0;
+
+    for (const SpectrumKernels *kernels : SpectrumKernels::all())
+    {
+        if (kernels == &scalar)
+            continue;
+
+        for (const Inputs &input : inputs)
+        {
+            const float *values = input.values.data();
+            const fftwf_complex *bins = reinterpret_cast<const fftwf_complex *>(values);
+            std::vector<float> expected(2049), actual(2049);
+
+            for (size_t count : LENGTHS)
+            {
+                // Smallest denormals, scaled as bins, can underflow to zero
+                // in either version, so powers and magnitudes also allow
+                // FLT_MIN apart
+                scalar.power(bins, expected.data(), count);
+                kernels->power(bins, actual.data(), count);
+                failures += !compare(kernels->name, "power", input.name, count, expected, actual,
+                                     FLT_MIN, POWER_ULPS);
+
+                scalar.magnitude(bins, expected.data(), count);
+                kernels->magnitude(bins, actual.data(), count);
+                failures += !compare(kernels->name, "magnitude", input.name, count, expected, actual,
+                                     FLT_MIN, MAGNITUDE_ULPS);
+
+                scalar.decibels(values, expected.data(), count);
+                kernels->decibels(values, actual.data(), count);
+                failures += !compare(kernels->name, "decibels", input.name, count, expected, actual,
+                                     DECIBELS_ABSOLUTE, DECIBELS_ULPS);
+
+                scalar.logCompress(values, expected.data(), count);
+                kernels->logCompress(values, actual.data(), count);
+                failures += !compare(kernels->name, "logCompress", input.name, count, expected, actual,
+                                     0.0f, LOG_COMPRESS_ULPS);
+            }
+        }
+        std::printf("%s: checked against scalar\n", kernels->name);
+    }
+
+    if (failures)
+    {
+        std::printf("%d kernel checks failed\n", failures);
+        return 1;
+    }
+    std::printf("All kernel checks passed\n");
+    return 0;
+}
@@ -0,0 +1,84 @@
+#ifndef SPSC_RING_H
+#define SPSC_RING_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+// Lock-free ring buffer for exactly one producer thread and one consumer
+// thread. Neither side ever blocks or allocates, so it is safe to use from
+// a real-time audio callback.
+template <typename T>
+class SpscRing
+{
+public:
+    // Capacity is rounded up to a power of two
+    explicit SpscRing(size_t minCapacity)
+    {
+        size_t capacity = 1;
+        while (capacity < minCapacity)
+            capacity <<= 1;
+        buffer.resize(capacity);
+        mask = capacity - 1;
+    }
+
+    SpscRing(const SpscRing &) = delete;
+    SpscRing &operator=(const SpscRing &) = delete;
+
+    size_t capacity() const { return buffer.size(); }
+
+    // Consumer side: elements ready to be read
+    size_t readAvailable() const
+    {
+        return head.load(std::memory_order_acquire) - tail.load(std::memory_order_relaxed);
+    }
+
+    // Producer side: free slots
+    size_t writeAvailable() const
+    {
+        return buffer.size() - (head.load(std::memory_order_relaxed) - tail.load(std::memory_order_acquire));
+    }
+
+    // Producer side: copy up to count elements in, returns how many fit
+    size_t write(const T *data, size_t count)
+    {
+        const size_t writeIndex = head.load(std::memory_order_relaxed);
+        count = std::min(count, buffer.size() - (writeIndex - tail.load(std::memory_order_acquire)));
+
+        // The free region may wrap around the end of the buffer
+        const size_t offset = writeIndex & mask;
+        const size_t firstPart = std::min(count, buffer.size() - offset);
+        std::copy(data, data + firstPart, buffer.begin() + offset);
+        std::copy(data + firstPart, data + count, buffer.begin());
+
+        head.store(writeIndex + count, std::memory_order_release);
+        return count;
+    }
+
+    // Consumer side: copy up to count elements out, returns how many were read
+    size_t read(T *dest, size_t count)
+    {
+        const size_t readIndex = tail.load(std::memory_order_relaxed);
+        count = std::min(count, head.load(std::memory_order_acquire) - readIndex);
+
+        const size_t offset = readIndex & mask;
+        const size_t firstPart = std::min(count, buffer.size() - offset);
+        std::copy(buffer.begin() + offset, buffer.begin() + offset + firstPart, dest);
+        std::copy(buffer.begin(), buffer.begin() + (count - firstPart), dest + firstPart);
+
+        tail.store(readIndex + count, std::memory_order_release);
+        return count;
+    }
+
+private:
+    std::vector<T> buffer;
+    size_t mask = 0;
+
+    // Monotonic indices, each written by one side only; kept on separate
+    // cache lines so the two threads do not contend
+    alignas(64) std::atomic<size_t> head{0}; // Next slot to write
+    alignas(64) std::atomic<size_t> tail{0}; // Next slot to read
+};
+
+#endif // SPSC_RING_H
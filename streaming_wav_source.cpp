@@ -0,0 +1,199 @@
+#include "streaming_wav_source.h"
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+StreamingWavSource::StreamingWavSource()
+{
+}
+
+StreamingWavSource::~StreamingWavSource()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    decoderWake.notify_all();
+    dataReady.notify_all();
+
+    if (decodeThread.joinable())
+    {
+        decodeThread.join();
+    }
+    if (sndFile)
+    {
+        sf_close(sndFile);
+    }
+}
+
+bool StreamingWavSource::open(const std::string &filename)
+{
+    SF_INFO sfInfo;
+    memset(&sfInfo, 0, sizeof(sfInfo));
+
+    sndFile = sf_open(filename.c_str(), SFM_READ, &sfInfo);
+    if (!sndFile)
+    {
+        std::cerr << "Error opening WAV file: " << sf_strerror(sndFile) << std::endl;
+        return false;
+    }
+
+    totalFrames = static_cast<size_t>(sfInfo.frames);
+    fileChannels = sfInfo.channels;
+    fileSampleRate = sfInfo.samplerate;
+
+    // Short files are held entirely; long ones only keep a sliding window
+    capacity = std::min(HISTORY + LOOKAHEAD + CHUNK_FRAMES, totalFrames + CHUNK_FRAMES);
+
+    decodeThread = std::thread(&StreamingWavSource::decodeLoop, this);
+    return true;
+}
+
+void StreamingWavSource::decodeLoop()
+{
+    std::vector<float> interleaved(CHUNK_FRAMES * fileChannels);
+    std::unique_lock<std::mutex> lock(mutex);
+
+    while (!stopping)
+    {
+        if (seekRequested)
+        {
+            // The window was already reset by read(); move the file to match
+            size_t target = seekTarget;
+            seekRequested = false;
+            lock.unlock();
+            sf_seek(sndFile, static_cast<sf_count_t>(target), SEEK_SET);
+            lock.lock();
+            continue;
+        }
+
+        if (ringEnd >= totalFrames || ringEnd >= readCursor + LOOKAHEAD)
+        {
+            decoderWake.wait(lock);
+            continue;
+        }
+
+        size_t frames = std::min(CHUNK_FRAMES, totalFrames - ringEnd);
+        unsigned int chunkGeneration = generation;
+
+        // Decode outside the lock into a fresh chunk; chunks already handed
+        // out may still be referenced by views, so they are never reused
+        lock.unlock();
+        sf_count_t framesRead = sf_readf_float(sndFile, interleaved.data(), static_cast<sf_count_t>(frames));
+        framesRead = std::max<sf_count_t>(0, framesRead);
+
+        // Truncated file: the missing frames stay zero and read as silence
+        std::vector<float> mono(frames, 0.0f);
+        for (sf_count_t i = 0; i < framesRead; i++)
+        {
+            // Convert multi-channel to mono by averaging all channels
+            float sum = 0.0f;
+            for (int ch = 0; ch < fileChannels; ch++)
+            {
+                sum += interleaved[i * fileChannels + ch];
+            }
+            mono[i] = sum / fileChannels;
+        }
+        AudioBuffer chunk(std::move(mono));
+        lock.lock();
+
+        // A seek while decoding makes this chunk stale
+        if (chunkGeneration != generation)
+            continue;
+
+        // Drop the oldest chunks to make room; views keep them alive if needed
+        while (!chunks.empty() && ringEnd + frames - ringStart > capacity)
+        {
+            ringStart += chunks.front().size();
+            chunks.pop_front();
+        }
+        chunks.push_back(std::move(chunk));
+        ringEnd += frames;
+        dataReady.notify_all();
+    }
+}
+
+bool StreamingWavSource::waitForRange(std::unique_lock<std::mutex> &lock, size_t position, size_t end)
+{
+    for (;;)
+    {
+        if (stopping)
+            return false;
+
+        // Seek when the block was already dropped or is too far ahead to
+        // decode through; otherwise let the decoder catch up
+        if (position < ringStart || position > ringEnd + capacity)
+        {
+            chunks.clear();
+            ringStart = ringEnd = position;
+            readCursor = end;
+            seekTarget = position;
+            seekRequested = true;
+            generation++;
+            decoderWake.notify_one();
+        }
+        else if (end > readCursor)
+        {
+            readCursor = end;
+            decoderWake.notify_one();
+        }
+
+        if (ringEnd >= end)
+            return true;
+
+        dataReady.wait(lock);
+    }
+}
+
+void StreamingWavSource::read(size_t position, float *dest, size_t count)
+{
+    // Reads past the end of the file are silence
+    size_t available = position < totalFrames ? std::min(count, totalFrames - position) : 0;
+    std::fill(dest + available, dest + count, 0.0f);
+    if (available == 0)
+        return;
+
+    std::unique_lock<std::mutex> lock(mutex);
+    if (!waitForRange(lock, position, position + available))
+    {
+        std::fill(dest, dest + available, 0.0f);
+        return;
+    }
+
+    // Every chunk but the last in the file is full, so the first one needed
+    // can be found directly; the block may span several
+    size_t offset = position - ringStart;
+    size_t chunkIndex = offset / CHUNK_FRAMES;
+    offset %= CHUNK_FRAMES;
+    for (size_t copied = 0; copied < available; chunkIndex++, offset = 0)
+    {
+        const AudioBuffer &chunk = chunks[chunkIndex];
+        size_t frames = std::min(chunk.size() - offset, available - copied);
+        std::copy(chunk.data() + offset, chunk.data() + offset + frames, dest + copied);
+        copied += frames;
+    }
+}
+
+bool StreamingWavSource::view(size_t position, size_t count, AudioView &result)
+{
+    size_t available = position < totalFrames ? std::min(count, totalFrames - position) : 0;
+    if (available == 0)
+    {
+        result = AudioView(static_cast<const float *>(nullptr), 0, count);
+        return true;
+    }
+
+    std::unique_lock<std::mutex> lock(mutex);
+    if (!waitForRange(lock, position, position + available))
+        return false;
+
+    // Blocks spanning a chunk boundary are copied by read() instead
+    size_t offset = position - ringStart;
+    const AudioBuffer &chunk = chunks[offset / CHUNK_FRAMES];
+    offset %= CHUNK_FRAMES;
+    if (offset + available > chunk.size())
+        return false;
+
+    result = chunk.view(offset, count);
+    return true;
+}
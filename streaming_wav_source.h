@@ -0,0 +1,70 @@
+#ifndef STREAMING_WAV_SOURCE_H
+#define STREAMING_WAV_SOURCE_H
+
+#include "audio_source.h"
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <sndfile.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Reads a sound file in chunks on a decode thread into a bounded window of
+// immutable, refcounted chunks, so memory use does not depend on the length
+// of the file. Reads close to the last read position are served from the
+// window; anything else triggers a sample-accurate seek. Blocks that fall
+// inside one chunk are handed out as views without copying.
+class StreamingWavSource : public AudioSource
+{
+public:
+    StreamingWavSource();
+    ~StreamingWavSource() override;
+
+    StreamingWavSource(const StreamingWavSource &) = delete;
+    StreamingWavSource &operator=(const StreamingWavSource &) = delete;
+
+    // Open the file and start the decode thread
+    bool open(const std::string &filename);
+
+    size_t length() const override { return totalFrames; }
+    int channels() const override { return fileChannels; }
+    int sampleRate() const override { return fileSampleRate; }
+
+    void read(size_t position, float *dest, size_t count) override;
+    bool view(size_t position, size_t count, AudioView &result) override;
+
+private:
+    void decodeLoop();
+
+    // Block until [position, end) is decoded; false if the source is closing
+    bool waitForRange(std::unique_lock<std::mutex> &lock, size_t position, size_t end);
+
+    // Window geometry, in mono samples at 44.1kHz. Chunks are large enough
+    // that most analysis and playback blocks fall inside a single one.
+    static constexpr size_t CHUNK_FRAMES = 16384;  // Frames decoded per sf_readf_float call
+    static constexpr size_t LOOKAHEAD = 4 * 44100; // Decoded ahead of the furthest read
+    static constexpr size_t HISTORY = 16 * 44100;  // Kept behind the furthest read
+
+    SNDFILE *sndFile = nullptr;
+    size_t totalFrames = 0;
+    int fileChannels = 1;
+    int fileSampleRate = 0;
+
+    std::deque<AudioBuffer> chunks; // Full chunks of mono samples, except at the end of the file
+    size_t capacity = 0;            // Most samples held in chunks at once
+    size_t ringStart = 0;           // Position of the first sample in chunks
+    size_t ringEnd = 0;             // One past the newest decoded position
+    size_t readCursor = 0;   // End of the furthest read since the last seek
+    size_t seekTarget = 0;
+    bool seekRequested = false;
+    unsigned int generation = 0; // Bumped on every seek to discard in-flight chunks
+    bool stopping = false;
+
+    std::mutex mutex;
+    std::condition_variable dataReady;
+    std::condition_variable decoderWake;
+    std::thread decodeThread;
+};
+
+#endif // STREAMING_WAV_SOURCE_H
@@ -0,0 +1,311 @@
+#include "stroke_font.h"
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+
+// Curve tessellation, matching the 32-segment circles the scroller used to
+// draw every frame
+static const int SEGMENTS_PER_TURN = 32;
+
+const StrokeFont &StrokeFont::get()
+{
+    static const StrokeFont font;
+    return font;
+}
+
+const StrokeFont::Glyph &StrokeFont::glyph(char c) const
+{
+    unsigned char index = static_cast<unsigned char>(c);
+    if (c == ' ')
+        return glyphs[index]; // Nothing to draw
+
+    if (index >= 128 || glyphs[index].count == 0)
+    {
+        // Lowercase falls back to the capital, everything else to the box
+        int upper = std::toupper(index);
+        index = (upper < 128 && glyphs[upper].count > 0) ? static_cast<unsigned char>(upper) : 0;
+    }
+    return glyphs[index];
+}
+
+void StrokeFont::begin(char c)
+{
+    building = c;
+    glyphs[static_cast<unsigned char>(c)].first = allPoints.size();
+}
+
+void StrokeFont::line(float x1, float y1, float x2, float y2)
+{
+    allPoints.push_back({x1, y1});
+    allPoints.push_back({x2, y2});
+    glyphs[static_cast<unsigned char>(building)].count += 2;
+}
+
+void StrokeFont::arc(float centerX, float centerY, float radiusX, float radiusY, float startAngle, float endAngle)
+{
+    int segments = std::max(4, static_cast<int>(std::fabs(endAngle - startAngle) / (2.0f * M_PI) * SEGMENTS_PER_TURN + 0.5f));
+    float step = (endAngle - startAngle) / segments;
+    for (int i = 0; i < segments; i++)
+    {
+        float a1 = startAngle + i * step;
+        float a2 = a1 + step;
+        line(centerX + std::cos(a1) * radiusX, centerY + std::sin(a1) * radiusY,
+             centerX + std::cos(a2) * radiusX, centerY + std::sin(a2) * radiusY);
+    }
+}
+
+StrokeFont::StrokeFont()
+{
+    const float PI = static_cast<float>(M_PI);
+
+    // Slot 0: box for characters without a glyph
+    begin('\0');
+    line(-0.4f, 0.0f, 0.4f, 0.0f);
+    line(0.4f, 0.0f, 0.4f, 1.0f);
+    line(0.4f, 1.0f, -0.4f, 1.0f);
+    line(-0.4f, 1.0f, -0.4f, 0.0f);
+
+    // Capitals
+    begin('A');
+    line(-0.3f, 0.0f, 0.0f, 1.0f);
+    line(0.0f, 1.0f, 0.3f, 0.0f);
+    line(-0.15f, 0.45f, 0.15f, 0.45f);
+
+    begin('B');
+    line(-0.3f, 0.0f, -0.3f, 1.0f);
+    line(-0.3f, 1.0f, 0.05f, 1.0f);
+    arc(0.05f, 0.75f, 0.25f, 0.25f, PI * 0.5f, -PI * 0.5f);
+    line(0.05f, 0.5f, -0.3f, 0.5f);
+    arc(0.05f, 0.25f, 0.25f, 0.25f, PI * 0.5f, -PI * 0.5f);
+    line(0.05f, 0.0f, -0.3f, 0.0f);
+
+    begin('C');
+    arc(0.0f, 0.5f, 0.4f, 0.4f, PI * 0.25f, PI * 1.75f);
+
+    begin('D');
+    line(-0.3f, 0.0f, -0.3f, 1.0f);
+    line(-0.3f, 1.0f, 0.0f, 1.0f);
+    arc(0.0f, 0.5f, 0.3f, 0.5f, PI * 0.5f, -PI * 0.5f);
+    line(0.0f, 0.0f, -0.3f, 0.0f);
+
+    begin('E');
+    line(-0.3f, 0.0f, -0.3f, 1.0f);
+    line(-0.3f, 1.0f, 0.3f, 1.0f);
+    line(-0.3f, 0.5f, 0.2f, 0.5f);
+    line(-0.3f, 0.0f, 0.3f, 0.0f);
+
+    begin('F');
+    line(-0.3f, 0.0f, -0.3f, 1.0f);
+    line(-0.3f, 1.0f, 0.3f, 1.0f);
+    line(-0.3f, 0.5f, 0.2f, 0.5f);
+
+    begin('G');
+    arc(0.0f, 0.5f, 0.4f, 0.4f, PI * 0.25f, PI * 2.0f);
+    line(0.4f, 0.5f, 0.1f, 0.5f);
+
+    begin('H');
+    line(-0.3f, 0.0f, -0.3f, 1.0f);
+    line(0.3f, 0.0f, 0.3f, 1.0f);
+    line(-0.3f, 0.5f, 0.3f, 0.5f);
+
+    begin('I');
+    line(0.0f, 0.0f, 0.0f, 1.0f);
+    line(-0.15f, 1.0f, 0.15f, 1.0f);
+    line(-0.15f, 0.0f, 0.15f, 0.0f);
+
+    begin('J');
+    line(0.2f, 1.0f, 0.2f, 0.3f);
+    arc(-0.05f, 0.3f, 0.25f, 0.3f, 0.0f, -PI);
+
+    begin('K');
+    line(-0.3f, 0.0f, -0.3f, 1.0f);
+    line(0.3f, 1.0f, -0.3f, 0.4f);
+    line(-0.1f, 0.6f, 0.3f, 0.0f);
+
+    begin('L');
+    line(-0.3f, 1.0f, -0.3f, 0.0f);
+    line(-0.3f, 0.0f, 0.3f, 0.0f);
+
+    begin('M');
+    line(-0.3f, 0.0f, -0.3f, 1.0f);
+    line(-0.3f, 1.0f, 0.0f, 0.5f);
+    line(0.0f, 0.5f, 0.3f, 1.0f);
+    line(0.3f, 1.0f, 0.3f, 0.0f);
+
+    begin('N');
+    line(-0.3f, 0.0f, -0.3f, 1.0f);
+    line(-0.3f, 1.0f, 0.3f, 0.0f);
+    line(0.3f, 0.0f, 0.3f, 1.0f);
+
+    begin('O');
+    arc(0.0f, 0.5f, 0.3f, 0.5f, 0.0f, PI * 2.0f);
+
+    begin('P');
+    line(-0.3f, 0.0f, -0.3f, 1.0f);
+    line(-0.3f, 1.0f, 0.05f, 1.0f);
+    arc(0.05f, 0.75f, 0.25f, 0.25f, PI * 0.5f, -PI * 0.5f);
+    line(0.05f, 0.5f, -0.3f, 0.5f);
+
+    begin('Q');
+    arc(0.0f, 0.5f, 0.3f, 0.5f, 0.0f, PI * 2.0f);
+    line(0.1f, 0.25f, 0.35f, -0.05f);
+
+    begin('R');
+    line(-0.3f, 0.0f, -0.3f, 1.0f);
+    line(-0.3f, 1.0f, 0.05f, 1.0f);
+    arc(0.05f, 0.75f, 0.25f, 0.25f, PI * 0.5f, -PI * 0.5f);
+    line(0.05f, 0.5f, -0.3f, 0.5f);
+    line(0.0f, 0.5f, 0.3f, 0.0f);
+
+    begin('S');
+    arc(0.0f, 0.75f, 0.3f, 0.25f, PI * 0.2f, PI * 1.5f);
+    arc(0.0f, 0.25f, 0.3f, 0.25f, PI * 0.5f, -PI * 0.8f);
+
+    begin('T');
+    line(-0.35f, 1.0f, 0.35f, 1.0f);
+    line(0.0f, 1.0f, 0.0f, 0.0f);
+
+    begin('U');
+    line(-0.3f, 1.0f, -0.3f, 0.3f);
+    arc(0.0f, 0.3f, 0.3f, 0.3f, PI, PI * 2.0f);
+    line(0.3f, 0.3f, 0.3f, 1.0f);
+
+    begin('V');
+    line(-0.3f, 1.0f, 0.0f, 0.0f);
+    line(0.0f, 0.0f, 0.3f, 1.0f);
+
+    begin('W');
+    line(-0.35f, 1.0f, -0.2f, 0.0f);
+    line(-0.2f, 0.0f, 0.0f, 0.6f);
+    line(0.0f, 0.6f, 0.2f, 0.0f);
+    line(0.2f, 0.0f, 0.35f, 1.0f);
+
+    begin('X');
+    line(-0.3f, 0.0f, 0.3f, 1.0f);
+    line(-0.3f, 1.0f, 0.3f, 0.0f);
+
+    begin('Y');
+    line(-0.3f, 1.0f, 0.0f, 0.5f);
+    line(0.3f, 1.0f, 0.0f, 0.5f);
+    line(0.0f, 0.5f, 0.0f, 0.0f);
+
+    begin('Z');
+    line(-0.3f, 1.0f, 0.3f, 1.0f);
+    line(0.3f, 1.0f, -0.3f, 0.0f);
+    line(-0.3f, 0.0f, 0.3f, 0.0f);
+
+    // Lowercase letters with their own shapes
+    begin('d');
+    line(0.3f, 0.0f, 0.3f, 1.0f);
+    arc(0.0f, 0.5f, 0.3f, 0.3f, 0.0f, PI * 2.0f);
+
+    begin('e');
+    line(-0.3f, 0.0f, -0.3f, 1.0f);
+    line(-0.3f, 0.0f, 0.25f, 0.0f);
+    line(-0.3f, 0.5f, 0.2f, 0.5f);
+    line(-0.3f, 1.0f, 0.25f, 1.0f);
+
+    begin('n');
+    line(-0.3f, 0.0f, -0.3f, 1.0f);
+    line(-0.3f, 1.0f, 0.3f, 0.0f);
+    line(0.3f, 0.0f, 0.3f, 1.0f);
+
+    begin('o');
+    arc(0.0f, 0.5f, 0.3f, 0.3f, 0.0f, PI * 2.0f);
+
+    begin('r');
+    line(-0.3f, 0.0f, -0.3f, 1.0f);
+    line(-0.3f, 1.0f, 0.25f, 1.0f);
+    line(0.25f, 1.0f, 0.25f, 0.5f);
+    line(0.25f, 0.5f, -0.3f, 0.5f);
+    line(-0.3f, 0.5f, 0.25f, 0.0f);
+
+    // Digits
+    begin('0');
+    arc(0.0f, 0.5f, 0.3f, 0.5f, 0.0f, PI * 2.0f);
+    line(-0.2f, 0.15f, 0.2f, 0.85f);
+
+    begin('1');
+    line(0.0f, 0.0f, 0.0f, 1.0f);
+    line(0.0f, 1.0f, -0.15f, 0.8f);
+    line(-0.15f, 0.0f, 0.15f, 0.0f);
+
+    begin('2');
+    arc(0.0f, 0.7f, 0.3f, 0.3f, PI * 0.85f, -PI * 0.2f);
+    line(0.3f * std::cos(-PI * 0.2f), 0.7f + 0.3f * std::sin(-PI * 0.2f), -0.3f, 0.0f);
+    line(-0.3f, 0.0f, 0.3f, 0.0f);
+
+    begin('3');
+    arc(0.0f, 0.75f, 0.3f, 0.25f, PI * 0.8f, -PI * 0.5f);
+    arc(0.0f, 0.25f, 0.3f, 0.25f, PI * 0.5f, -PI * 0.8f);
+
+    begin('4');
+    line(0.15f, 0.0f, 0.15f, 1.0f);
+    line(0.15f, 1.0f, -0.3f, 0.3f);
+    line(-0.3f, 0.3f, 0.3f, 0.3f);
+
+    begin('5');
+    line(0.3f, 1.0f, -0.25f, 1.0f);
+    line(-0.25f, 1.0f, -0.3f, 0.55f);
+    line(-0.3f, 0.55f, 0.0f, 0.6f);
+    arc(0.0f, 0.3f, 0.3f, 0.3f, PI * 0.5f, -PI * 0.8f);
+
+    begin('6');
+    arc(0.0f, 0.3f, 0.3f, 0.3f, 0.0f, PI * 2.0f);
+    line(0.2f, 1.0f, -0.27f, 0.42f);
+
+    begin('7');
+    line(-0.3f, 1.0f, 0.3f, 1.0f);
+    line(0.3f, 1.0f, -0.1f, 0.0f);
+
+    begin('8');
+    arc(0.0f, 0.75f, 0.25f, 0.25f, 0.0f, PI * 2.0f);
+    arc(0.0f, 0.25f, 0.3f, 0.25f, 0.0f, PI * 2.0f);
+
+    begin('9');
+    arc(0.0f, 0.7f, 0.3f, 0.3f, 0.0f, PI * 2.0f);
+    line(0.27f, 0.58f, -0.1f, 0.0f);
+
+    // Punctuation
+    begin('.');
+    line(0.0f, 0.0f, 0.0f, 0.08f);
+
+    begin(',');
+    line(0.03f, 0.08f, -0.05f, -0.12f);
+
+    begin('!');
+    line(0.0f, 1.0f, 0.0f, 0.3f);
+    line(0.0f, 0.08f, 0.0f, 0.0f);
+
+    begin('?');
+    arc(0.0f, 0.75f, 0.25f, 0.25f, PI * 0.9f, -PI * 0.5f);
+    line(0.0f, 0.5f, 0.0f, 0.3f);
+    line(0.0f, 0.08f, 0.0f, 0.0f);
+
+    begin(':');
+    line(0.0f, 0.75f, 0.0f, 0.65f);
+    line(0.0f, 0.1f, 0.0f, 0.0f);
+
+    begin('-');
+    line(-0.2f, 0.5f, 0.2f, 0.5f);
+
+    begin('+');
+    line(-0.2f, 0.5f, 0.2f, 0.5f);
+    line(0.0f, 0.3f, 0.0f, 0.7f);
+
+    begin('\'');
+    line(0.0f, 1.0f, 0.0f, 0.75f);
+
+    begin('"');
+    line(-0.1f, 1.0f, -0.1f, 0.75f);
+    line(0.1f, 1.0f, 0.1f, 0.75f);
+
+    begin('/');
+    line(-0.3f, 0.0f, 0.3f, 1.0f);
+
+    begin('(');
+    arc(0.3f, 0.5f, 0.3f, 0.55f, PI * 0.65f, PI * 1.35f);
+
+    begin(')');
+    arc(-0.3f, 0.5f, 0.3f, 0.55f, PI * 0.35f, -PI * 0.35f);
+}
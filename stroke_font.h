@@ -0,0 +1,48 @@
+#ifndef STROKE_FONT_H
+#define STROKE_FONT_H
+
+#include <cstddef>
+#include <vector>
+
+// Vector font for the scroller, built once on first use. Every glyph is a
+// list of line segments (pairs of points) in glyph units: x roughly -0.4 to
+// 0.4 around the glyph's centre, y from 0 at the baseline to 1 at the top.
+// Curves are tessellated when the font is built, so drawing a glyph is only
+// a copy of its range of points.
+class StrokeFont
+{
+public:
+    struct Point
+    {
+        float x, y;
+    };
+
+    struct Glyph
+    {
+        size_t first; // Index of the first point in points()
+        size_t count; // Number of points, two per segment
+    };
+
+    // The shared font
+    static const StrokeFont &get();
+
+    // Letters, digits and common punctuation; lowercase letters without a
+    // shape of their own use the capital, a space is empty and anything
+    // else is a box
+    const Glyph &glyph(char c) const;
+
+    const std::vector<Point> &points() const { return allPoints; }
+
+private:
+    StrokeFont();
+
+    void begin(char c);
+    void line(float x1, float y1, float x2, float y2);
+    void arc(float centerX, float centerY, float radiusX, float radiusY, float startAngle, float endAngle);
+
+    std::vector<Point> allPoints;
+    Glyph glyphs[128] = {};
+    char building = 0;
+};
+
+#endif // STROKE_FONT_H
@@ -1,14 +1,12 @@
 #include "terrain_visualizer_3d.h"
+#include "gl_math.h"
 #include <algorithm>
 #include <cmath>
 #include <GL/glew.h>
 #ifdef __APPLE__
-// Silence macOS deprecation warnings for GLU functions
+// Silence macOS deprecation warnings for the fixed-function OpenGL calls
 #pragma clang diagnostic push
 #pragma clang diagnostic ignored "-Wdeprecated-declarations"
-#include <OpenGL/glu.h>
-#else
-#include <GL/glu.h>
 #endif
 
 // Define static constexpr members
@@ -17,6 +15,37 @@ constexpr float TerrainVisualizer3D::GRID_COLOR[];
 constexpr float TerrainVisualizer3D::LINE_WIDTH;
 constexpr int TerrainVisualizer3D::POINTS_PER_BAND;
 
+// Every point is placed by the age of its row, so the ring scrolls back
+// without any data moving; rows fade out as they age
+static const char *TERRAIN_VERTEX_SHADER = R"(#version 120
+CAMERA_UNIFORMS
+uniform float newestRow;
+uniform float rowCount;
+uniform float rowSpacing;
+uniform vec3 color;
+attribute vec2 gridPoint; // x, ring slot of the row
+attribute float height;
+varying vec4 fragmentColor;
+
+void main()
+{
+    float age = newestRow - gridPoint.y;
+    if (age < 0.0)
+        age += rowCount;
+    fragmentColor = vec4(color, 1.0 - age / rowCount);
+    gl_Position = viewProjection * vec4(gridPoint.x, height, -age * rowSpacing, 1.0);
+}
+)";
+
+static const char *TERRAIN_FRAGMENT_SHADER = R"(#version 120
+varying vec4 fragmentColor;
+
+void main()
+{
+    gl_FragColor = fragmentColor;
+}
+)";
+
 TerrainVisualizer3D::TerrainVisualizer3D()
 {
     // Initialize band data buffers with zeros
@@ -27,7 +56,11 @@ TerrainVisualizer3D::TerrainVisualizer3D()
 
 TerrainVisualizer3D::~TerrainVisualizer3D()
 {
-    // No resources to clean up
+    for (GLuint buffer : {gridVbo, heightVbo, indexBuffer}) {
+        if (buffer) {
+            glDeleteBuffers(1, &buffer);
+        }
+    }
 }
 
 void TerrainVisualizer3D::initialize(int width, int height)
@@ -36,22 +69,17 @@ void TerrainVisualizer3D::initialize(int width, int height)
     Visualizer::initialize(width, height);
 }
 
-void TerrainVisualizer3D::renderFrame(const std::vector<float> &audioData,
-                                      double *fftInputBuffer,
-                                      fftw_complex *fftOutputBuffer,
-                                      fftw_plan &fftPlan,
+void TerrainVisualizer3D::renderFrame(const AnalysisFrame &analysis,
                                       float timeSeconds)
 {
-    // Calculate the sample index for the current time
-    size_t sampleIndex = static_cast<size_t>(timeSeconds * 44100); // Assuming 44.1kHz
-    if (sampleIndex >= audioData.size())
+    // Mark unused parameters to silence compiler warnings
+    (void)timeSeconds;
+
+    if (!analysis.primary().active)
         return;
 
-    // Update the FFT for the current position
-    updateFFT(audioData, fftInputBuffer, fftPlan, sampleIndex);
-    
     // Analyze frequency bands
-    analyzeBands(fftOutputBuffer);
+    analyzeBands(analysis);
     
     // Set up 3D perspective view
     setupPerspectiveView();
@@ -77,17 +105,14 @@ void TerrainVisualizer3D::renderFrame(const std::vector<float> &audioData,
     glDisable(GL_DEPTH_TEST);
 }
 
-void TerrainVisualizer3D::renderLiveFrame(const std::vector<float> &audioData,
-                                         double *fftInputBuffer,
-                                         fftw_complex *fftOutputBuffer,
-                                         fftw_plan &fftPlan,
+void TerrainVisualizer3D::renderLiveFrame(const AnalysisFrame &analysis,
                                          size_t currentPosition)
 {
-    // Update the FFT for the current position
-    updateFFT(audioData, fftInputBuffer, fftPlan, currentPosition);
-    
+    // Mark unused parameters to silence compiler warnings
+    (void)currentPosition;
+
     // Analyze frequency bands
-    analyzeBands(fftOutputBuffer);
+    analyzeBands(analysis);
     
     // Set up 3D perspective view
     setupPerspectiveView();
@@ -115,53 +140,27 @@ void TerrainVisualizer3D::renderLiveFrame(const std::vector<float> &audioData,
 
 void TerrainVisualizer3D::setupPerspectiveView()
 {
-    // Set up projection matrix
-    glMatrixMode(GL_PROJECTION);
-    glLoadIdentity();
-    
     // Calculate the aspect ratio for proper perspective
     float aspect = static_cast<float>(screenWidth) / screenHeight;
     
     // Set up perspective projection with wider FOV for more perspective effect
-    gluPerspective(65.0f, aspect, 0.1f, 100.0f);
-    
-    // Set up modelview matrix
-    glMatrixMode(GL_MODELVIEW);
-    glLoadIdentity();
+    Mat4 projection = perspectiveMatrix(65.0f, aspect, 0.1f, 100.0f);
     
     // Position the "camera" to look at the terrain from a more elevated angle
-    // Adjusted to make the terrain fill more vertical space
-    gluLookAt(0.0f, 6.0f, 7.0f,     // Eye position (slightly further back)
-              0.0f, 2.0f, -4.0f,    // Look-at position (raised more)
-              0.0f, 1.0f, 0.0f);    // Up vector
-              
-    // Adjust rotation angle to show more vertical terrain
-    glRotatef(35.0f, 1.0f, 0.0f, 0.0f);
+    // Adjusted to make the terrain fill more vertical space, then tilted to
+    // show more vertical terrain
+    Mat4 view = lookAtMatrix({0.0f, 6.0f, 7.0f},  // Eye position (slightly further back)
+                             {0.0f, 2.0f, -4.0f}, // Look-at position (raised more)
+                             {0.0f, 1.0f, 0.0f}); // Up vector
+    camera.set(projection * view * rotationMatrix(35.0f, 1.0f, 0.0f, 0.0f));
 }
 
-void TerrainVisualizer3D::updateFFT(const std::vector<float> &audioData, double *fftInputBuffer, fftw_plan &fftPlan, size_t position)
+void TerrainVisualizer3D::analyzeBands(const AnalysisFrame &analysis)
 {
-    // Fill the FFT input buffer with audio data and apply a Hanning window
-    const int N = 1024; // Assuming this is the FFT size
-    
-    for (int i = 0; i < N; i++) {
-        if (position + i < audioData.size()) {
-            // Apply Hanning window to reduce spectral leakage
-            double window = 0.5 * (1.0 - cos(2.0 * M_PI * i / (N - 1)));
-            fftInputBuffer[i] = audioData[position + i] * window;
-        } else {
-            fftInputBuffer[i] = 0.0;
-        }
-    }
-    
-    // Execute FFT
-    fftw_execute(fftPlan);
-}
+    const SourceSpectrum &spectrum = analysis.primary();
 
-void TerrainVisualizer3D::analyzeBands(fftw_complex *fftOutput)
-{
     // Calculate frequency resolution
-    const float freqResolution = 44100.0f / 1024.0f; // Sample rate / FFT size
+    const float freqResolution = static_cast<float>(analysis.sampleRate) / analysis.fftSize;
     
     // Define the cutoff frequencies for the 5 bands
     const int cutoffs[NUM_BANDS + 1] = {
@@ -174,7 +173,7 @@ void TerrainVisualizer3D::analyzeBands(fftw_complex *fftOutput)
     };
     
     // Ensure bins are within the FFT range
-    const int maxBin = 512; // N/2 for real signals
+    const int maxBin = analysis.fftSize / 2; // N/2 for real signals
     
     // Bin ranges for each band
     std::array<int, NUM_BANDS> startBins;
@@ -193,13 +192,8 @@ void TerrainVisualizer3D::analyzeBands(fftw_complex *fftOutput)
         
         // Extract magnitudes for this band
         for (int bin = startBins[band]; bin < endBins[band]; bin++) {
-            float magnitude = std::sqrt(
-                fftOutput[bin][0] * fftOutput[bin][0] +
-                fftOutput[bin][1] * fftOutput[bin][1]
-            );
-            
-            // Apply logarithmic scaling for better visualization
-            magnitude = magnitude > 0 ? std::log10(1 + magnitude) : 0;
+            // Logarithmic scaling for better visualization
+            float magnitude = spectrum.logMagnitudes[bin];
             
             // Apply frequency-dependent scaling (similar to bar_equalizer.cpp)
             // Higher frequencies get more emphasis
@@ -246,31 +240,59 @@ void TerrainVisualizer3D::analyzeBands(fftw_complex *fftOutput)
     }
 }
 
-void TerrainVisualizer3D::renderTerrain()
+void TerrainVisualizer3D::createBuffers()
 {
-    // Z-spacing between bands (increased for more depth)
-    const float Z_SPACING = 2.0f;
-    
-    // Position bands with more depth and spacing
-    // Low frequencies in back, high frequencies in front
-    const float zPositions[NUM_BANDS] = {
-        -4.0f * Z_SPACING,  // Lowest (furthest back)
-        -3.0f * Z_SPACING,  // Low-Mid
-        -2.0f * Z_SPACING,  // Mid
-        -1.0f * Z_SPACING,  // Mid-High
-        0.0f                // Highest (front)
-    };
+    // Every row spans the full width; its slot in the ring never changes
+    std::vector<float> grid;
+    grid.reserve(HISTORY_ROWS * ROW_POINTS * 2);
+    for (int row = 0; row < HISTORY_ROWS; row++) {
+        for (int i = 0; i < ROW_POINTS; i++) {
+            grid.push_back(-TERRAIN_WIDTH / 2 + i * (TERRAIN_WIDTH / (ROW_POINTS - 1)));
+            grid.push_back(static_cast<float>(row));
+        }
+    }
     
-    // Vary width by band - front is full width, back is 1/6 width
-    // Adjusted to make more extreme differences between front and back
-    const float widthScales[NUM_BANDS] = {
-        0.17f,  // Lowest (narrowest)
-        0.3f,   // Low-Mid
-        0.5f,   // Mid
-        0.75f,  // Mid-High
-        1.0f    // Highest (full width)
-    };
+    // Segments along every row first, then the connectors from each row to
+    // the next slot, grouped by row so the one joining the newest row to
+    // the oldest can be left out
+    std::vector<GLuint> indices;
+    for (int row = 0; row < HISTORY_ROWS; row++) {
+        for (int i = 0; i < ROW_POINTS - 1; i++) {
+            indices.push_back(row * ROW_POINTS + i);
+            indices.push_back(row * ROW_POINTS + i + 1);
+        }
+    }
+    for (int row = 0; row < HISTORY_ROWS; row++) {
+        int next = (row + 1) % HISTORY_ROWS;
+        for (int i = 0; i < ROW_POINTS; i += CONNECTOR_STEP) {
+            indices.push_back(row * ROW_POINTS + i);
+            indices.push_back(next * ROW_POINTS + i);
+        }
+    }
     
+    glGenBuffers(1, &gridVbo);
+    glBindBuffer(GL_ARRAY_BUFFER, gridVbo);
+    glBufferData(GL_ARRAY_BUFFER, grid.size() * sizeof(float), grid.data(), GL_STATIC_DRAW);
+    
+    // History starts out flat
+    std::vector<float> heights(HISTORY_ROWS * ROW_POINTS, 0.0f);
+    glGenBuffers(1, &heightVbo);
+    glBindBuffer(GL_ARRAY_BUFFER, heightVbo);
+    glBufferData(GL_ARRAY_BUFFER, heights.size() * sizeof(float), heights.data(), GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    
+    glGenBuffers(1, &indexBuffer);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(GLuint), indices.data(), GL_STATIC_DRAW);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    
+    mesh.attribute(0, gridVbo, 2);
+    mesh.attribute(1, heightVbo, 1);
+    mesh.elements(indexBuffer);
+}
+
+void TerrainVisualizer3D::pushRow()
+{
     // Add height scaling for each band - higher frequencies get taller
     const float heightScales[NUM_BANDS] = {
         0.7f,   // Lowest frequencies (shortest)
@@ -280,85 +302,68 @@ void TerrainVisualizer3D::renderTerrain()
         1.3f    // Highest frequencies (tallest)
     };
     
-    // Draw reference grid
-    glColor3fv(GRID_COLOR);
-    glLineWidth(1.0f);
-    
-    // Horizontal grid lines at ground level
-    glBegin(GL_LINES);
+    rowHeights.resize(ROW_POINTS);
     for (int band = 0; band < NUM_BANDS; band++) {
-        float z = zPositions[band];
-        float width = TERRAIN_WIDTH * widthScales[band];
-        glVertex3f(-width/2, 0.0f, z);
-        glVertex3f(width/2, 0.0f, z);
-    }
-    
-    // Side grid lines
-    const int numGridLines = 15; // Increased for more detail with wider terrain
-    for (int band = 0; band < NUM_BANDS - 1; band++) {
-        float z1 = zPositions[band];
-        float z2 = zPositions[band + 1];
-        float width1 = TERRAIN_WIDTH * widthScales[band];
-        float width2 = TERRAIN_WIDTH * widthScales[band + 1];
-        
-        for (int i = 0; i <= numGridLines; i++) {
-            float t = static_cast<float>(i) / numGridLines;
-            float x1 = -width1/2 + t * width1;
-            float x2 = -width2/2 + t * width2;
-            
-            glVertex3f(x1, 0.0f, z1);
-            glVertex3f(x2, 0.0f, z2);
+        for (int i = 0; i < POINTS_PER_BAND; i++) {
+            rowHeights[band * POINTS_PER_BAND + i] = bandData[band][i] * TERRAIN_HEIGHT * heightScales[band];
         }
     }
-    glEnd();
     
-    // Set thick lines for the waveforms
-    glLineWidth(LINE_WIDTH);
-    glColor3fv(BAND_COLOR);
+    // Overwrite the oldest row, which becomes the newest
+    newestRow = (newestRow + 1) % HISTORY_ROWS;
+    glBindBuffer(GL_ARRAY_BUFFER, heightVbo);
+    glBufferSubData(GL_ARRAY_BUFFER, newestRow * ROW_POINTS * sizeof(float),
+                    ROW_POINTS * sizeof(float), rowHeights.data());
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void TerrainVisualizer3D::renderTerrain()
+{
+    if (!shader.build(TERRAIN_VERTEX_SHADER, TERRAIN_FRAGMENT_SHADER, {"gridPoint", "height"}))
+        return;
     
-    // Draw each band's waveform with varying width and height
-    for (int band = 0; band < NUM_BANDS; band++) {
-        float z = zPositions[band];
-        float width = TERRAIN_WIDTH * widthScales[band];
-        float heightScale = heightScales[band];
-        
-        // Draw the waveform line
-        glBegin(GL_LINE_STRIP);
-        for (int i = 0; i < POINTS_PER_BAND; i++) {
-            float x = -width/2 + i * (width / (POINTS_PER_BAND - 1));
-            float y = bandData[band][i] * TERRAIN_HEIGHT * heightScale;
-            glVertex3f(x, y, z);
-        }
-        glEnd();
+    if (!gridVbo) {
+        createBuffers();
     }
-    
-    // Draw vertical connector lines between bands
-    for (int band = 0; band < NUM_BANDS - 1; band++) {
-        float z1 = zPositions[band];
-        float z2 = zPositions[band + 1];
-        float width1 = TERRAIN_WIDTH * widthScales[band];
-        float width2 = TERRAIN_WIDTH * widthScales[band + 1];
-        float heightScale1 = heightScales[band];
-        float heightScale2 = heightScales[band + 1];
-        
-        // Draw connection lines every 20 points
-        glBegin(GL_LINES);
-        for (int i = 0; i < POINTS_PER_BAND; i += 20) {
-            float t = static_cast<float>(i) / (POINTS_PER_BAND - 1);
-            float x1 = -width1/2 + t * width1;
-            float x2 = -width2/2 + t * width2;
-            float y1 = bandData[band][i] * TERRAIN_HEIGHT * heightScale1;
-            float y2 = bandData[band + 1][i] * TERRAIN_HEIGHT * heightScale2;
-            
-            // Draw line connecting the two bands
-            glVertex3f(x1, y1, z1);
-            glVertex3f(x2, y2, z2);
+    pushRow();
+    
+    const GLsizei rowIndices = (ROW_POINTS - 1) * 2;
+    const GLsizei connectorIndices = ((ROW_POINTS + CONNECTOR_STEP - 1) / CONNECTOR_STEP) * 2;
+    const GLsizei connectorStart = HISTORY_ROWS * rowIndices;
+    auto drawRange = [](GLsizei first, GLsizei count) {
+        if (count > 0) {
+            glDrawElements(GL_LINES, count, GL_UNSIGNED_INT,
+                           reinterpret_cast<const void *>(first * sizeof(GLuint)));
         }
-        glEnd();
-    }
+    };
+    
+    shader.use();
+    camera.apply(shader);
+    ShaderProgram::set(shader.uniform("newestRow"), static_cast<float>(newestRow));
+    ShaderProgram::set(shader.uniform("rowCount"), static_cast<float>(HISTORY_ROWS));
+    ShaderProgram::set(shader.uniform("rowSpacing"), TERRAIN_DEPTH / (HISTORY_ROWS - 1));
+    GLint color = shader.uniform("color");
+    mesh.bind();
+    
+    // Connectors between rows, except the one from the newest back to the oldest
+    ShaderProgram::set(color, GRID_COLOR[0], GRID_COLOR[1], GRID_COLOR[2]);
+    GLProfile::lineWidth(1.0f);
+    drawRange(connectorStart, newestRow * connectorIndices);
+    drawRange(connectorStart + (newestRow + 1) * connectorIndices,
+              (HISTORY_ROWS - 1 - newestRow) * connectorIndices);
+    
+    // The newest row thick in front, then the whole history thin
+    ShaderProgram::set(color, BAND_COLOR[0], BAND_COLOR[1], BAND_COLOR[2]);
+    GLProfile::lineWidth(LINE_WIDTH);
+    drawRange(newestRow * rowIndices, rowIndices);
+    GLProfile::lineWidth(1.5f);
+    drawRange(0, HISTORY_ROWS * rowIndices);
     
     // Reset line width to default
-    glLineWidth(1.0f);
+    GLProfile::lineWidth(1.0f);
+    
+    mesh.unbind();
+    ShaderProgram::release();
 }
 
 #ifdef __APPLE__
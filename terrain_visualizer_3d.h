@@ -2,6 +2,11 @@
 #define TERRAIN_VISUALIZER_3D_H
 
 #include "visualizer_base.h"
+#include "gl_math.h"
+#include "shader_program.h"
+#include "uniform_buffer.h"
+#include "vertex_array.h"
+#include <GL/glew.h>
 #include <vector>
 #include <array>
 
@@ -14,17 +19,13 @@ public:
     // Initialize with custom settings
     void initialize(int width, int height) override;
 
+    bool supportsCoreProfile() const override { return true; }
+
     // Implement the base class methods
-    void renderFrame(const std::vector<float> &audioData,
-                    double *fftInputBuffer,
-                    fftw_complex *fftOutputBuffer,
-                    fftw_plan &fftPlan,
+    void renderFrame(const AnalysisFrame &analysis,
                     float timeSeconds) override;
 
-    void renderLiveFrame(const std::vector<float> &audioData,
-                        double *fftInputBuffer,
-                        fftw_complex *fftOutputBuffer,
-                        fftw_plan &fftPlan,
+    void renderLiveFrame(const AnalysisFrame &analysis,
                         size_t currentPosition) override;
 
 private:
@@ -43,20 +44,39 @@ private:
     static constexpr float GRID_COLOR[3] = {0.0f, 0.3f, 0.1f};  // Dim green
     
     // Rendering parameters
-    static constexpr int POINTS_PER_BAND = 200;   // Resolution of each band
-    static constexpr float LINE_WIDTH = 5.0f;     // Thickness of lines
+    static constexpr int POINTS_PER_BAND = 64;    // Resolution of each band
+    static constexpr float LINE_WIDTH = 5.0f;     // Thickness of the newest row
     static constexpr float TERRAIN_WIDTH = 12.0f; // Width of the visualization
     static constexpr float TERRAIN_HEIGHT = 2.5f; // Max height of the visualization (increased from 1.5)
-    static constexpr float BAND_SPACING = 0.6f;   // Spacing between bands
+    static constexpr float TERRAIN_DEPTH = 14.0f; // Distance from the newest row to the oldest
+
+    // History kept as terrain; each row is the bands side by side, lowest
+    // frequencies on the left
+    static constexpr int HISTORY_ROWS = 200;
+    static constexpr int ROW_POINTS = NUM_BANDS * POINTS_PER_BAND;
+    static constexpr int CONNECTOR_STEP = 16; // Points between lines joining a row to the next
     
     // FFT analysis outputs for the bands
     std::array<std::vector<float>, NUM_BANDS> bandData;
+
+    // The terrain mesh: a static buffer with each point's x and ring slot,
+    // and a ring of rows with one height per point. A frame uploads only
+    // the newest row; the shader places every row by its age.
+    ShaderProgram shader;
+    GLuint gridVbo = 0;
+    GLuint heightVbo = 0;
+    GLuint indexBuffer = 0;
+    VertexArray mesh;
+    int newestRow = HISTORY_ROWS - 1;
+    std::vector<float> rowHeights;
+    CameraUniforms camera;
     
     // Helper methods
     void setupPerspectiveView();
-    void analyzeBands(fftw_complex *fftOutput);
+    void analyzeBands(const AnalysisFrame &analysis);
+    void createBuffers();
+    void pushRow();
     void renderTerrain();
-    void updateFFT(const std::vector<float> &audioData, double *fftInputBuffer, fftw_plan &fftPlan, size_t position);
 };
 
 #endif // TERRAIN_VISUALIZER_3D_H 
\ No newline at end of file
@@ -0,0 +1,62 @@
+#ifndef TEXT_RENDERER_H
+#define TEXT_RENDERER_H
+
+#include <GL/glew.h>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Bitmap text from a 5x7 pixel font. The printable ASCII glyphs are packed
+// into one texture the first time text is drawn; after that every queued
+// character is a textured quad with its own color, and flush() draws them
+// all with a single call.
+//
+// Positions are in the current coordinate system. A character cell is
+// width x height with the glyph's left edge at x and its vertical centre
+// at y; the cell includes one pixel of spacing to the right and below.
+class TextRenderer
+{
+public:
+    static constexpr int GLYPH_WIDTH = 5;
+    static constexpr int GLYPH_HEIGHT = 7;
+
+    TextRenderer() = default;
+    ~TextRenderer();
+
+    TextRenderer(const TextRenderer &) = delete;
+    TextRenderer &operator=(const TextRenderer &) = delete;
+
+    // Color for the characters that follow
+    void color(float r, float g, float b, float a = 1.0f);
+    void color(const float rgb[3]) { color(rgb[0], rgb[1], rgb[2]); }
+
+    // Queue one character; spaces only take up room, and characters
+    // outside printable ASCII show as '?'
+    void glyph(char c, float x, float y, float width, float height);
+
+    // Queue a string, advancing width per character and stopping before a
+    // character would start at maxX. Returns the x after the last one.
+    float text(const std::string &s, float x, float y, float width, float height, float maxX = 1.0f);
+
+    // Draw everything queued since the last flush, alpha blended
+    void flush();
+
+private:
+    struct Vertex
+    {
+        float x, y;
+        float u, v;
+        uint8_t rgba[4];
+    };
+
+    void createAtlas();
+
+    std::vector<Vertex> vertices;
+    uint8_t currentColor[4] = {255, 255, 255, 255};
+
+    GLuint texture = 0;
+    GLuint vbo = 0;
+    size_t vboCapacity = 0; // Bytes
+};
+
+#endif // TEXT_RENDERER_H
@@ -0,0 +1,56 @@
+#include "uniform_buffer.h"
+
+UniformBuffer::~UniformBuffer()
+{
+    if (buffer)
+    {
+        glDeleteBuffers(1, &buffer);
+    }
+}
+
+void UniformBuffer::update(const void *data, size_t size)
+{
+    if (!buffer)
+    {
+        glGenBuffers(1, &buffer);
+    }
+
+    // Orphaned when it grows; otherwise rewritten in place, which is only
+    // a few bytes per frame
+    glBindBuffer(GL_UNIFORM_BUFFER, buffer);
+    if (size > capacity)
+    {
+        glBufferData(GL_UNIFORM_BUFFER, size, nullptr, GL_DYNAMIC_DRAW);
+        capacity = size;
+    }
+    glBufferSubData(GL_UNIFORM_BUFFER, 0, size, data);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    bind();
+}
+
+void UniformBuffer::bind() const
+{
+    glBindBufferBase(GL_UNIFORM_BUFFER, binding, buffer);
+}
+
+void CameraUniforms::set(const Mat4 &viewProjection)
+{
+    matrix = viewProjection;
+    if (GLProfile::core())
+    {
+        // std140 lays a mat4 out as four vec4 columns, as Mat4 does
+        buffer.update(matrix.data(), sizeof(matrix.m));
+    }
+}
+
+void CameraUniforms::apply(const ShaderProgram &program) const
+{
+    if (GLProfile::core())
+    {
+        buffer.bind();
+    }
+    else
+    {
+        ShaderProgram::set(program.uniform("viewProjection"), matrix);
+    }
+}
@@ -0,0 +1,51 @@
+#ifndef UNIFORM_BUFFER_H
+#define UNIFORM_BUFFER_H
+
+#include "gl_math.h"
+#include "shader_program.h"
+#include <GL/glew.h>
+#include <cstddef>
+
+// Contents of a std140 uniform block, shared by every program that
+// declares the block on the core profile
+class UniformBuffer
+{
+public:
+    explicit UniformBuffer(UniformBlockBinding binding) : binding(binding) {}
+    ~UniformBuffer();
+
+    UniformBuffer(const UniformBuffer &) = delete;
+    UniformBuffer &operator=(const UniformBuffer &) = delete;
+
+    // Replace the contents, creating the buffer on first use, and bind it
+    // to its binding point
+    void update(const void *data, size_t size);
+
+    // Bind to the binding point again, in case another buffer took it
+    void bind() const;
+
+private:
+    UniformBlockBinding binding;
+    GLuint buffer = 0;
+    size_t capacity = 0; // Bytes
+};
+
+// The viewProjection matrix that shaders declare with CAMERA_UNIFORMS. On
+// the core profile set() uploads it once per frame for all programs;
+// otherwise apply() sets it on each program as a plain uniform.
+class CameraUniforms
+{
+public:
+    CameraUniforms() : buffer(CAMERA_BLOCK) {}
+
+    void set(const Mat4 &viewProjection);
+
+    // For the program in use
+    void apply(const ShaderProgram &program) const;
+
+private:
+    UniformBuffer buffer;
+    Mat4 matrix = identityMatrix();
+};
+
+#endif // UNIFORM_BUFFER_H
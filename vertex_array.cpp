@@ -0,0 +1,100 @@
+#include "vertex_array.h"
+#include "gl_profile.h"
+
+VertexArray::~VertexArray()
+{
+    if (vao)
+    {
+        glDeleteVertexArrays(1, &vao);
+    }
+}
+
+void VertexArray::attribute(GLuint index, GLuint buffer, GLint size, GLsizei stride, size_t offset,
+                            GLuint divisor)
+{
+    attributes.push_back({index, buffer, size, stride, offset, divisor});
+}
+
+void VertexArray::enableAttributes() const
+{
+    for (const Attribute &attribute : attributes)
+    {
+        glBindBuffer(GL_ARRAY_BUFFER, attribute.buffer);
+        glEnableVertexAttribArray(attribute.index);
+        glVertexAttribPointer(attribute.index, attribute.size, GL_FLOAT, GL_FALSE, attribute.stride,
+                              reinterpret_cast<const void *>(attribute.offset));
+        if (GLProfile::core())
+        {
+            glVertexAttribDivisor(attribute.index, attribute.divisor);
+        }
+        else if (attribute.divisor)
+        {
+            glVertexAttribDivisorARB(attribute.index, attribute.divisor);
+        }
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    if (elementBuffer)
+    {
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, elementBuffer);
+    }
+}
+
+void VertexArray::bind()
+{
+    if (!GLProfile::core())
+    {
+        enableAttributes();
+        return;
+    }
+
+    if (vao)
+    {
+        glBindVertexArray(vao);
+        return;
+    }
+
+    // The array buffer binding is not part of the object, but each
+    // attribute's buffer and the element buffer are
+    glGenVertexArrays(1, &vao);
+    glBindVertexArray(vao);
+    enableAttributes();
+}
+
+void VertexArray::unbind() const
+{
+    if (GLProfile::core())
+    {
+        glBindVertexArray(0);
+        return;
+    }
+
+    for (const Attribute &attribute : attributes)
+    {
+        if (attribute.divisor)
+        {
+            glVertexAttribDivisorARB(attribute.index, 0);
+        }
+        glDisableVertexAttribArray(attribute.index);
+    }
+    if (elementBuffer)
+    {
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    }
+}
+
+bool VertexArray::instancing()
+{
+    return GLProfile::core() || GLEW_ARB_instanced_arrays;
+}
+
+void VertexArray::drawArraysInstanced(GLenum mode, GLint first, GLsizei count, GLsizei instances)
+{
+    if (GLProfile::core())
+    {
+        glDrawArraysInstanced(mode, first, count, instances);
+    }
+    else
+    {
+        glDrawArraysInstancedARB(mode, first, count, instances);
+    }
+}
@@ -0,0 +1,57 @@
+#ifndef VERTEX_ARRAY_H
+#define VERTEX_ARRAY_H
+
+#include <GL/glew.h>
+#include <cstddef>
+#include <vector>
+
+// Where a draw's attributes come from. The core profile has no default
+// vertex array, so there the layout is recorded once in a vertex array
+// object; on the compatibility profile bind() sets the attribute pointers
+// every time and unbind() disables them again.
+class VertexArray
+{
+public:
+    VertexArray() = default;
+    ~VertexArray();
+
+    VertexArray(const VertexArray &) = delete;
+    VertexArray &operator=(const VertexArray &) = delete;
+
+    // Read attribute index as size floats every stride bytes from offset
+    // in buffer, stepping once per instance when divisor is 1. Describe
+    // every attribute, and the element buffer if any, before the first
+    // bind().
+    void attribute(GLuint index, GLuint buffer, GLint size, GLsizei stride = 0, size_t offset = 0,
+                   GLuint divisor = 0);
+    void elements(GLuint buffer) { elementBuffer = buffer; }
+
+    bool empty() const { return attributes.empty(); }
+
+    void bind();
+    void unbind() const;
+
+    // Whether divisors and instanced draws are available: always on the
+    // core profile, otherwise with ARB_instanced_arrays
+    static bool instancing();
+    static void drawArraysInstanced(GLenum mode, GLint first, GLsizei count, GLsizei instances);
+
+private:
+    struct Attribute
+    {
+        GLuint index;
+        GLuint buffer;
+        GLint size;
+        GLsizei stride;
+        size_t offset;
+        GLuint divisor;
+    };
+
+    void enableAttributes() const;
+
+    std::vector<Attribute> attributes;
+    GLuint elementBuffer = 0;
+    GLuint vao = 0;
+};
+
+#endif // VERTEX_ARRAY_H
@@ -0,0 +1,597 @@
+#include "video_recorder.h"
+#include "yuv_convert.h"
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+extern "C"
+{
+#include <libavcodec/avcodec.h>
+#include <libavformat/avformat.h>
+#include <libavutil/imgutils.h>
+#include <libavutil/opt.h>
+#include <libavutil/mathematics.h>
+}
+
+VideoRecorder::VideoRecorder(MixEngine &mixer, int sampleRate, int channels)
+    : mixer(mixer), sampleRate(sampleRate), channels(channels)
+{
+}
+
+VideoRecorder::~VideoRecorder()
+{
+    if (muxThread.joinable())
+    {
+        finish();
+    }
+    release();
+}
+
+bool VideoRecorder::open(const std::string &filename, int frameWidth, int frameHeight, int framesPerSecond)
+{
+    width = frameWidth;
+    height = frameHeight;
+    fps = framesPerSecond;
+
+    if (!openEncoders(filename))
+    {
+        release();
+        return false;
+    }
+
+    // Frames for the render thread to fill
+    for (int i = 0; i < POOL_SIZE; i++)
+    {
+        std::unique_ptr<Frame> frame(new Frame());
+        frame->pixels.resize(static_cast<size_t>(width) * height * 4);
+        frame->yuv = av_frame_alloc();
+        if (!frame->yuv)
+        {
+            std::cerr << "Could not allocate video frames" << std::endl;
+            release();
+            return false;
+        }
+        frame->yuv->format = videoCodecContext->pix_fmt;
+        frame->yuv->width = videoCodecContext->width;
+        frame->yuv->height = videoCodecContext->height;
+        if (av_frame_get_buffer(frame->yuv, 0) < 0)
+        {
+            std::cerr << "Could not allocate frame buffers" << std::endl;
+            av_frame_free(&frame->yuv);
+            release();
+            return false;
+        }
+        freeFrames.push_back(frame.get());
+        pool.push_back(std::move(frame));
+    }
+
+    // The render thread and the encoder thread keep a core each
+    int hardwareThreads = static_cast<int>(std::thread::hardware_concurrency());
+    int workerCount = std::max(1, std::min(MAX_CONVERSION_WORKERS, hardwareThreads - 2));
+
+    // Large frames are split into slices of whole chroma rows, so one
+    // frame converts on several workers at once
+    int slicesWanted = static_cast<int>((static_cast<int64_t>(width) * height + SLICE_PIXELS - 1) / SLICE_PIXELS);
+    sliceCount = std::max(1, std::min(workerCount, slicesWanted));
+    sliceRows = ((height + sliceCount - 1) / sliceCount + 1) & ~1;
+    sliceCount = (height + sliceRows - 1) / sliceRows;
+
+    for (int i = 0; i < workerCount; i++)
+    {
+        conversionWorkers.emplace_back(&VideoRecorder::conversionLoop, this);
+    }
+    encoderThread = std::thread(&VideoRecorder::encoderLoop, this);
+    muxThread = std::thread(&VideoRecorder::muxLoop, this);
+
+    std::cout << "Video encoder initialized successfully (" << workerCount << " conversion threads)" << std::endl;
+    return true;
+}
+
+bool VideoRecorder::openEncoders(const std::string &filename)
+{
+    const AVCodec *videoCodec = avcodec_find_encoder(AV_CODEC_ID_H264);
+    if (!videoCodec)
+    {
+        std::cerr << "Could not find H.264 encoder" << std::endl;
+        return false;
+    }
+
+    const AVCodec *audioCodec = avcodec_find_encoder(AV_CODEC_ID_AAC);
+    if (!audioCodec)
+    {
+        std::cerr << "Could not find AAC encoder" << std::endl;
+        return false;
+    }
+
+    // Create output format context
+    if (avformat_alloc_output_context2(&formatContext, nullptr, nullptr, filename.c_str()) < 0)
+    {
+        std::cerr << "Could not create output context" << std::endl;
+        return false;
+    }
+
+    // Set up video codec context
+    videoCodecContext = avcodec_alloc_context3(videoCodec);
+    if (!videoCodecContext)
+    {
+        std::cerr << "Could not allocate video codec context" << std::endl;
+        return false;
+    }
+
+    // Set video codec parameters; 4:2:0 needs even dimensions, so an odd
+    // size is encoded one pixel larger with the edge repeated
+    videoCodecContext->width = (width + 1) & ~1;
+    videoCodecContext->height = (height + 1) & ~1;
+    if (videoCodecContext->width != width || videoCodecContext->height != height)
+    {
+        std::cout << "Encoding " << width << "x" << height << " frames at "
+                  << videoCodecContext->width << "x" << videoCodecContext->height << std::endl;
+    }
+    videoCodecContext->time_base = AVRational{1, fps};
+    videoCodecContext->framerate = AVRational{fps, 1};
+    videoCodecContext->pix_fmt = AV_PIX_FMT_YUV420P;
+    videoCodecContext->gop_size = 12;
+    videoCodecContext->max_b_frames = 2;
+
+    // Set codec-specific options
+    av_opt_set(videoCodecContext->priv_data, "preset", "medium", 0);
+
+    // Open video codec
+    if (avcodec_open2(videoCodecContext, videoCodec, nullptr) < 0)
+    {
+        std::cerr << "Could not open video codec" << std::endl;
+        return false;
+    }
+
+    // Add video stream
+    videoStream = avformat_new_stream(formatContext, nullptr);
+    if (!videoStream)
+    {
+        std::cerr << "Could not create video stream" << std::endl;
+        return false;
+    }
+
+    videoStream->time_base = videoCodecContext->time_base;
+    avcodec_parameters_from_context(videoStream->codecpar, videoCodecContext);
+
+    // Set up audio codec context
+    audioCodecContext = avcodec_alloc_context3(audioCodec);
+    if (!audioCodecContext)
+    {
+        std::cerr << "Could not allocate audio codec context" << std::endl;
+        return false;
+    }
+
+    // Set audio codec parameters
+    audioCodecContext->sample_fmt = AV_SAMPLE_FMT_FLTP; // planar float format
+    audioCodecContext->sample_rate = sampleRate;
+#if LIBAVUTIL_VERSION_MAJOR >= 57
+    audioCodecContext->ch_layout = (channels > 1) ? (AVChannelLayout)AV_CHANNEL_LAYOUT_STEREO : (AVChannelLayout)AV_CHANNEL_LAYOUT_MONO;
+#else
+    audioCodecContext->channel_layout = (channels > 1) ? AV_CH_LAYOUT_STEREO : AV_CH_LAYOUT_MONO;
+    audioCodecContext->channels = channels;
+#endif
+    audioCodecContext->time_base = AVRational{1, sampleRate};
+    audioCodecContext->bit_rate = 128000;
+
+    // Open audio codec
+    if (avcodec_open2(audioCodecContext, audioCodec, nullptr) < 0)
+    {
+        std::cerr << "Could not open audio codec" << std::endl;
+        return false;
+    }
+
+    // Add audio stream
+    audioStream = avformat_new_stream(formatContext, nullptr);
+    if (!audioStream)
+    {
+        std::cerr << "Could not create audio stream" << std::endl;
+        return false;
+    }
+
+    audioStream->time_base = audioCodecContext->time_base;
+    avcodec_parameters_from_context(audioStream->codecpar, audioCodecContext);
+
+    // Open output file
+    if (!(formatContext->oformat->flags & AVFMT_NOFILE))
+    {
+        if (avio_open(&formatContext->pb, filename.c_str(), AVIO_FLAG_WRITE) < 0)
+        {
+            std::cerr << "Could not open output file: " << filename << std::endl;
+            return false;
+        }
+    }
+
+    // Write file header
+    if (avformat_write_header(formatContext, nullptr) < 0)
+    {
+        std::cerr << "Could not write header" << std::endl;
+        return false;
+    }
+
+    // Allocate audio frame - we'll use the frame size reported by the encoder
+    int frameSize = audioCodecContext->frame_size;
+    if (frameSize <= 0)
+    {
+        // AAC typically uses 1024 samples per frame
+        frameSize = 1024;
+        std::cout << "Using default AAC frame size: " << frameSize << std::endl;
+    }
+    else
+    {
+        std::cout << "AAC encoder frame size: " << frameSize << std::endl;
+    }
+
+    audioFrame = av_frame_alloc();
+    if (!audioFrame)
+    {
+        std::cerr << "Could not allocate audio frame" << std::endl;
+        return false;
+    }
+
+    audioFrame->format = audioCodecContext->sample_fmt;
+#if LIBAVUTIL_VERSION_MAJOR >= 57
+    audioFrame->ch_layout = audioCodecContext->ch_layout;
+#else
+    audioFrame->channel_layout = audioCodecContext->channel_layout;
+    audioFrame->channels = audioCodecContext->channels;
+#endif
+    audioFrame->sample_rate = audioCodecContext->sample_rate;
+    audioFrame->nb_samples = frameSize;
+
+    if (av_frame_get_buffer(audioFrame, 0) < 0)
+    {
+        std::cerr << "Could not allocate audio frame buffer" << std::endl;
+        return false;
+    }
+
+    // Log audio encoding information
+    std::cout << "Audio codec configured: "
+              << (channels > 1 ? "Stereo" : "Mono")
+              << " output at " << sampleRate << " Hz" << std::endl;
+
+    videoPacket = av_packet_alloc();
+    audioPacket = av_packet_alloc();
+    if (!videoPacket || !audioPacket)
+    {
+        std::cerr << "Could not allocate packet" << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+void VideoRecorder::release()
+{
+    for (std::unique_ptr<Frame> &frame : pool)
+    {
+        av_frame_free(&frame->yuv);
+    }
+    pool.clear();
+    freeFrames.clear();
+    for (AVPacket *packet : videoPackets)
+    {
+        av_packet_free(&packet);
+    }
+    videoPackets.clear();
+
+    if (formatContext && formatContext->pb && !(formatContext->oformat->flags & AVFMT_NOFILE))
+    {
+        avio_closep(&formatContext->pb);
+    }
+    av_frame_free(&audioFrame);
+    av_packet_free(&videoPacket);
+    av_packet_free(&audioPacket);
+    avcodec_free_context(&videoCodecContext);
+    avcodec_free_context(&audioCodecContext);
+    avformat_free_context(formatContext);
+    formatContext = nullptr;
+    videoStream = nullptr;
+    audioStream = nullptr;
+}
+
+VideoRecorder::Frame *VideoRecorder::acquireFrame()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    frameFreed.wait(lock, [this]
+                    { return !freeFrames.empty(); });
+    Frame *frame = freeFrames.back();
+    freeFrames.pop_back();
+    return frame;
+}
+
+void VideoRecorder::submitFrame(Frame *frame)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        frame->sequence = submitted++;
+        frame->slicesLeft = sliceCount;
+        lastIndex = std::max(lastIndex, frame->index);
+        for (int row = 0; row < height; row += sliceRows)
+        {
+            toConvert.push_back(Slice{frame, row, std::min(height, row + sliceRows)});
+        }
+    }
+    if (sliceCount > 1)
+    {
+        conversionReady.notify_all();
+    }
+    else
+    {
+        conversionReady.notify_one();
+    }
+}
+
+void VideoRecorder::finish()
+{
+    if (!muxThread.joinable())
+        return;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        finishing = true;
+        audioEnd = av_rescale_q(lastIndex + 1, AVRational{1, fps}, AVRational{1, sampleRate});
+    }
+    conversionReady.notify_all();
+    encodeReady.notify_all();
+
+    for (std::thread &worker : conversionWorkers)
+    {
+        worker.join();
+    }
+    conversionWorkers.clear();
+    encoderThread.join();
+    muxThread.join();
+
+    // Write file trailer
+    av_write_trailer(formatContext);
+    release();
+}
+
+void VideoRecorder::conversionLoop()
+{
+    for (;;)
+    {
+        Slice slice;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            conversionReady.wait(lock, [this]
+                                 { return !toConvert.empty() || finishing; });
+            if (toConvert.empty())
+                break;
+            slice = toConvert.front();
+            toConvert.pop_front();
+        }
+
+        // Flip and convert in one pass, straight from the readback
+        Frame &frame = *slice.frame;
+        rgbaToYuv420(frame.pixels.data(), width, height, slice.firstRow, slice.endRow,
+                     frame.yuv->data, frame.yuv->linesize);
+        padEdges(*frame.yuv, slice.firstRow, slice.endRow);
+
+        // Whichever worker finishes the last slice hands the frame on
+        bool complete;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            complete = --frame.slicesLeft == 0;
+            if (complete)
+            {
+                converted[frame.sequence] = &frame;
+            }
+        }
+        if (complete)
+        {
+            encodeReady.notify_one();
+        }
+    }
+}
+
+void VideoRecorder::padEdges(AVFrame &yuv, int firstRow, int endRow)
+{
+    // The chroma planes already cover odd sizes; only luma has an extra
+    // column or row to fill
+    uint8_t *luma = yuv.data[0];
+    const int stride = yuv.linesize[0];
+    if (width & 1)
+    {
+        for (int y = firstRow; y < endRow; y++)
+        {
+            luma[y * stride + width] = luma[y * stride + width - 1];
+        }
+    }
+    if ((height & 1) && endRow == height)
+    {
+        std::memcpy(luma + height * stride, luma + (height - 1) * stride, yuv.width);
+    }
+}
+
+void VideoRecorder::encoderLoop()
+{
+    // libx264 takes the frames in submission order, whichever worker
+    // finished first
+    uint64_t next = 0;
+    for (;;)
+    {
+        Frame *frame;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            encodeReady.wait(lock, [&]
+                             { return converted.count(next) > 0 || (finishing && next == submitted); });
+            auto found = converted.find(next);
+            if (found == converted.end())
+                break;
+            frame = found->second;
+            converted.erase(found);
+        }
+        next++;
+
+        frame->yuv->pts = frame->index;
+        if (avcodec_send_frame(videoCodecContext, frame->yuv) < 0)
+        {
+            std::cerr << "Error sending frame to encoder" << std::endl;
+        }
+
+        // The encoder may still hold this picture; give the frame its own
+        // buffer before the workers write into it again
+        if (av_frame_make_writable(frame->yuv) < 0)
+        {
+            std::cerr << "Could not make video frame writable" << std::endl;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            freeFrames.push_back(frame);
+        }
+        frameFreed.notify_one();
+
+        receiveVideoPackets();
+    }
+
+    // Flush video encoder
+    avcodec_send_frame(videoCodecContext, nullptr);
+    receiveVideoPackets();
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        videoDone = true;
+    }
+    packetReady.notify_one();
+}
+
+void VideoRecorder::receiveVideoPackets()
+{
+    while (true)
+    {
+        int ret = avcodec_receive_packet(videoCodecContext, videoPacket);
+        if (ret == AVERROR(EAGAIN) || ret == AVERROR_EOF)
+            break;
+        if (ret < 0)
+        {
+            std::cerr << "Error receiving packet from encoder" << std::endl;
+            break;
+        }
+
+        AVPacket *queued = av_packet_alloc();
+        if (!queued)
+        {
+            std::cerr << "Could not allocate packet" << std::endl;
+            av_packet_unref(videoPacket);
+            continue;
+        }
+        av_packet_move_ref(queued, videoPacket);
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            videoPackets.push_back(queued);
+        }
+        packetReady.notify_one();
+    }
+}
+
+void VideoRecorder::muxLoop()
+{
+    for (;;)
+    {
+        AVPacket *packet;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            packetReady.wait(lock, [this]
+                             { return !videoPackets.empty() || videoDone; });
+            if (videoPackets.empty())
+                break;
+            packet = videoPackets.front();
+            videoPackets.pop_front();
+        }
+
+        // Bring the audio up to where this packet is decoded, so the file
+        // alternates between the streams in timestamp order
+        int64_t decodeTime = std::max<int64_t>(packet->dts, 0);
+        encodeAudioUntil(av_rescale_q(decodeTime, videoCodecContext->time_base, AVRational{1, sampleRate}));
+
+        av_packet_rescale_ts(packet, videoCodecContext->time_base, videoStream->time_base);
+        packet->stream_index = videoStream->index;
+        if (av_interleaved_write_frame(formatContext, packet) < 0)
+        {
+            std::cerr << "Error writing frame to file" << std::endl;
+        }
+        av_packet_free(&packet);
+    }
+
+    // The rest of the audio, to the end of the last frame
+    int64_t endSample;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        endSample = audioEnd;
+    }
+    encodeAudioUntil(endSample);
+
+    // Flush audio encoder
+    avcodec_send_frame(audioCodecContext, nullptr);
+    receiveAudioPackets();
+}
+
+void VideoRecorder::encodeAudioUntil(int64_t endSample)
+{
+    // Process audio in chunks of the encoder's frame size
+    const int frameSize = audioFrame->nb_samples;
+    while (audioPosition < endSample)
+    {
+        // Prepare the audio frame
+        av_frame_make_writable(audioFrame);
+
+        // Mix all audio sources together in one pass
+        const MixBlock &block = mixer.mix(static_cast<size_t>(audioPosition), frameSize);
+        if (channels > 1)
+        {
+            // For planar float format (FLTP), we need separate planes for each channel
+            std::memcpy(audioFrame->data[0], block.left.data(), frameSize * sizeof(float));
+            std::memcpy(audioFrame->data[1], block.right.data(), frameSize * sizeof(float));
+        }
+        else
+        {
+            std::memcpy(audioFrame->data[0], block.mono.data(), frameSize * sizeof(float));
+        }
+
+        // Set timestamp for this audio frame
+        audioFrame->pts = audioPosition;
+        audioPosition += frameSize;
+
+        // Encode this audio frame
+        int ret = avcodec_send_frame(audioCodecContext, audioFrame);
+        if (ret < 0)
+        {
+            char errBuf[AV_ERROR_MAX_STRING_SIZE];
+            av_strerror(ret, errBuf, AV_ERROR_MAX_STRING_SIZE);
+            std::cerr << "Error sending audio frame to encoder: " << errBuf << std::endl;
+            continue;
+        }
+        receiveAudioPackets();
+    }
+}
+
+void VideoRecorder::receiveAudioPackets()
+{
+    while (true)
+    {
+        int ret = avcodec_receive_packet(audioCodecContext, audioPacket);
+        if (ret == AVERROR(EAGAIN) || ret == AVERROR_EOF)
+            break;
+        if (ret < 0)
+        {
+            std::cerr << "Error receiving audio packet from encoder" << std::endl;
+            break;
+        }
+
+        av_packet_rescale_ts(audioPacket, audioCodecContext->time_base, audioStream->time_base);
+        audioPacket->stream_index = audioStream->index;
+
+        ret = av_interleaved_write_frame(formatContext, audioPacket);
+        if (ret < 0)
+        {
+            char errBuf[AV_ERROR_MAX_STRING_SIZE];
+            av_strerror(ret, errBuf, AV_ERROR_MAX_STRING_SIZE);
+            std::cerr << "Error writing audio frame to file: " << errBuf << std::endl;
+        }
+
+        av_packet_unref(audioPacket);
+    }
+}
@@ -0,0 +1,133 @@
+#ifndef VIDEO_RECORDER_H
+#define VIDEO_RECORDER_H
+
+#include "mix_engine.h"
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct AVCodecContext;
+struct AVFormatContext;
+struct AVFrame;
+struct AVPacket;
+struct AVStream;
+
+// Writes a recording: the video frames to H.264 and the mix to AAC, muxed
+// into one file. The work is pipelined across threads so the render thread
+// only draws and reads back:
+//   - the render thread fills frames from a fixed pool and submits them
+//   - conversion workers flip the frames and convert them to YUV 4:2:0,
+//     several frames at once, and large frames in slices of rows
+//   - the encoder thread feeds the converted frames to libx264 in order
+//   - the mux thread encodes the audio up to each video packet's time and
+//     writes both streams, interleaved by timestamp
+// When encoding falls behind, the pool runs dry and the render thread
+// waits, so memory stays bounded.
+class VideoRecorder
+{
+public:
+    // A pooled frame, filled by the render thread
+    struct Frame
+    {
+        int index = 0;               // Frame number, used as the video timestamp
+        std::vector<uint8_t> pixels; // RGBA rows, bottom row first, as read back
+        AVFrame *yuv = nullptr;      // The converted picture
+        uint64_t sequence = 0;       // Submission order, set by submitFrame()
+        int slicesLeft = 0;          // Slices still converting, guarded by mutex
+    };
+
+    // The mixer is driven from the mux thread until finish()
+    VideoRecorder(MixEngine &mixer, int sampleRate, int channels);
+    ~VideoRecorder();
+
+    VideoRecorder(const VideoRecorder &) = delete;
+    VideoRecorder &operator=(const VideoRecorder &) = delete;
+
+    // Create the file, open both encoders and start the threads. Any size
+    // works; an odd one is padded to even for the encoder. Errors are
+    // reported on std::cerr.
+    bool open(const std::string &filename, int width, int height, int fps);
+
+    // Render thread: a free frame of width x height pixels, waiting while
+    // every frame is in flight
+    Frame *acquireFrame();
+
+    // Render thread: queue a filled frame for encoding
+    void submitFrame(Frame *frame);
+
+    // Encode everything submitted, then flush the encoders and close the
+    // file; the audio runs to the end of the last frame
+    void finish();
+
+private:
+    static constexpr int POOL_SIZE = 8;
+    static constexpr int MAX_CONVERSION_WORKERS = 4;
+    static constexpr int SLICE_PIXELS = 1 << 19; // Frames larger than this are split
+
+    // Rows [firstRow, endRow) of a frame, for one conversion worker
+    struct Slice
+    {
+        Frame *frame;
+        int firstRow;
+        int endRow;
+    };
+
+    bool openEncoders(const std::string &filename);
+    void release();
+
+    void conversionLoop();
+    void encoderLoop();
+    void muxLoop();
+    void padEdges(AVFrame &yuv, int firstRow, int endRow);
+    void receiveVideoPackets();
+    void encodeAudioUntil(int64_t endSample);
+    void receiveAudioPackets();
+
+    MixEngine &mixer;
+    const int sampleRate;
+    const int channels;
+    int width = 0;
+    int height = 0;
+    int fps = 0;
+    int sliceCount = 1; // Slices per frame
+    int sliceRows = 0;  // Rows per slice, even
+
+    AVFormatContext *formatContext = nullptr;
+    AVCodecContext *videoCodecContext = nullptr;
+    AVCodecContext *audioCodecContext = nullptr;
+    AVStream *videoStream = nullptr;
+    AVStream *audioStream = nullptr;
+    AVFrame *audioFrame = nullptr;
+    AVPacket *videoPacket = nullptr; // Encoder thread only
+    AVPacket *audioPacket = nullptr; // Mux thread only
+    int64_t audioPosition = 0;       // Next sample to encode, mux thread only
+
+    // Pipeline state, guarded by mutex
+    std::vector<std::unique_ptr<Frame>> pool;
+    std::vector<Frame *> freeFrames;
+    std::deque<Slice> toConvert;
+    std::map<uint64_t, Frame *> converted; // By sequence, until it is their turn
+    std::deque<AVPacket *> videoPackets;   // Encoded, for the mux thread
+    uint64_t submitted = 0;
+    int lastIndex = -1;
+    int64_t audioEnd = 0;
+    bool finishing = false;
+    bool videoDone = false;
+    std::mutex mutex;
+    std::condition_variable frameFreed;
+    std::condition_variable conversionReady;
+    std::condition_variable encodeReady;
+    std::condition_variable packetReady;
+
+    std::vector<std::thread> conversionWorkers;
+    std::thread encoderThread;
+    std::thread muxThread;
+};
+
+#endif // VIDEO_RECORDER_H
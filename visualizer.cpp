@@ -1,18 +1,19 @@
 #include <GL/glew.h>
 #include <GLFW/glfw3.h>
-#include <fftw3.h>
 #include <iostream>
 #include <vector>
 #include <cmath>
-#include <sndfile.h>
+#include <algorithm>
 #include <portaudio.h> // Add PortAudio back for live playback
 #include <string>
 #include <thread>
 #include <mutex>
 #include <atomic>
+#include <cstdio>  // For sscanf
 #include <cstring> // For strcmp
 #include <chrono>  // For timing
 #include <memory>
+#include <map>
 
 // Include our visualization components
 #include "visualizer_base.h"
@@ -22,17 +23,16 @@
 #include "multi_band_circle_waveform.h" // Add this include for MultiBandCircleWaveform class
 #include "grid_visualizer.h"
 #include "scroller_text.h"
-
-// FFmpeg libraries
-extern "C"
-{
-#include <libavcodec/avcodec.h>
-#include <libavformat/avformat.h>
-#include <libavutil/imgutils.h>
-#include <libavutil/opt.h>
-#include <libswscale/swscale.h>
-#include <libavutil/mathematics.h>
-}
+#include "audio_source.h"
+#include "live_playback.h"
+#include "mix_engine.h"
+#include "spectrum_kernels.h"
+#include "fft_planner.h"
+#include "crt_effect.h"
+#include "frame_readback.h"
+#include "gl_profile.h"
+#include "render_target.h"
+#include "video_recorder.h"
 
 // Window dimensions
 const int WIDTH = 800, HEIGHT = 600;
@@ -42,693 +42,268 @@ VisualizerType currentVisualizerType = BAR_EQUALIZER; // Default
 std::shared_ptr<Visualizer> currentVisualizer;
 
 // FFT Settings
-const int N = 1024;  // Number of samples (must be power of 2)
-double in[N];        // Input signal
-fftw_complex out[N]; // FFT output
-fftw_plan plan;      // FFTW plan
+const int N = 1024;             // Default number of samples (must be power of 2)
+const int MAX_FFT_SIZE = 16384; // Largest size a visualizer may ask for
 
 // Audio settings
 const int SAMPLE_RATE = 44100;
 const int FRAMES_PER_BUFFER = 512;         // For PortAudio
-const int OUTPUT_CHANNELS = 1;             // Always output mono audio for live playback
-std::vector<float> audioData;              // Our internal buffer is always mono for visualization
-std::vector<float> originalAudioData;      // Store original multi-channel audio
+const int OUTPUT_CHANNELS = 1;             // Mono output unless the input is stereo or panned
 int originalChannels = 1;                  // Number of channels in the original audio
-std::atomic<bool> playbackFinished(false); // For live mode
-std::atomic<size_t> currentPosition(0);    // For live mode
-std::mutex audioMutex;                     // For live mode
+int mixChannels = OUTPUT_CHANNELS;         // Channels played back and recorded
+std::unique_ptr<LivePlayback> livePlayback; // For live mode
+
+// Shared spectrum analysis, computed once per frame. One analyzer per FFT
+// size, created the first time a visualizer asks for that size.
+std::map<int, std::unique_ptr<SpectrumAnalyzer>> spectrumAnalyzers;
+
+// Post-process stage for visualizers that opt into the CRT look; owns GL
+// objects, so it is released before the window
+std::unique_ptr<CRTEffect> crtEffect;
 
 // Video recording settings
 bool recordVideo = false;
 std::string outputVideoFile;
 const int FPS = 30;
-AVFormatContext *formatContext = nullptr;
-AVCodecContext *videoCodecContext = nullptr;
-AVCodecContext *audioCodecContext = nullptr;
-AVStream *videoStream = nullptr;
-AVStream *audioStream = nullptr;
-SwsContext *swsContext = nullptr;
-AVFrame *videoFrame = nullptr;
-AVFrame *rgbFrame = nullptr;
-AVFrame *audioFrame = nullptr;
-AVPacket *packet = nullptr;
-std::vector<uint8_t> frameBuffer;
-
-// Add to the top of the file with other global variables
-std::vector<std::vector<float>> multiAudioData; // Store multiple audio sources
-std::vector<std::string> audioFilenames;        // Store filenames for multiple sources
+// Frames analyzed ahead per batch in record mode. The workers read up to two
+// batches ahead of the render loop, which must stay inside the history a
+// streaming source keeps behind its furthest read.
+const int PRECOMPUTE_BATCH_FRAMES = 128;
+std::unique_ptr<VideoRecorder> videoRecorder;
+std::unique_ptr<FrameReadback> frameReadback; // Owns GL buffers, released with the recorder
+std::unique_ptr<RenderTarget> renderTarget;   // Offscreen frame at the output size, likewise
+int outputWidth = 0, outputHeight = 0;        // From --size, or the visualizer type's default
+int msaaSamples = 0;                          // From --msaa; 0 or 1 draws without multisampling
+bool showPreview = true;                      // Show the frames in the window while recording
+const double PREVIEW_INTERVAL = 0.1;          // Seconds between preview refreshes
+
+// Audio sources, mapped or streamed from disk and always mono for visualization
+AudioSourceList audioSources;            // Store multiple audio sources
+std::vector<std::string> audioFilenames; // Store filenames for multiple sources
+size_t audioLength = 0;                  // Length of the longest source in samples
+MixEngine mixEngine;                     // Shared by live playback and the audio encoder
 
 // Forward declarations
 void keyCallback(GLFWwindow *window, int key, int scancode, int action, int mods);
 void framebufferSizeCallback(GLFWwindow *window, int width, int height);
 bool loadWavFile(const std::string &filename);
 void renderFrameAtTime(float timeSeconds);
+size_t sampleIndexForTime(float timeSeconds);
 bool initializeVideoEncoder();
 void finalizeVideoEncoder();
 void encodeVideoFrame(int frameIndex);
-void encodeAudioForFrame(int frameIndex);
-
-// Audio callback function for PortAudio (for live playback)
-static int paCallback(const void *inputBuffer, void *outputBuffer,
-                      unsigned long framesPerBuffer,
-                      const PaStreamCallbackTimeInfo *timeInfo,
-                      PaStreamCallbackFlags statusFlags,
-                      void *userData)
-{
-    // Mark unused parameters to silence compiler warnings
-    (void)inputBuffer;
-    (void)timeInfo;
-    (void)statusFlags;
-    (void)userData;
+void submitReadyFrames(bool flush);
+SpectrumAnalyzer &currentAnalyzer();
+bool beginPostProcess(CRTSettings &settings);
+void resetMatrices();
 
-    float *out = (float *)outputBuffer;
-    size_t position = currentPosition.load();
-    bool allFinished = true;
+// Sample index of the analysis block for a frame time
+size_t sampleIndexForTime(float timeSeconds)
+{
+    return static_cast<size_t>(timeSeconds * SAMPLE_RATE);
+}
 
-    // Clear output buffer
-    for (unsigned long i = 0; i < framesPerBuffer; i++)
+// Analyzer at the FFT size the current visualizer prefers
+SpectrumAnalyzer &currentAnalyzer()
+{
+    int size = currentVisualizer ? currentVisualizer->preferredFFTSize() : 0;
+    if (size <= 0 || size > MAX_FFT_SIZE || (size & (size - 1)) != 0)
     {
-        out[i] = 0.0f;
+        size = N;
     }
 
-    // Mix all audio sources together
-    std::lock_guard<std::mutex> lock(audioMutex);
-    for (const auto &source : multiAudioData)
+    std::unique_ptr<SpectrumAnalyzer> &analyzer = spectrumAnalyzers[size];
+    if (!analyzer)
     {
-        for (unsigned long i = 0; i < framesPerBuffer; i++)
-        {
-            if (position + i < source.size())
-            {
-                // Mix audio with equal weighting (1/number of sources)
-                out[i] += source[position + i] / static_cast<float>(multiAudioData.size());
-
-                // If we have enough samples, update FFT input
-                if (i < N)
-                {
-                    in[i] = static_cast<double>(out[i]);
-                }
-
-                allFinished = false;
-            }
-        }
+        analyzer.reset(new SpectrumAnalyzer(size, SAMPLE_RATE));
     }
-
-    // Update position
-    position += framesPerBuffer;
-    currentPosition.store(position);
-    playbackFinished = allFinished;
-
-    return playbackFinished ? paComplete : paContinue;
+    return *analyzer;
 }
 
-// Render a frame at the specified time
-void renderFrameAtTime(float timeSeconds)
+// Redirect the frame into the CRT stage when the current visualizer wants
+// it; returns whether the caller must finish it with crtEffect->end()
+bool beginPostProcess(CRTSettings &settings)
 {
-    // The OpenGL state (viewport, matrices) is now set by the caller
-    glClear(GL_COLOR_BUFFER_BIT);
+    settings = currentVisualizer->crtSettings();
+    if (!settings.enabled())
+        return false;
 
-    // Use the current visualizer to render the frame with multiple audio sources
-    currentVisualizer->renderFrame(multiAudioData, in, out, plan, timeSeconds);
+    if (!crtEffect)
+    {
+        crtEffect.reset(new CRTEffect());
+    }
+    return crtEffect->begin();
 }
 
-// OpenGL rendering function for live mode
-void renderLiveVisualization()
+// Identity matrices with the -1..1 view the fixed-function visualizers draw
+// in; the core profile has no matrix stack
+void resetMatrices()
 {
-    // Apply the same consistent viewport and matrix settings
-    glClear(GL_COLOR_BUFFER_BIT);
+    if (GLProfile::core())
+        return;
+
     glMatrixMode(GL_PROJECTION);
     glLoadIdentity();
     glOrtho(-1, 1, -1, 1, -1, 1);
     glMatrixMode(GL_MODELVIEW);
     glLoadIdentity();
-
-    // Use the current visualizer to render the live frame with multiple audio sources
-    currentVisualizer->renderLiveFrame(multiAudioData, in, out, plan, currentPosition.load());
 }
 
-// Initialize video encoder
-bool initializeVideoEncoder()
+// Render a frame at the specified time
+void renderFrameAtTime(float timeSeconds)
 {
-    // Allocate frame buffer
-    frameBuffer.resize(WIDTH * HEIGHT * 3); // RGB format
-
-    // Initialize FFmpeg components
-    const AVCodec *videoCodec = avcodec_find_encoder(AV_CODEC_ID_H264);
-    if (!videoCodec)
-    {
-        std::cerr << "Could not find H.264 encoder" << std::endl;
-        return false;
-    }
-
-    const AVCodec *audioCodec = avcodec_find_encoder(AV_CODEC_ID_AAC);
-    if (!audioCodec)
-    {
-        std::cerr << "Could not find AAC encoder" << std::endl;
-        return false;
-    }
+    CRTSettings crt;
+    bool postProcess = beginPostProcess(crt);
 
-    // Create output format context
-    if (avformat_alloc_output_context2(&formatContext, nullptr, nullptr, outputVideoFile.c_str()) < 0)
-    {
-        std::cerr << "Could not create output context" << std::endl;
-        return false;
-    }
-
-    // Set up video codec context
-    videoCodecContext = avcodec_alloc_context3(videoCodec);
-    if (!videoCodecContext)
-    {
-        std::cerr << "Could not allocate video codec context" << std::endl;
-        return false;
-    }
-
-    // Set video codec parameters
-    videoCodecContext->width = WIDTH;
-    videoCodecContext->height = HEIGHT;
-    videoCodecContext->time_base = (AVRational){1, FPS};
-    videoCodecContext->framerate = (AVRational){FPS, 1};
-    videoCodecContext->pix_fmt = AV_PIX_FMT_YUV420P;
-    videoCodecContext->gop_size = 12;
-    videoCodecContext->max_b_frames = 2;
-
-    // Set codec-specific options
-    av_opt_set(videoCodecContext->priv_data, "preset", "medium", 0);
-
-    // Open video codec
-    if (avcodec_open2(videoCodecContext, videoCodec, nullptr) < 0)
-    {
-        std::cerr << "Could not open video codec" << std::endl;
-        return false;
-    }
-
-    // Add video stream
-    videoStream = avformat_new_stream(formatContext, nullptr);
-    if (!videoStream)
-    {
-        std::cerr << "Could not create video stream" << std::endl;
-        return false;
-    }
-
-    videoStream->time_base = videoCodecContext->time_base;
-    avcodec_parameters_from_context(videoStream->codecpar, videoCodecContext);
-
-    // Set up audio codec context
-    audioCodecContext = avcodec_alloc_context3(audioCodec);
-    if (!audioCodecContext)
-    {
-        std::cerr << "Could not allocate audio codec context" << std::endl;
-        return false;
-    }
-
-    // Set audio codec parameters
-    audioCodecContext->sample_fmt = AV_SAMPLE_FMT_FLTP; // planar float format
-    audioCodecContext->sample_rate = SAMPLE_RATE;
-#if LIBAVUTIL_VERSION_MAJOR >= 57
-    audioCodecContext->ch_layout = (originalChannels > 1) ? (AVChannelLayout)AV_CHANNEL_LAYOUT_STEREO : (AVChannelLayout)AV_CHANNEL_LAYOUT_MONO;
-#else
-    audioCodecContext->channel_layout = (originalChannels > 1) ? AV_CH_LAYOUT_STEREO : AV_CH_LAYOUT_MONO;
-    audioCodecContext->channels = (originalChannels > 1) ? 2 : OUTPUT_CHANNELS;
-#endif
-    audioCodecContext->time_base = (AVRational){1, SAMPLE_RATE};
-    audioCodecContext->bit_rate = 128000;
-
-    // Open audio codec
-    if (avcodec_open2(audioCodecContext, audioCodec, nullptr) < 0)
-    {
-        std::cerr << "Could not open audio codec" << std::endl;
-        return false;
-    }
-
-    // Add audio stream
-    audioStream = avformat_new_stream(formatContext, nullptr);
-    if (!audioStream)
-    {
-        std::cerr << "Could not create audio stream" << std::endl;
-        return false;
-    }
-
-    audioStream->time_base = audioCodecContext->time_base;
-    avcodec_parameters_from_context(audioStream->codecpar, audioCodecContext);
-
-    // Open output file
-    if (!(formatContext->oformat->flags & AVFMT_NOFILE))
-    {
-        if (avio_open(&formatContext->pb, outputVideoFile.c_str(), AVIO_FLAG_WRITE) < 0)
-        {
-            std::cerr << "Could not open output file: " << outputVideoFile << std::endl;
-            return false;
-        }
-    }
-
-    // Write file header
-    if (avformat_write_header(formatContext, nullptr) < 0)
-    {
-        std::cerr << "Could not write header" << std::endl;
-        return false;
-    }
-
-    // Allocate video frames
-    videoFrame = av_frame_alloc();
-    rgbFrame = av_frame_alloc();
-    if (!videoFrame || !rgbFrame)
-    {
-        std::cerr << "Could not allocate video frames" << std::endl;
-        return false;
-    }
-
-    videoFrame->format = videoCodecContext->pix_fmt;
-    videoFrame->width = videoCodecContext->width;
-    videoFrame->height = videoCodecContext->height;
+    // The OpenGL state (viewport, matrices) is now set by the caller
+    glClear(GL_COLOR_BUFFER_BIT);
 
-    rgbFrame->format = AV_PIX_FMT_RGB24;
-    rgbFrame->width = videoCodecContext->width;
-    rgbFrame->height = videoCodecContext->height;
+    // Analyze all sources once, then render the frame with multiple audio sources
+    size_t sampleIndex = sampleIndexForTime(timeSeconds);
+    const AnalysisFrame &analysis = currentAnalyzer().analyze(audioSources, sampleIndex);
+    currentVisualizer->renderFrame(analysis, timeSeconds);
 
-    if (av_frame_get_buffer(videoFrame, 0) < 0 || av_frame_get_buffer(rgbFrame, 0) < 0)
+    if (postProcess)
     {
-        std::cerr << "Could not allocate frame buffers" << std::endl;
-        return false;
+        crtEffect->end(crt, timeSeconds);
     }
+}
 
-    // Allocate audio frame - we'll use the frame size reported by the encoder
-    int frameSize = audioCodecContext->frame_size;
-    if (frameSize <= 0)
-    {
-        // AAC typically uses 1024 samples per frame
-        frameSize = 1024;
-        std::cout << "Using default AAC frame size: " << frameSize << std::endl;
-    }
-    else
-    {
-        std::cout << "AAC encoder frame size: " << frameSize << std::endl;
-    }
+// OpenGL rendering function for live mode
+void renderLiveVisualization()
+{
+    CRTSettings crt;
+    bool postProcess = beginPostProcess(crt);
 
-    audioFrame = av_frame_alloc();
-    if (!audioFrame)
-    {
-        std::cerr << "Could not allocate audio frame" << std::endl;
-        return false;
-    }
+    // Apply the same consistent viewport and matrix settings
+    glClear(GL_COLOR_BUFFER_BIT);
+    resetMatrices();
 
-    audioFrame->format = audioCodecContext->sample_fmt;
-#if LIBAVUTIL_VERSION_MAJOR >= 57
-    audioFrame->ch_layout = audioCodecContext->ch_layout;
-#else
-    audioFrame->channel_layout = audioCodecContext->channel_layout;
-    audioFrame->channels = audioCodecContext->channels;
-#endif
-    audioFrame->sample_rate = audioCodecContext->sample_rate;
-    audioFrame->nb_samples = frameSize;
+    // Analyze the samples that were just played, then render the live frame
+    // with multiple audio sources
+    SpectrumAnalyzer &analyzer = currentAnalyzer();
+    size_t windowStart = 0;
+    const std::vector<AudioView> &window = livePlayback->analysisWindow(analyzer.getFFTSize(), windowStart);
+    const AnalysisFrame &analysis = analyzer.analyze(window, windowStart);
+    size_t position = livePlayback->position();
+    currentVisualizer->renderLiveFrame(analysis, position);
 
-    if (av_frame_get_buffer(audioFrame, 0) < 0)
+    if (postProcess)
     {
-        std::cerr << "Could not allocate audio frame buffer" << std::endl;
-        return false;
+        crtEffect->end(crt, position / static_cast<float>(SAMPLE_RATE));
     }
+}
 
-    // Log audio encoding information
-    std::cout << "Audio codec configured: "
-              << (originalChannels > 1 ? "Stereo" : "Mono")
-              << " output at " << SAMPLE_RATE << " Hz" << std::endl;
-
-    // Initialize conversion context
-    swsContext = sws_getContext(
-        WIDTH, HEIGHT, AV_PIX_FMT_RGB24,
-        WIDTH, HEIGHT, videoCodecContext->pix_fmt,
-        SWS_BILINEAR, nullptr, nullptr, nullptr);
-
-    if (!swsContext)
+// Initialize video encoder
+bool initializeVideoEncoder()
+{
+    // Frames are drawn offscreen, so the window's size does not matter
+    renderTarget.reset(new RenderTarget());
+    if (!renderTarget->create(outputWidth, outputHeight, msaaSamples))
     {
-        std::cerr << "Could not initialize conversion context" << std::endl;
+        renderTarget.reset();
         return false;
     }
 
-    // Allocate packet
-    packet = av_packet_alloc();
-    if (!packet)
+    videoRecorder.reset(new VideoRecorder(mixEngine, SAMPLE_RATE, mixChannels));
+    if (!videoRecorder->open(outputVideoFile, outputWidth, outputHeight, FPS))
     {
-        std::cerr << "Could not allocate packet" << std::endl;
+        videoRecorder.reset();
+        renderTarget.reset();
         return false;
     }
 
-    std::cout << "Video encoder initialized successfully" << std::endl;
+    // Frames are read back asynchronously and handed on a few frames later
+    frameReadback.reset(new FrameReadback());
     return true;
 }
 
 // Finalize video encoding and close file
 void finalizeVideoEncoder()
 {
-    if (!recordVideo || !formatContext)
+    if (!videoRecorder)
         return;
 
-    // Flush video encoder
-    avcodec_send_frame(videoCodecContext, nullptr);
-    while (true)
-    {
-        int ret = avcodec_receive_packet(videoCodecContext, packet);
-        if (ret == AVERROR(EAGAIN) || ret == AVERROR_EOF)
-            break;
-
-        av_packet_rescale_ts(packet, videoCodecContext->time_base, videoStream->time_base);
-        packet->stream_index = videoStream->index;
-        av_interleaved_write_frame(formatContext, packet);
-        av_packet_unref(packet);
-    }
-
-    // Flush audio encoder
-    avcodec_send_frame(audioCodecContext, nullptr);
-    while (true)
-    {
-        int ret = avcodec_receive_packet(audioCodecContext, packet);
-        if (ret == AVERROR(EAGAIN) || ret == AVERROR_EOF)
-            break;
-
-        av_packet_rescale_ts(packet, audioCodecContext->time_base, audioStream->time_base);
-        packet->stream_index = audioStream->index;
-        av_interleaved_write_frame(formatContext, packet);
-        av_packet_unref(packet);
-    }
-
-    // Write file trailer
-    av_write_trailer(formatContext);
-
-    // Close file
-    if (!(formatContext->oformat->flags & AVFMT_NOFILE))
-    {
-        avio_closep(&formatContext->pb);
-    }
-
-    // Free resources
-    av_frame_free(&videoFrame);
-    av_frame_free(&rgbFrame);
-    av_frame_free(&audioFrame);
-    av_packet_free(&packet);
-    avcodec_free_context(&videoCodecContext);
-    avcodec_free_context(&audioCodecContext);
-    avformat_free_context(formatContext);
-    sws_freeContext(swsContext);
+    // Hand over the frames still in the readback ring, then wait for the
+    // encoders to finish
+    submitReadyFrames(true);
+    frameReadback.reset();
+    renderTarget.reset();
+    videoRecorder->finish();
+    videoRecorder.reset();
 
     std::cout << "Video saved to: " << outputVideoFile << std::endl;
 }
 
-// Encode a video frame at the specified index
+// Capture a video frame at the specified index
 void encodeVideoFrame(int frameIndex)
 {
-    if (!recordVideo || !formatContext)
-        return;
-
-    // Ensure viewport and projection are set correctly before capturing frame
-    glViewport(0, 0, WIDTH, HEIGHT);
-    glMatrixMode(GL_PROJECTION);
-    glLoadIdentity();
-    glOrtho(-1, 1, -1, 1, -1, 1);
-    glMatrixMode(GL_MODELVIEW);
-    glLoadIdentity();
-
-    // Read pixels from OpenGL framebuffer
-    glReadPixels(0, 0, WIDTH, HEIGHT, GL_RGB, GL_UNSIGNED_BYTE, frameBuffer.data());
-
-    // Fill RGB frame with pixel data (flipping vertically to correct orientation)
-    for (int y = 0; y < HEIGHT; y++)
-    {
-        for (int x = 0; x < WIDTH; x++)
-        {
-            int srcPos = ((HEIGHT - 1 - y) * WIDTH + x) * 3;
-            int dstPos = (y * rgbFrame->linesize[0]) + (x * 3);
-
-            rgbFrame->data[0][dstPos] = frameBuffer[srcPos];         // R
-            rgbFrame->data[0][dstPos + 1] = frameBuffer[srcPos + 1]; // G
-            rgbFrame->data[0][dstPos + 2] = frameBuffer[srcPos + 2]; // B
-        }
-    }
-
-    // Convert RGB to YUV
-    sws_scale(swsContext, rgbFrame->data, rgbFrame->linesize, 0, HEIGHT,
-              videoFrame->data, videoFrame->linesize);
-
-    // Set frame timestamp using frame index
-    videoFrame->pts = frameIndex;
-
-    // Encode frame
-    if (avcodec_send_frame(videoCodecContext, videoFrame) < 0)
-    {
-        std::cerr << "Error sending frame to encoder" << std::endl;
+    if (!recordVideo || !videoRecorder)
         return;
-    }
 
-    while (true)
-    {
-        int ret = avcodec_receive_packet(videoCodecContext, packet);
-        if (ret == AVERROR(EAGAIN) || ret == AVERROR_EOF)
-            break;
-        if (ret < 0)
-        {
-            std::cerr << "Error receiving packet from encoder" << std::endl;
-            break;
-        }
-
-        av_packet_rescale_ts(packet, videoCodecContext->time_base, videoStream->time_base);
-        packet->stream_index = videoStream->index;
-
-        if (av_interleaved_write_frame(formatContext, packet) < 0)
-        {
-            std::cerr << "Error writing frame to file" << std::endl;
-        }
-
-        av_packet_unref(packet);
-    }
+    // Queue this frame's readback, then pass on the frames that have
+    // arrived since
+    renderTarget->resolve();
+    frameReadback->read(outputWidth, outputHeight, frameIndex);
+    submitReadyFrames(false);
 }
 
-// Encode audio data corresponding to the specified frame
-void encodeAudioForFrame(int frameIndex)
+// Copy the frames whose readback is due into the recorder's pool; with
+// flush, every queued frame. Conversion and encoding happen on the
+// recorder's threads.
+void submitReadyFrames(bool flush)
 {
-    if (!recordVideo || !formatContext)
-        return;
-
-    // Get audio frame size from the context
-    const int frameSize = audioFrame->nb_samples;
-    if (frameSize <= 0)
+    while (frameReadback->pending() == FrameReadback::RING_SIZE || (flush && frameReadback->pending() > 0))
     {
-        std::cerr << "Invalid audio frame size" << std::endl;
-        return;
-    }
-
-    // Calculate sample rate per frame for perfect alignment
-    const double samplesPerFrame = static_cast<double>(SAMPLE_RATE) / FPS;
-
-    // Calculate start and end sample for this frame
-    int64_t startSample = static_cast<int64_t>(frameIndex * samplesPerFrame);
-    int64_t endSample = static_cast<int64_t>((frameIndex + 1) * samplesPerFrame);
-
-    // Process audio in chunks of frameSize
-    for (int64_t pos = startSample; pos < endSample; pos += frameSize)
-    {
-        // Prepare the audio frame
-        av_frame_make_writable(audioFrame);
-
-        // For stereo output, we need to handle channels differently
-        const bool isStereo = originalChannels > 1;
-
-        if (isStereo)
-        {
-            // For planar float format (FLTP), we need separate planes for each channel
-            float *audioFrameDataLeft = (float *)audioFrame->data[0];  // Left channel
-            float *audioFrameDataRight = (float *)audioFrame->data[1]; // Right channel
-
-            // Clear the audio frame buffers
-            for (int i = 0; i < frameSize; i++)
-            {
-                audioFrameDataLeft[i] = 0.0f;
-                audioFrameDataRight[i] = 0.0f;
-            }
-
-            // Mix all audio sources together
-            for (const auto &source : multiAudioData)
-            {
-                for (int i = 0; i < frameSize; i++)
-                {
-                    int64_t samplePos = pos + i;
-                    if (samplePos < static_cast<int64_t>(source.size()))
-                    {
-                        // Mix with equal weighting (1/number of sources)
-                        float sample = source[samplePos] / static_cast<float>(multiAudioData.size());
-                        audioFrameDataLeft[i] += sample;
-                        audioFrameDataRight[i] += sample;
-                    }
-                }
-            }
-        }
-        else
-        {
-            // Mono output
-            float *audioFrameData = (float *)audioFrame->data[0];
-
-            // Clear the audio frame buffer
-            for (int i = 0; i < frameSize; i++)
-            {
-                audioFrameData[i] = 0.0f;
-            }
+        int frameIndex = 0;
+        const uint8_t *pixels = frameReadback->acquire(flush, frameIndex);
+        if (!pixels)
+            continue; // Dropped and reported by the readback
 
-            // Mix all audio sources together
-            for (const auto &source : multiAudioData)
-            {
-                for (int i = 0; i < frameSize; i++)
-                {
-                    int64_t samplePos = pos + i;
-                    if (samplePos < static_cast<int64_t>(source.size()))
-                    {
-                        // Mix with equal weighting (1/number of sources)
-                        audioFrameData[i] += source[samplePos] / static_cast<float>(multiAudioData.size());
-                    }
-                }
-            }
-        }
-
-        // Set timestamp for this audio frame
-        audioFrame->pts = pos;
+        VideoRecorder::Frame *frame = videoRecorder->acquireFrame();
+        std::memcpy(frame->pixels.data(), pixels, frame->pixels.size());
+        frameReadback->release();
 
-        // Encode this audio frame
-        int ret = avcodec_send_frame(audioCodecContext, audioFrame);
-        if (ret < 0)
-        {
-            char errBuf[AV_ERROR_MAX_STRING_SIZE];
-            av_strerror(ret, errBuf, AV_ERROR_MAX_STRING_SIZE);
-            std::cerr << "Error sending audio frame to encoder: " << errBuf << std::endl;
-            continue;
-        }
-
-        while (true)
-        {
-            ret = avcodec_receive_packet(audioCodecContext, packet);
-            if (ret == AVERROR(EAGAIN) || ret == AVERROR_EOF)
-                break;
-            if (ret < 0)
-            {
-                std::cerr << "Error receiving audio packet from encoder" << std::endl;
-                break;
-            }
-
-            av_packet_rescale_ts(packet, audioCodecContext->time_base, audioStream->time_base);
-            packet->stream_index = audioStream->index;
-
-            ret = av_interleaved_write_frame(formatContext, packet);
-            if (ret < 0)
-            {
-                char errBuf[AV_ERROR_MAX_STRING_SIZE];
-                av_strerror(ret, errBuf, AV_ERROR_MAX_STRING_SIZE);
-                std::cerr << "Error writing audio frame to file: " << errBuf << std::endl;
-            }
-
-            av_packet_unref(packet);
-        }
+        frame->index = frameIndex;
+        videoRecorder->submitFrame(frame);
     }
 }
 
-// Load WAV file using libsndfile
+// Open a WAV file as a memory-mapped or streaming audio source
 bool loadWavFile(const std::string &filename)
 {
-    SF_INFO sfInfo;
-    memset(&sfInfo, 0, sizeof(sfInfo));
-
-    SNDFILE *sndFile = sf_open(filename.c_str(), SFM_READ, &sfInfo);
-    if (!sndFile)
+    std::shared_ptr<AudioSource> source = openAudioSource(filename);
+    if (!source)
     {
-        std::cerr << "Error opening WAV file: " << sf_strerror(sndFile) << std::endl;
         return false;
     }
 
     // Print audio file information
     std::cout << "Audio file: " << filename << std::endl;
-    std::cout << "Sample rate: " << sfInfo.samplerate << " Hz" << std::endl;
-    std::cout << "Channels: " << sfInfo.channels << std::endl;
-    std::cout << "Frames: " << sfInfo.frames << std::endl;
+    std::cout << "Sample rate: " << source->sampleRate() << " Hz" << std::endl;
+    std::cout << "Channels: " << source->channels() << std::endl;
+    std::cout << "Frames: " << source->length() << std::endl;
 
     // Check sample rate compatibility
-    if (sfInfo.samplerate != SAMPLE_RATE)
+    if (source->sampleRate() != SAMPLE_RATE)
     {
         std::cerr << "Warning: Sample rate mismatch. Expected " << SAMPLE_RATE
-                  << " Hz, got " << sfInfo.samplerate << " Hz" << std::endl;
-        sf_close(sndFile);
+                  << " Hz, got " << source->sampleRate() << " Hz" << std::endl;
         return false;
     }
 
     // Store the original channel count
-    originalChannels = sfInfo.channels;
-
-    // Create a new vector for this audio file's data
-    std::vector<float> newAudioData;
-
-    // Store original audio data
-    if (sfInfo.channels > 1)
+    originalChannels = source->channels();
+    if (source->channels() > 1)
     {
-        // For stereo/multi-channel, store the original data as interleaved
-        std::vector<float> originalData(sfInfo.frames * sfInfo.channels);
-        sf_count_t count = sf_read_float(sndFile, originalData.data(), originalData.size());
-        if (count != sfInfo.frames * sfInfo.channels)
-        {
-            std::cerr << "Error reading WAV file: " << sf_strerror(sndFile) << std::endl;
-            sf_close(sndFile);
-            return false;
-        }
-
-        // Convert multi-channel to mono by averaging all channels
-        std::cout << "Converting " << sfInfo.channels << " channels to mono for visualization" << std::endl;
-        newAudioData.resize(sfInfo.frames);
-        for (sf_count_t i = 0; i < sfInfo.frames; i++)
-        {
-            float sum = 0.0f;
-            for (int ch = 0; ch < sfInfo.channels; ch++)
-            {
-                sum += originalData[i * sfInfo.channels + ch];
-            }
-            newAudioData[i] = sum / sfInfo.channels;
-        }
-    }
-    else
-    {
-        // Mono file - read directly
-        newAudioData.resize(sfInfo.frames);
-        sf_count_t count = sf_read_float(sndFile, newAudioData.data(), newAudioData.size());
-        if (count != sfInfo.frames)
-        {
-            std::cerr << "Error reading WAV file: " << sf_strerror(sndFile) << std::endl;
-            sf_close(sndFile);
-            return false;
-        }
+        std::cout << "Converting " << source->channels() << " channels to mono for visualization" << std::endl;
     }
 
-    sf_close(sndFile);
-
-    // Store the filename and audio data
+    // Store the filename and audio source; shorter sources read as silence
+    // past their end, so nothing needs to be padded
     audioFilenames.push_back(filename);
-    multiAudioData.push_back(newAudioData);
-
-    // Find the longest audio file length
-    size_t maxLength = 0;
-    for (const auto &source : multiAudioData)
-    {
-        maxLength = std::max(maxLength, source.size());
-    }
-
-    // Pad shorter audio files with silence to match the longest one
-    if (maxLength > 0)
-    {
-        for (auto &source : multiAudioData)
-        {
-            if (source.size() < maxLength)
-            {
-                std::cout << "Padding audio file with silence to match longest file length" << std::endl;
-                source.resize(maxLength, 0.0f);
-            }
-        }
-    }
-
-    // For backward compatibility, keep the first audio file in the original audioData vector
-    if (multiAudioData.size() == 1)
-    {
-        audioData = multiAudioData[0];
-        originalAudioData = multiAudioData[0];
-    }
+    audioSources.push_back(source);
+    audioLength = std::max(audioLength, source->length());
 
     return true;
 }
@@ -747,70 +322,78 @@ void keyCallback(GLFWwindow *window, int key, int scancode, int action, int mods
     // Toggle visualization type
     else if (key == GLFW_KEY_V && action == GLFW_PRESS)
     {
-        // Cycle through visualization types
-        switch (currentVisualizerType)
+        // Cycle through visualization types, passing over those a core
+        // profile context cannot draw
+        do
         {
-        case BAR_EQUALIZER:
-            currentVisualizerType = MINI_BAR_EQUALIZER;
-            break;
-        case MINI_BAR_EQUALIZER:
-            currentVisualizerType = WAVEFORM;
-            break;
-        case WAVEFORM:
-            currentVisualizerType = MULTI_BAND_WAVEFORM;
-            break;
-        case MULTI_BAND_WAVEFORM:
-            currentVisualizerType = ASCII_BAR_EQUALIZER;
-            break;
-        case ASCII_BAR_EQUALIZER:
-            currentVisualizerType = SPECTROGRAM;
-            break;
-        case SPECTROGRAM:
-            currentVisualizerType = MINI_SPECTROGRAM;
-            break;
-        case MINI_SPECTROGRAM:
-            currentVisualizerType = MULTI_BAND_CIRCLE_WAVEFORM;
-            break;
-        case MULTI_BAND_CIRCLE_WAVEFORM:
-            currentVisualizerType = MINI_CIRCLE;
-            break;
-        case MINI_CIRCLE:
-            currentVisualizerType = TERRAIN_VISUALIZER_3D;
-            break;
-        case TERRAIN_VISUALIZER_3D:
-            currentVisualizerType = GRID_VISUALIZER;
-            break;
-        case GRID_VISUALIZER:
-            currentVisualizerType = SCROLLER;
-            break;
-        case SCROLLER:
-            currentVisualizerType = CUBE;
-            break;
-        case CUBE:
-            currentVisualizerType = MINI_CUBE;
-            break;
-        case MINI_CUBE:
-            currentVisualizerType = RACER;
-            break;
-        case RACER:
-            currentVisualizerType = MINI_RACER;
-            break;
-        case MINI_RACER:
-            currentVisualizerType = MAZE;
-            break;
-        case MAZE:
-            currentVisualizerType = HACKER;
-            break;
-        case HACKER:
-            currentVisualizerType = BALLS;
-            break;
-        case BALLS:
-            currentVisualizerType = BAR_EQUALIZER;
-            break;
-        }
+            switch (currentVisualizerType)
+            {
+            case BAR_EQUALIZER:
+                currentVisualizerType = MINI_BAR_EQUALIZER;
+                break;
+            case MINI_BAR_EQUALIZER:
+                currentVisualizerType = WAVEFORM;
+                break;
+            case WAVEFORM:
+                currentVisualizerType = MULTI_BAND_WAVEFORM;
+                break;
+            case MULTI_BAND_WAVEFORM:
+                currentVisualizerType = ASCII_BAR_EQUALIZER;
+                break;
+            case ASCII_BAR_EQUALIZER:
+                currentVisualizerType = SPECTROGRAM;
+                break;
+            case SPECTROGRAM:
+                currentVisualizerType = MINI_SPECTROGRAM;
+                break;
+            case MINI_SPECTROGRAM:
+                currentVisualizerType = MULTI_BAND_CIRCLE_WAVEFORM;
+                break;
+            case MULTI_BAND_CIRCLE_WAVEFORM:
+                currentVisualizerType = MINI_CIRCLE;
+                break;
+            case MINI_CIRCLE:
+                currentVisualizerType = TERRAIN_VISUALIZER_3D;
+                break;
+            case TERRAIN_VISUALIZER_3D:
+                currentVisualizerType = GRID_VISUALIZER;
+                break;
+            case GRID_VISUALIZER:
+                currentVisualizerType = SCROLLER;
+                break;
+            case SCROLLER:
+                currentVisualizerType = CUBE;
+                break;
+            case CUBE:
+                currentVisualizerType = MINI_CUBE;
+                break;
+            case MINI_CUBE:
+                currentVisualizerType = RACER;
+                break;
+            case RACER:
+                currentVisualizerType = MINI_RACER;
+                break;
+            case MINI_RACER:
+                currentVisualizerType = MAZE;
+                break;
+            case MAZE:
+                currentVisualizerType = HACKER;
+                break;
+            case HACKER:
+                currentVisualizerType = BALLS;
+                break;
+            case BALLS:
+                currentVisualizerType = SWARM;
+                break;
+            case SWARM:
+                currentVisualizerType = BAR_EQUALIZER;
+                break;
+            }
 
-        // Create the new visualizer
-        currentVisualizer = VisualizerFactory::createVisualizer(currentVisualizerType);
+
+            // Create the new visualizer
+            currentVisualizer = VisualizerFactory::createVisualizer(currentVisualizerType);
+        } while (GLProfile::core() && !currentVisualizer->supportsCoreProfile());
 
         std::cout << "Switched to " << VisualizerFactory::getVisualizerName(currentVisualizerType) << " visualization" << std::endl;
     }
@@ -822,26 +405,16 @@ void framebufferSizeCallback(GLFWwindow *window, int width, int height)
     // Mark unused parameter to silence compiler warning
     (void)window;
 
-    // If we're in recording mode, we should maintain the WIDTH x HEIGHT viewport
-    // regardless of the actual window size to ensure consistent rendering
+    // A recording keeps its output size; the preview scales to the window
+    // whenever it is refreshed
     if (recordVideo)
-    {
-        glViewport(0, 0, WIDTH, HEIGHT);
-    }
-    else
-    {
-        // For live playback, adapt to the actual window size
-        glViewport(0, 0, width, height);
-    }
+        return;
 
-    // Reset the projection matrix
-    glMatrixMode(GL_PROJECTION);
-    glLoadIdentity();
-    glOrtho(-1, 1, -1, 1, -1, 1);
+    // For live playback, adapt to the actual window size
+    glViewport(0, 0, width, height);
 
-    // Switch back to modelview matrix
-    glMatrixMode(GL_MODELVIEW);
-    glLoadIdentity();
+    // Reset the projection and modelview matrices
+    resetMatrices();
 
     // Update the visualizer's dimensions
     if (currentVisualizer)
@@ -857,6 +430,13 @@ int main(int argc, char **argv)
 
     // Parse command line arguments
     std::vector<std::string> wavFiles;
+    struct TrackSetting
+    {
+        size_t track = 0;
+        float value = 0.0f;
+    };
+    std::vector<TrackSetting> trackGains;
+    std::vector<TrackSetting> trackPans;
 
     for (int i = 1; i < argc; i++)
     {
@@ -871,6 +451,48 @@ int main(int argc, char **argv)
             outputVideoFile = argv[i + 1];
             i++; // Skip the next argument
         }
+        else if (strcmp(argv[i], "--size") == 0 && i + 1 < argc)
+        {
+            if (sscanf(argv[i + 1], "%dx%d", &outputWidth, &outputHeight) != 2 || outputWidth <= 0 || outputHeight <= 0)
+            {
+                std::cerr << "Invalid --size value: " << argv[i + 1] << " (expected <width>x<height>)" << std::endl;
+                return -1;
+            }
+            i++; // Skip the next argument
+        }
+        else if (strcmp(argv[i], "--msaa") == 0 && i + 1 < argc)
+        {
+            if (sscanf(argv[i + 1], "%d", &msaaSamples) != 1 || msaaSamples < 0)
+            {
+                std::cerr << "Invalid --msaa value: " << argv[i + 1] << " (expected a sample count)" << std::endl;
+                return -1;
+            }
+            i++; // Skip the next argument
+        }
+        else if (strcmp(argv[i], "--no-preview") == 0)
+        {
+            showPreview = false;
+        }
+        else if (strcmp(argv[i], "--fft-patient") == 0)
+        {
+            FFTPlanner::setPatient(true);
+        }
+        else if (strcmp(argv[i], "--core-profile") == 0)
+        {
+            GLProfile::setCore(true);
+        }
+        else if ((strcmp(argv[i], "--gain") == 0 || strcmp(argv[i], "--pan") == 0) && i + 1 < argc)
+        {
+            // <track>:<value>, tracks numbered from 1 in command line order
+            TrackSetting setting;
+            if (sscanf(argv[i + 1], "%zu:%f", &setting.track, &setting.value) != 2 || setting.track == 0)
+            {
+                std::cerr << "Invalid " << argv[i] << " value: " << argv[i + 1] << " (expected <track>:<value>)" << std::endl;
+                return -1;
+            }
+            (strcmp(argv[i], "--gain") == 0 ? trackGains : trackPans).push_back(setting);
+            i++; // Skip the next argument
+        }
         else
         {
             // Collect all WAV files
@@ -884,8 +506,16 @@ int main(int argc, char **argv)
                   << "Options:\n"
                   << "  --type <type>       Visualization type (default: bars)\n"
                   << "                      Available types: ascii, balls, bars, circle, cube, grid, hacker, maze, mini_cube, multiband,\n"
-                  << "                                      racer, scroller, spectrogram, terrain, waveform\n"
+                  << "                                      racer, scroller, spectrogram, swarm, terrain, waveform\n"
                   << "  --record <file>     Record visualization to video file\n"
+                  << "  --size <w>x<h>      Recording size, e.g. 1920x1080 (default: 800x600, 128x43 for mini types)\n"
+                  << "  --msaa <samples>    Multisample the recording, e.g. 4 (default: off)\n"
+                  << "  --no-preview        Record without showing a window\n"
+                  << "  --gain <n>:<gain>   Linear gain for the n-th file (default: 1)\n"
+                  << "  --pan <n>:<pan>     Pan the n-th file from -1 (left) to 1 (right); enables stereo output\n"
+                  << "  --fft-patient       Search longer for the fastest FFT plan (cached after the first run)\n"
+                  << "  --core-profile      Draw on an OpenGL 3.3 core profile context (balls, cube, grid, maze,\n"
+                  << "                      racer, spectrogram, swarm and terrain only)\n"
                   << "\n"
                   << "For waveform visualization, you can provide up to 8 WAV files.\n"
                   << "The files will be arranged in a grid layout:\n"
@@ -981,12 +611,27 @@ int main(int argc, char **argv)
     {
         currentVisualizerType = BALLS;
     }
+    else if (visualizerTypeName == "swarm" || visualizerTypeName == "ball_swarm")
+    {
+        currentVisualizerType = SWARM;
+    }
     else
     {
         currentVisualizerType = BAR_EQUALIZER;
     }
 
+    if (GLProfile::core() && !currentVisualizer->supportsCoreProfile())
+    {
+        std::cerr << VisualizerFactory::getVisualizerName(currentVisualizerType)
+                  << " visualization still uses the fixed-function pipeline; run it without --core-profile" << std::endl;
+        return -1;
+    }
+
     std::cout << "Using " << VisualizerFactory::getVisualizerName(currentVisualizerType) << " visualization" << std::endl;
+    std::cout << "Spectrum kernels: " << SpectrumKernels::get().name << std::endl;
+
+    // Tuned FFT plans from earlier runs make planning free
+    FFTPlanner::loadWisdom();
 
     // Load all WAV files (up to 9)
     size_t maxFiles = std::min(wavFiles.size(), size_t(9));
@@ -998,46 +643,21 @@ int main(int argc, char **argv)
         }
     }
 
-    // If using waveform visualizer, set the multiple audio sources
-    if (currentVisualizerType == WAVEFORM)
+    // Set up the mix; panning needs a stereo output to be audible
+    mixEngine.setSources(audioSources);
+    for (const TrackSetting &setting : trackGains)
     {
-        Waveform *waveformVis = dynamic_cast<Waveform *>(currentVisualizer.get());
-        if (waveformVis)
-        {
-            waveformVis->setAudioSources(multiAudioData);
-        }
-    }
-    // If using multi-band waveform visualizer, set the multiple audio sources
-    else if (currentVisualizerType == MULTI_BAND_WAVEFORM)
-    {
-        MultiBandWaveform *multiBandVis = dynamic_cast<MultiBandWaveform *>(currentVisualizer.get());
-        if (multiBandVis)
-        {
-            multiBandVis->setAudioSources(multiAudioData);
-        }
+        mixEngine.setGain(setting.track - 1, setting.value);
     }
-    // If using multi-band circle visualizer, set the multiple audio sources
-    else if (currentVisualizerType == MULTI_BAND_CIRCLE_WAVEFORM)
+    for (const TrackSetting &setting : trackPans)
     {
-        MultiBandCircleWaveform *circleVis = dynamic_cast<MultiBandCircleWaveform *>(currentVisualizer.get());
-        if (circleVis)
-        {
-            circleVis->setAudioSources(multiAudioData);
-        }
-    }
-    // If using grid visualizer, set the multiple audio sources
-    else if (currentVisualizerType == GRID_VISUALIZER)
-    {
-        GridVisualizer *gridVis = dynamic_cast<GridVisualizer *>(currentVisualizer.get());
-        if (gridVis)
-        {
-            gridVis->setAudioSources(multiAudioData);
-        }
+        mixEngine.setPan(setting.track - 1, setting.value);
     }
+    mixChannels = (originalChannels > 1 || !trackPans.empty()) ? 2 : OUTPUT_CHANNELS;
 
     // Calculate total number of frames based on audio length
-    int totalFrames = static_cast<int>(std::ceil(audioData.size() / (static_cast<double>(SAMPLE_RATE) / FPS)));
-    std::cout << "Audio length: " << audioData.size() / static_cast<double>(SAMPLE_RATE) << " seconds" << std::endl;
+    int totalFrames = static_cast<int>(std::ceil(audioLength / (static_cast<double>(SAMPLE_RATE) / FPS)));
+    std::cout << "Audio length: " << audioLength / static_cast<double>(SAMPLE_RATE) << " seconds" << std::endl;
     std::cout << "Total frames to render: " << totalFrames << std::endl;
 
     // Initialize GLFW
@@ -1047,28 +667,58 @@ int main(int argc, char **argv)
         return -1;
     }
 
-    // Set window hints for a better default configuration
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 2);
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 1);
-
-    // Make window non-resizable when in recording mode to ensure consistent rendering
-    if (recordVideo)
+    // Set window hints for a better default configuration. The core
+    // profile must be forward-compatible on macOS, which is otherwise
+    // limited to 2.1.
+    if (GLProfile::core())
     {
-        glfwWindowHint(GLFW_RESIZABLE, GLFW_FALSE);
-        std::cout << "Fixed window size for recording mode" << std::endl;
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+        glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+#ifdef __APPLE__
+        glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GLFW_TRUE);
+#endif
     }
     else
     {
-        glfwWindowHint(GLFW_RESIZABLE, GLFW_TRUE);
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 2);
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 1);
     }
 
+    // Live mode follows the window size, and a recording's preview scales
+    // to it, so the window can always be resized
+    glfwWindowHint(GLFW_RESIZABLE, GLFW_TRUE);
+
     // Use 128x43 for mini visualizers, otherwise use default WIDTH x HEIGHT
-    int windowWidth = (currentVisualizerType == MINI_RACER || currentVisualizerType == MINI_BAR_EQUALIZER || currentVisualizerType == MINI_SPECTROGRAM || currentVisualizerType == MINI_CIRCLE || currentVisualizerType == MINI_CUBE) ? 128 : WIDTH;
-    int windowHeight = (currentVisualizerType == MINI_RACER || currentVisualizerType == MINI_BAR_EQUALIZER || currentVisualizerType == MINI_SPECTROGRAM || currentVisualizerType == MINI_CIRCLE || currentVisualizerType == MINI_CUBE) ? 43 : HEIGHT;
+    bool miniVisualizer = currentVisualizerType == MINI_RACER || currentVisualizerType == MINI_BAR_EQUALIZER || currentVisualizerType == MINI_SPECTROGRAM || currentVisualizerType == MINI_CIRCLE || currentVisualizerType == MINI_CUBE;
+    int windowWidth = miniVisualizer ? 128 : WIDTH;
+    int windowHeight = miniVisualizer ? 43 : HEIGHT;
+
+    // A recording renders offscreen at its own size; the window is only a
+    // preview, scaled down to fit the default size, or hidden
+    if (recordVideo)
+    {
+        if (outputWidth == 0)
+        {
+            outputWidth = windowWidth;
+            outputHeight = windowHeight;
+        }
+        float previewScale = std::min(1.0f, std::min(static_cast<float>(WIDTH) / outputWidth, static_cast<float>(HEIGHT) / outputHeight));
+        windowWidth = std::max(1, static_cast<int>(outputWidth * previewScale));
+        windowHeight = std::max(1, static_cast<int>(outputHeight * previewScale));
+        glfwWindowHint(GLFW_VISIBLE, showPreview ? GLFW_TRUE : GLFW_FALSE);
+        std::cout << "Recording at " << outputWidth << "x" << outputHeight;
+        if (msaaSamples > 1)
+        {
+            std::cout << " with " << msaaSamples << "x multisampling";
+        }
+        std::cout << std::endl;
+    }
     GLFWwindow *window = glfwCreateWindow(windowWidth, windowHeight, recordVideo ? "Music Visualizer (Recording)" : "Music Visualizer", NULL, NULL);
     if (!window)
     {
         std::cerr << "Failed to create window\n";
+        currentVisualizer.reset();
         glfwTerminate();
         return -1;
     }
@@ -1077,26 +727,18 @@ int main(int argc, char **argv)
     glfwSetKeyCallback(window, keyCallback);
     glfwSetFramebufferSizeCallback(window, framebufferSizeCallback); // Set resize callback
 
-    // Initialize GLEW
+    // Initialize GLEW. On a core profile it must look up entry points
+    // without the extension string, and that lookup leaves an error behind.
+    glewExperimental = GL_TRUE;
     if (glewInit() != GLEW_OK)
     {
         std::cerr << "Failed to initialize GLEW\n";
+        currentVisualizer.reset();
         glfwDestroyWindow(window);
         glfwTerminate();
         return -1;
     }
-
-    // Set up FFTW
-    plan = fftw_plan_dft_r2c_1d(N, in, out, FFTW_ESTIMATE);
-
-    // Initialize FFT input buffer with zeros
-    for (int i = 0; i < N; i++)
-    {
-        in[i] = 0.0;
-    }
-
-    // Execute FFT once to ensure it's properly initialized
-    fftw_execute(plan);
+    glGetError();
 
     // Set OpenGL viewport explicitly
     int fbWidth, fbHeight;
@@ -1115,31 +757,18 @@ int main(int argc, char **argv)
         std::cout << "HiDPI display detected (scale: " << scaleX << "x" << scaleY << ")" << std::endl;
     }
 
-    // For recording, always use the exact dimensions regardless of actual framebuffer
-    if (recordVideo)
-    {
-        glViewport(0, 0, WIDTH, HEIGHT);
-    }
-    else
-    {
-        glViewport(0, 0, fbWidth, fbHeight);
-    }
+    // A recording sets its own viewport when it binds its target
+    glViewport(0, 0, fbWidth, fbHeight);
 
-    // Set up projection matrix
-    glMatrixMode(GL_PROJECTION);
-    glLoadIdentity();
-    glOrtho(-1, 1, -1, 1, -1, 1);
-
-    // Switch to modelview matrix and initialize it
-    glMatrixMode(GL_MODELVIEW);
-    glLoadIdentity();
+    // Set up the projection and modelview matrices
+    resetMatrices();
 
     // Set clear color
     glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
 
     // Initialize the visualizer with correct dimensions
-    int visWidth = (currentVisualizerType == MINI_RACER || currentVisualizerType == MINI_BAR_EQUALIZER || currentVisualizerType == MINI_SPECTROGRAM || currentVisualizerType == MINI_CIRCLE || currentVisualizerType == MINI_CUBE) ? 128 : WIDTH;
-    int visHeight = (currentVisualizerType == MINI_RACER || currentVisualizerType == MINI_BAR_EQUALIZER || currentVisualizerType == MINI_SPECTROGRAM || currentVisualizerType == MINI_CIRCLE || currentVisualizerType == MINI_CUBE) ? 43 : HEIGHT;
+    int visWidth = recordVideo ? outputWidth : (miniVisualizer ? 128 : WIDTH);
+    int visHeight = recordVideo ? outputHeight : (miniVisualizer ? 43 : HEIGHT);
     currentVisualizer->initialize(visWidth, visHeight);
 
     // Initialize video encoder if recording
@@ -1147,7 +776,7 @@ int main(int argc, char **argv)
     {
         if (!initializeVideoEncoder())
         {
-            std::cerr << "Failed to initialize video encoder" << std::endl;
+            std::cerr << "Failed to initialize recording" << std::endl;
             recordVideo = false;
         }
     }
@@ -1158,39 +787,64 @@ int main(int argc, char **argv)
         std::cout << "Starting non-real-time rendering..." << std::endl;
 
         auto startTime = std::chrono::high_resolution_clock::now();
+        auto lastPreview = startTime;
 
-        // Ensure the viewport and projection are set up correctly before starting
-        glViewport(0, 0, WIDTH, HEIGHT);
-        glMatrixMode(GL_PROJECTION);
-        glLoadIdentity();
-        glOrtho(-1, 1, -1, 1, -1, 1);
-        glMatrixMode(GL_MODELVIEW);
-        glLoadIdentity();
+        // Refreshing the preview must never wait for the display
+        glfwSwapInterval(0);
+
+        // Sample positions of the frames of the batch starting at firstFrame
+        auto batchPositions = [totalFrames](int firstFrame)
+        {
+            std::vector<size_t> positions;
+            int batchEnd = std::min(firstFrame + PRECOMPUTE_BATCH_FRAMES, totalFrames);
+            for (int batchFrame = firstFrame; batchFrame < batchEnd; batchFrame++)
+            {
+                positions.push_back(sampleIndexForTime(batchFrame / static_cast<float>(FPS)));
+            }
+            return positions;
+        };
 
         for (int frameIndex = 0; frameIndex < totalFrames; frameIndex++)
         {
+            // Every frame time is known up front, so the spectra are computed
+            // on worker threads one batch ahead: as batch k starts drawing,
+            // batch k + 1 is queued and batch k, finished meanwhile, becomes
+            // the one the render loop reads. Batching keeps memory bounded
+            // for long inputs.
+            if (frameIndex % PRECOMPUTE_BATCH_FRAMES == 0)
+            {
+                if (frameIndex == 0)
+                {
+                    currentAnalyzer().precompute(audioSources, batchPositions(0));
+                }
+                currentAnalyzer().precompute(audioSources, batchPositions(frameIndex + PRECOMPUTE_BATCH_FRAMES));
+            }
+
             // Calculate time for this frame
             float timeSeconds = frameIndex / static_cast<float>(FPS);
 
-            // Apply consistent viewport and matrix settings before each render
-            glViewport(0, 0, WIDTH, HEIGHT);
-            glMatrixMode(GL_PROJECTION);
-            glLoadIdentity();
-            glOrtho(-1, 1, -1, 1, -1, 1);
-            glMatrixMode(GL_MODELVIEW);
-            glLoadIdentity();
+            // Draw into the offscreen target, with consistent matrix settings
+            renderTarget->bind();
+            resetMatrices();
 
             // Render the visualization for this time
             renderFrameAtTime(timeSeconds);
 
-            // Capture and encode the video frame
+            // Capture the video frame; the recorder encodes it and the
+            // matching audio on its own threads
             encodeVideoFrame(frameIndex);
 
-            // Encode the corresponding audio segment
-            encodeAudioForFrame(frameIndex);
-
-            // Update the window to show progress (but don't wait for vsync)
-            glfwSwapBuffers(window);
+            // Show progress in the window a few times a second; presenting
+            // every frame would cost a scaled copy per frame for nothing
+            auto now = std::chrono::high_resolution_clock::now();
+            if (showPreview && std::chrono::duration<double>(now - lastPreview).count() >= PREVIEW_INTERVAL)
+            {
+                int previewWidth, previewHeight;
+                glfwGetFramebufferSize(window, &previewWidth, &previewHeight);
+                renderTarget->present(previewWidth, previewHeight);
+                glfwSwapBuffers(window);
+                lastPreview = now;
+            }
             glfwPollEvents();
 
             // Show progress
@@ -1209,12 +863,15 @@ int main(int argc, char **argv)
             }
         }
 
+        // A canceled recording can leave a batch in flight
+        currentAnalyzer().waitForPrecompute();
+
+        // Finalize video encoding, waiting for the encoders to catch up
+        finalizeVideoEncoder();
+
         auto endTime = std::chrono::high_resolution_clock::now();
         auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(endTime - startTime);
         std::cout << "Rendering completed in " << duration.count() / 1000.0 << " seconds." << std::endl;
-
-        // Finalize video encoding
-        finalizeVideoEncoder();
     }
     else
     {
@@ -1226,56 +883,60 @@ int main(int argc, char **argv)
         if (err != paNoError)
         {
             std::cerr << "PortAudio error: " << Pa_GetErrorText(err) << std::endl;
-            fftw_destroy_plan(plan);
+            crtEffect.reset();
+            currentVisualizer.reset();
             glfwDestroyWindow(window);
             glfwTerminate();
             return -1;
         }
 
+        // The callback only drains pre-mixed audio, so disk reads and mixing
+        // happen on the feeder thread
+        livePlayback.reset(new LivePlayback(mixEngine, audioLength, MAX_FFT_SIZE, mixChannels));
+
         // Set up audio stream
         PaStream *stream;
         err = Pa_OpenDefaultStream(&stream,
                                    0,               // No input channels
-                                   OUTPUT_CHANNELS, // Always mono output for live playback
+                                   mixChannels,     // Mono unless the input is stereo or panned
                                    paFloat32,       // 32-bit floating point output
                                    SAMPLE_RATE,
                                    FRAMES_PER_BUFFER,
-                                   paCallback,
-                                   NULL);
+                                   LivePlayback::paCallback,
+                                   livePlayback.get());
 
         if (err != paNoError)
         {
             std::cerr << "PortAudio error: " << Pa_GetErrorText(err) << std::endl;
             Pa_Terminate();
-            fftw_destroy_plan(plan);
+            crtEffect.reset();
+            currentVisualizer.reset();
             glfwDestroyWindow(window);
             glfwTerminate();
             return -1;
         }
 
-        // Reset playback flag and position
-        playbackFinished = false;
-        currentPosition.store(0);
-
         // Initialize visualization by rendering the first frame before starting audio
         renderLiveVisualization();
         glfwSwapBuffers(window);
 
         // Start audio stream after visualization is initialized
+        livePlayback->start();
         err = Pa_StartStream(stream);
         if (err != paNoError)
         {
             std::cerr << "PortAudio error: " << Pa_GetErrorText(err) << std::endl;
             Pa_CloseStream(stream);
             Pa_Terminate();
-            fftw_destroy_plan(plan);
+            crtEffect.reset();
+            currentVisualizer.reset();
             glfwDestroyWindow(window);
             glfwTerminate();
             return -1;
         }
 
         // Live visualization loop
-        while (!glfwWindowShouldClose(window) && !playbackFinished)
+        while (!glfwWindowShouldClose(window) && !livePlayback->finished())
         {
             // Render the visualization based on current audio position
             renderLiveVisualization();
@@ -1295,10 +956,19 @@ int main(int argc, char **argv)
             Pa_CloseStream(stream);
         }
         Pa_Terminate();
+        livePlayback->stop();
+
+        std::cout << "Audio xruns: " << livePlayback->xrunCount()
+                  << ", late callbacks: " << livePlayback->lateCallbackCount()
+                  << ", underruns: " << livePlayback->underrunCount()
+                  << ", dropped analysis frames: " << livePlayback->analysisDropCount() << std::endl;
+        livePlayback.reset();
     }
 
-    // Clean up
-    fftw_destroy_plan(plan);
+    // Clean up; visualizers and the CRT stage free GL objects, so they go
+    // while the context still exists
+    currentVisualizer.reset();
+    crtEffect.reset();
     glfwDestroyWindow(window);
     glfwTerminate();
 
@@ -1320,23 +990,3 @@ void Visualizer::initialize(int width, int height)
     screenWidth = width;
     screenHeight = height;
 }
-
-void Visualizer::renderFrame(const std::vector<std::vector<float>> &audioSources,
-                             double *in,
-                             fftw_complex *out,
-                             fftw_plan &plan,
-                             float timeSeconds)
-{
-    // Default implementation for backward compatibility
-    renderFrame(audioSources.empty() ? std::vector<float>() : audioSources[0], in, out, plan, timeSeconds);
-}
-
-void Visualizer::renderLiveFrame(const std::vector<std::vector<float>> &audioSources,
-                                 double *in,
-                                 fftw_complex *out,
-                                 fftw_plan &plan,
-                                 size_t currentPosition)
-{
-    // Default implementation for backward compatibility
-    renderLiveFrame(audioSources.empty() ? std::vector<float>() : audioSources[0], in, out, plan, currentPosition);
-}
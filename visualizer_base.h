@@ -2,7 +2,9 @@
 
 #include <vector>
 #include <GL/glew.h>
-#include <fftw3.h>
+#include "spectrum_analyzer.h"
+#include "render_batch.h"
+#include "crt_effect.h"
 
 class Visualizer {
 public:
@@ -12,35 +14,35 @@ public:
 
     // Initialize the visualizer with common settings
     virtual void initialize(int width, int height);
-    
-    // Multi-source methods
-    virtual void renderFrame(const std::vector<std::vector<float>>& audioSources,
-                           double* in,
-                           fftw_complex* out,
-                           fftw_plan& plan,
-                           float timeSeconds);
-
-    virtual void renderLiveFrame(const std::vector<std::vector<float>>& audioSources,
-                               double* in,
-                               fftw_complex* out,
-                               fftw_plan& plan,
-                               size_t currentPosition);
-
-    // Legacy single-source methods
-    virtual void renderFrame(const std::vector<float>& audioData,
-                           double* in,
-                           fftw_complex* out,
-                           fftw_plan& plan,
+
+    // Render one frame from the shared analysis. The spectrum and sample
+    // block of every source are computed once per frame by SpectrumAnalyzer
+    // and handed to the visualizer read-only.
+    virtual void renderFrame(const AnalysisFrame& analysis,
                            float timeSeconds) = 0;
-                           
-    virtual void renderLiveFrame(const std::vector<float>& audioData,
-                               double* in,
-                               fftw_complex* out,
-                               fftw_plan& plan,
+
+    virtual void renderLiveFrame(const AnalysisFrame& analysis,
                                size_t currentPosition) = 0;
 
+    // FFT size this visualizer wants its analysis computed at, or 0 for the
+    // shared default. Only override when every bin lookup follows
+    // analysis.fftSize.
+    virtual int preferredFFTSize() const { return 0; }
+
+    // CRT post-processing for the next frame, read before it is rendered.
+    // The default leaves the frame untouched.
+    virtual CRTSettings crtSettings() const { return CRTSettings(); }
+
+    // Whether this visualizer draws only through shaders, vertex arrays and
+    // uniform buffers, and so runs on a core profile context
+    virtual bool supportsCoreProfile() const { return false; }
+
 protected:
     int screenWidth = 800;
     int screenHeight = 600;
     static const int N = 2048;  // FFT size
-}; 
\ No newline at end of file
+
+    // Geometry queued by the batched visualizers; they flush it at the end
+    // of each frame, or before changing matrices or blend state
+    RenderBatch batch;
+};
\ No newline at end of file
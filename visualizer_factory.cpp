@@ -63,6 +63,10 @@ std::shared_ptr<Visualizer> VisualizerFactory::createVisualizer(VisualizerType t
         return std::make_shared<HackerTerminal>();
     case BALLS:
         return std::make_shared<BallsVisualizer>();
+    case SWARM:
+        return std::make_shared<BallsVisualizer>(BallsVisualizer::SWARM_BALLS,
+                                                 BallsVisualizer::SWARM_MIN_RADIUS,
+                                                 BallsVisualizer::SWARM_MAX_RADIUS);
     default:
         // Default to bar equalizer
         return std::make_shared<BarEqualizer>();
@@ -152,6 +156,10 @@ std::shared_ptr<Visualizer> VisualizerFactory::createVisualizer(const std::strin
     {
         return createVisualizer(BALLS);
     }
+    else if (lowerName == "swarm" || lowerName == "ball_swarm")
+    {
+        return createVisualizer(SWARM);
+    }
     else
     {
         // Default to bar equalizer
@@ -201,6 +209,8 @@ std::string VisualizerFactory::getVisualizerName(VisualizerType type)
         return "Hacker Terminal";
     case BALLS:
         return "Bouncing Balls";
+    case SWARM:
+        return "Ball Swarm";
     default:
         return "Unknown";
     }
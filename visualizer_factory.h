@@ -35,7 +35,8 @@ enum VisualizerType
     MINI_RACER,
     MAZE,
     HACKER,
-    BALLS
+    BALLS,
+    SWARM
 };
 
 class VisualizerFactory
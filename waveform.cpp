@@ -8,10 +8,6 @@ Waveform::Waveform() {
 Waveform::~Waveform() {
 }
 
-void Waveform::setAudioSources(const std::vector<std::vector<float>>& sources) {
-    audioSources = sources;
-}
-
 void Waveform::calculateGridDimensions(int numSources, int& rows, int& cols) const {
     if (numSources <= 1) {
         rows = 1;
@@ -31,129 +27,71 @@ void Waveform::calculateGridDimensions(int numSources, int& rows, int& cols) con
     }
 }
 
-void Waveform::renderWaveform(const std::vector<float>& data, size_t position,
+void Waveform::renderWaveform(const AudioView& samples,
                             float x1, float y1, float x2, float y2) {
     // Set line width to 5 pixels for thicker waveform
-    glLineWidth(5.0f);
+    batch.lineWidth(5.0f);
     
     // Set color for visualization
-    glColor3f(0.0f, 1.0f, 0.0f); // Green visualization
+    batch.color(0.0f, 1.0f, 0.0f); // Green visualization
     
-    glBegin(GL_LINE_STRIP);
+    batch.begin(GL_LINE_STRIP);
     
-    // Display a window of samples from the current position
-    int sampleCount = std::min(N, static_cast<int>(data.size() - position));
+    // Display the analysis block, which starts at the current position
+    int sampleCount = std::min(N, static_cast<int>(samples.size()));
     float width = x2 - x1;
     float height = y2 - y1;
     float centerY = y1 + height / 2.0f;
     
     for (int i = 0; i < sampleCount; i++) {
         float x = x1 + width * i / (float)(sampleCount - 1);
-        float y = centerY + (data[position + i] * height * 0.4f); // Scale by 0.4 to prevent clipping
-        glVertex2f(x, y);
+        float y = centerY + (samples[i] * height * 0.4f); // Scale by 0.4 to prevent clipping
+        batch.vertex(x, y);
     }
     
-    glEnd();
+    batch.end();
     
     // Reset line width to default
-    glLineWidth(1.0f);
+    batch.lineWidth(1.0f);
 }
 
-void Waveform::renderFrame(const std::vector<float>& audioData, 
-                          double* fftInputBuffer, 
-                          fftw_complex* fftOutputBuffer,
-                          fftw_plan& fftPlan, 
+void Waveform::renderFrame(const AnalysisFrame& analysis,
                           float timeSeconds) {
     // Mark unused parameters to silence compiler warnings
-    (void)fftInputBuffer;
-    (void)fftOutputBuffer;
-    (void)fftPlan;
-    (void)audioData; // We'll use audioSources instead
-    
-    // Calculate grid dimensions based on number of sources
-    int rows, cols;
-    calculateGridDimensions(audioSources.size(), rows, cols);
-    
-    // Calculate cell dimensions
-    float cellWidth = 2.0f / cols;
-    float cellHeight = 2.0f / rows;
+    (void)timeSeconds;
     
-    // Calculate the sample index for the current time
-    size_t sampleIndex = static_cast<size_t>(timeSeconds * 44100); // Assuming 44.1kHz
-    
-    // Draw border around the entire window
-    glLineWidth(1.0f);
-    glColor3f(0.3f, 0.3f, 0.3f); // Gray color for borders
-    glBegin(GL_LINE_LOOP);
-    glVertex2f(-1.0f, -1.0f);
-    glVertex2f(1.0f, -1.0f);
-    glVertex2f(1.0f, 1.0f);
-    glVertex2f(-1.0f, 1.0f);
-    glEnd();
-    
-    // Render each waveform in its grid cell
-    for (size_t i = 0; i < audioSources.size() && i < 8; i++) {
-        int row = i / cols;
-        int col = i % cols;
-        
-        // Calculate cell boundaries
-        float x1 = -1.0f + col * cellWidth;
-        float y1 = 1.0f - (row + 1) * cellHeight;
-        float x2 = x1 + cellWidth;
-        float y2 = y1 + cellHeight;
-        
-        // Draw cell border
-        glLineWidth(1.0f);
-        glColor3f(0.3f, 0.3f, 0.3f);
-        glBegin(GL_LINE_LOOP);
-        glVertex2f(x1, y1);
-        glVertex2f(x2, y1);
-        glVertex2f(x2, y2);
-        glVertex2f(x1, y2);
-        glEnd();
-        
-        // Render waveform if we have data and haven't exceeded the sample count
-        if (sampleIndex < audioSources[i].size()) {
-            // Add small padding inside each cell
-            float padding = 0.01f;
-            renderWaveform(audioSources[i], sampleIndex,
-                         x1 + padding, y1 + padding,
-                         x2 - padding, y2 - padding);
-        }
-    }
+    renderSources(analysis);
 }
 
-void Waveform::renderLiveFrame(const std::vector<float>& audioData, 
-                             double* fftInputBuffer, 
-                             fftw_complex* fftOutputBuffer,
-                             fftw_plan& fftPlan, 
+void Waveform::renderLiveFrame(const AnalysisFrame& analysis,
                              size_t currentPosition) {
     // Mark unused parameters to silence compiler warnings
-    (void)fftInputBuffer;
-    (void)fftOutputBuffer;
-    (void)fftPlan;
-    (void)audioData; // We'll use audioSources instead
+    (void)currentPosition;
     
+    renderSources(analysis);
+}
+
+void Waveform::renderSources(const AnalysisFrame& analysis) {
     // Calculate grid dimensions based on number of sources
     int rows, cols;
-    calculateGridDimensions(audioSources.size(), rows, cols);
+    calculateGridDimensions(analysis.sources.size(), rows, cols);
     
     // Calculate cell dimensions
     float cellWidth = 2.0f / cols;
     float cellHeight = 2.0f / rows;
     
     // Draw border around the entire window
-    glLineWidth(1.0f);
-    glColor3f(0.3f, 0.3f, 0.3f); // Gray color for borders
-    glBegin(GL_LINE_LOOP);
-    glVertex2f(-1.0f, -1.0f);
-    glVertex2f(1.0f, -1.0f);
-    glVertex2f(1.0f, 1.0f);
-    glVertex2f(-1.0f, 1.0f);
-    glEnd();
+    batch.lineWidth(1.0f);
+    batch.color(0.3f, 0.3f, 0.3f); // Gray color for borders
+    batch.begin(GL_LINE_LOOP);
+    batch.vertex(-1.0f, -1.0f);
+    batch.vertex(1.0f, -1.0f);
+    batch.vertex(1.0f, 1.0f);
+    batch.vertex(-1.0f, 1.0f);
+    batch.end();
     
     // Render each waveform in its grid cell
-    for (size_t i = 0; i < audioSources.size() && i < 8; i++) {
+    for (size_t i = 0; i < analysis.sources.size() && i < 8; i++) {
         int row = i / cols;
         int col = i % cols;
         
@@ -164,22 +102,25 @@ void Waveform::renderLiveFrame(const std::vector<float>& audioData,
         float y2 = y1 + cellHeight;
         
         // Draw cell border
-        glLineWidth(1.0f);
-        glColor3f(0.3f, 0.3f, 0.3f);
-        glBegin(GL_LINE_LOOP);
-        glVertex2f(x1, y1);
-        glVertex2f(x2, y1);
-        glVertex2f(x2, y2);
-        glVertex2f(x1, y2);
-        glEnd();
+        batch.lineWidth(1.0f);
+        batch.color(0.3f, 0.3f, 0.3f);
+        batch.begin(GL_LINE_LOOP);
+        batch.vertex(x1, y1);
+        batch.vertex(x2, y1);
+        batch.vertex(x2, y2);
+        batch.vertex(x1, y2);
+        batch.end();
         
-        // Render waveform if we have data and haven't exceeded the sample count
-        if (currentPosition < audioSources[i].size()) {
+        // Render waveform if we haven't reached the end of this source
+        const SourceSpectrum& spectrum = analysis.sources[i];
+        if (spectrum.active) {
             // Add small padding inside each cell
             float padding = 0.01f;
-            renderWaveform(audioSources[i], currentPosition,
+            renderWaveform(spectrum.samples,
                          x1 + padding, y1 + padding,
                          x2 - padding, y2 - padding);
         }
     }
-} 
\ No newline at end of file
+
+    batch.flush();
+}
@@ -0,0 +1,80 @@
+#include "yuv_convert.h"
+#include <cstddef>
+
+// BT.601 limited range in 8.8 fixed point:
+//   Y =  0.257 R + 0.504 G + 0.098 B + 16
+//   U = -0.148 R - 0.291 G + 0.439 B + 128
+//   V =  0.439 R - 0.368 G - 0.071 B + 128
+// Chroma is taken from the sum of each 2x2 block, so its shift is two bits
+// wider. The offsets are folded in before the shift, which keeps every sum
+// positive and the results inside 16..235 and 16..240 without clamping.
+static const int Y_R = 66, Y_G = 129, Y_B = 25;
+static const int U_R = -38, U_G = -74, U_B = 112;
+static const int V_R = 112, V_G = -94, V_B = -18;
+static const int Y_OFFSET = (16 << 8) + 128;
+static const int C_OFFSET = (128 << 10) + 512;
+
+// The loops below are plain fixed-point arithmetic with no branches, so
+// the compiler vectorizes them; __restrict tells it the rows do not overlap
+
+static void lumaRow(const uint8_t *__restrict src, uint8_t *__restrict dst, int width)
+{
+    for (int x = 0; x < width; x++)
+    {
+        int r = src[x * 4];
+        int g = src[x * 4 + 1];
+        int b = src[x * 4 + 2];
+        dst[x] = static_cast<uint8_t>((Y_R * r + Y_G * g + Y_B * b + Y_OFFSET) >> 8);
+    }
+}
+
+static void chromaRow(const uint8_t *__restrict top, const uint8_t *__restrict bottom,
+                      uint8_t *__restrict u, uint8_t *__restrict v, int pairs)
+{
+    for (int x = 0; x < pairs; x++)
+    {
+        const uint8_t *a = top + x * 8;
+        const uint8_t *b = bottom + x * 8;
+        int r = a[0] + a[4] + b[0] + b[4];
+        int g = a[1] + a[5] + b[1] + b[5];
+        int bl = a[2] + a[6] + b[2] + b[6];
+        u[x] = static_cast<uint8_t>((U_R * r + U_G * g + U_B * bl + C_OFFSET) >> 10);
+        v[x] = static_cast<uint8_t>((V_R * r + V_G * g + V_B * bl + C_OFFSET) >> 10);
+    }
+}
+
+void rgbaToYuv420(const uint8_t *rgba, int width, int height, int firstRow, int endRow,
+                  uint8_t *const planes[3], const int strides[3])
+{
+    const size_t rowBytes = static_cast<size_t>(width) * 4;
+    const int pairs = width / 2;
+
+    for (int y = firstRow; y < endRow; y += 2)
+    {
+        // Output row y is source row height - 1 - y; an odd last row pairs
+        // with itself for chroma
+        const uint8_t *top = rgba + static_cast<size_t>(height - 1 - y) * rowBytes;
+        const uint8_t *bottom = (y + 1 < height) ? top - rowBytes : top;
+        uint8_t *u = planes[1] + static_cast<size_t>(y / 2) * strides[1];
+        uint8_t *v = planes[2] + static_cast<size_t>(y / 2) * strides[2];
+
+        lumaRow(top, planes[0] + static_cast<size_t>(y) * strides[0], width);
+        if (y + 1 < height)
+        {
+            lumaRow(bottom, planes[0] + static_cast<size_t>(y + 1) * strides[0], width);
+        }
+        chromaRow(top, bottom, u, v, pairs);
+
+        // An odd last column pairs with itself too
+        if (width & 1)
+        {
+            const uint8_t *a = top + (width - 1) * 4;
+            const uint8_t *b = bottom + (width - 1) * 4;
+            int r = 2 * (a[0] + b[0]);
+            int g = 2 * (a[1] + b[1]);
+            int bl = 2 * (a[2] + b[2]);
+            u[pairs] = static_cast<uint8_t>((U_R * r + U_G * g + U_B * bl + C_OFFSET) >> 10);
+            v[pairs] = static_cast<uint8_t>((V_R * r + V_G * g + V_B * bl + C_OFFSET) >> 10);
+        }
+    }
+}
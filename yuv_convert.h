@@ -0,0 +1,15 @@
+#ifndef YUV_CONVERT_H
+#define YUV_CONVERT_H
+
+#include <cstdint>
+
+// Convert rows [firstRow, endRow) of a picture read back from OpenGL to
+// the encoder's planar YUV 4:2:0, flipping it on the way: the source is
+// tightly packed RGBA with the bottom row first, the output rows run top
+// down. Uses BT.601 limited range coefficients in fixed point, as swscale
+// does by default. firstRow must be even so each call owns whole chroma
+// rows, which lets slices of one picture convert on different threads.
+void rgbaToYuv420(const uint8_t *rgba, int width, int height, int firstRow, int endRow,
+                  uint8_t *const planes[3], const int strides[3]);
+
+#endif // YUV_CONVERT_H